@@ -0,0 +1,96 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#include "addr_batch.h"
+#include "app_main.h"
+#include "bip32.h"
+#include "crypto.h"
+#include "zxmacros.h"
+
+void addr_batch_reset(addr_batch_t *batch) {
+    MEMZERO(batch, sizeof(addr_batch_t));
+}
+
+static uint16_t addr_batch_start(addr_batch_t *batch, const uint8_t *data, uint32_t dataLen) {
+    if (dataLen < ADDR_BATCH_REQUEST_LEN) {
+        addr_batch_reset(batch);
+        return APDU_CODE_WRONG_LENGTH;
+    }
+
+    MEMCPY(batch->path, data, sizeof(batch->path));
+    MEMCPY(&batch->remaining, data + sizeof(batch->path), sizeof(batch->remaining));
+
+    // Same paths as INS_GET_ADDR_SECP256K1
+    const bool mainnet = batch->path[0] == HDPATH_0_DEFAULT &&
+                         batch->path[1] == HDPATH_1_DEFAULT;
+
+    const bool testnet = batch->path[0] == HDPATH_0_TESTNET &&
+                         batch->path[1] == HDPATH_1_TESTNET;
+
+    // Every index has to be on the same side of the hardened range, without wrapping around
+    const uint32_t first = batch->path[HDPATH_LEN_DEFAULT - 1];
+    const uint32_t available = (first & BIP32_HARDENED ? UINT32_MAX : BIP32_HARDENED - 1) - first + 1;
+
+    if ((!mainnet && !testnet) || batch->remaining == 0 || batch->remaining > available) {
+        addr_batch_reset(batch);
+        return APDU_CODE_DATA_INVALID;
+    }
+
+    return APDU_CODE_OK;
+}
+
+uint16_t addr_batch_process(addr_batch_t *batch, uint8_t *apdu, uint16_t replySize, uint32_t rx, uint16_t *replyLen) {
+    *replyLen = 0;
+
+    if (rx < OFFSET_DATA) {
+        return APDU_CODE_WRONG_LENGTH;
+    }
+    if (apdu[OFFSET_P2] != 0) {
+        return APDU_CODE_INVALIDP1P2;
+    }
+
+    switch (apdu[OFFSET_P1]) {
+        case ADDR_BATCH_P1_START: {
+            const uint16_t sw = addr_batch_start(batch, apdu + OFFSET_DATA, rx - OFFSET_DATA);
+            if (sw != APDU_CODE_OK) {
+                return sw;
+            }
+            break;
+        }
+        case ADDR_BATCH_P1_NEXT:
+            if (batch->remaining == 0) {
+                return APDU_CODE_CONDITIONS_NOT_SATISFIED;
+            }
+            break;
+        default:
+            return APDU_CODE_INVALIDP1P2;
+    }
+
+    const uint32_t fit = replySize / ADDRESS_SECP256K1_BYTES_LEN;
+    const uint8_t count = (uint8_t) (batch->remaining < fit ? batch->remaining : fit);
+    if (count == 0) {
+        return APDU_CODE_OUTPUT_BUFFER_TOO_SMALL;
+    }
+
+    if (crypto_fillAddressBatch(batch->path, count, apdu, replySize) != zxerr_ok) {
+        addr_batch_reset(batch);
+        return APDU_CODE_EXECUTION_ERROR;
+    }
+
+    batch->path[HDPATH_LEN_DEFAULT - 1] += count;
+    batch->remaining -= count;
+    *replyLen = count * ADDRESS_SECP256K1_BYTES_LEN;
+    return APDU_CODE_OK;
+}
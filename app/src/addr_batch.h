@@ -0,0 +1,51 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "coin.h"
+
+#define ADDR_BATCH_P1_START     0
+#define ADDR_BATCH_P1_NEXT      1
+
+// Path whose last component is the first index, followed by the number of addresses (uint32 each)
+#define ADDR_BATCH_REQUEST_LEN  (sizeof(uint32_t) * (HDPATH_LEN_DEFAULT + 1))
+
+// Addresses still to be sent for the last request
+typedef struct {
+    // last component is the index of the next address
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    uint32_t remaining;
+} addr_batch_t;
+
+void addr_batch_reset(addr_batch_t *batch);
+
+/// Handles one command of INS_GET_ADDR_BATCH_SECP256K1. Each reply holds as many address bytes
+/// (ADDRESS_SECP256K1_BYTES_LEN each) as fit in replySize, NEXT commands return the ones that follow
+/// \param apdu command on input, reply on output
+/// \param replySize bytes of apdu that the reply can use
+/// \param rx length of the command
+/// \param replyLen receives the length of the reply
+/// \return status word
+uint16_t addr_batch_process(addr_batch_t *batch, uint8_t *apdu, uint16_t replySize, uint32_t rx, uint16_t *replyLen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,11 +26,14 @@
 #include "actions.h"
 #include "tx.h"
 #include "addr.h"
+#include "addr_batch.h"
+#include "app_mode.h"
 #include "crypto.h"
 #include "coin.h"
 #include "zxmacros.h"
 
 static bool tx_initialized = false;
+static addr_batch_t addr_batch;
 
 void extractHDPath(uint32_t rx, uint32_t offset) {
     tx_initialized = false;
@@ -52,9 +55,7 @@ void extractHDPath(uint32_t rx, uint32_t offset) {
     }
 }
 
-bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
-    UNUSED(tx);
-
+bool process_chunk(volatile uint32_t *tx, uint32_t rx, bool streaming) {
     const uint8_t payloadType = G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE];
 
     if (G_io_apdu_buffer[OFFSET_P2] != 0) {
@@ -66,10 +67,15 @@ bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
     }
 
     uint32_t added;
+    const char *error_msg;
     switch (payloadType) {
         case P1_INIT:
             tx_initialize();
-            tx_reset();
+            if (streaming) {
+                tx_reset_streaming();
+            } else {
+                tx_reset();
+            }
             extractHDPath(rx, OFFSET_DATA);
             tx_initialized = true;
             return false;
@@ -82,6 +88,16 @@ bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
                 tx_initialized = false;
                 THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
             }
+
+            // Reject malformed messages as soon as the faulty field arrives
+            error_msg = tx_parse_partial();
+            if (error_msg != NULL) {
+                tx_initialized = false;
+                int error_msg_length = strlen(error_msg);
+                MEMCPY(G_io_apdu_buffer, error_msg, error_msg_length);
+                *tx += (error_msg_length);
+                THROW(APDU_CODE_DATA_INVALID);
+            }
             return false;
         case P1_LAST:
             if (!tx_initialized) {
@@ -92,6 +108,9 @@ bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
             if (added != rx - OFFSET_DATA) {
                 THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
             }
+            if (tx_finish_digest() != zxerr_ok) {
+                THROW(APDU_CODE_EXECUTION_ERROR);
+            }
             return true;
     }
 
@@ -118,8 +137,18 @@ __Z_INLINE void handleGetAddr(volatile uint32_t *flags, volatile uint32_t *tx, u
     THROW(APDU_CODE_OK);
 }
 
-__Z_INLINE void handleSign(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
-    if (!process_chunk(tx, rx)) {
+__Z_INLINE void handleGetAddrBatch(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    UNUSED(flags);
+    uint16_t replyLen = 0;
+
+    // Room is left for the status word
+    const uint16_t sw = addr_batch_process(&addr_batch, G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 2, rx, &replyLen);
+    *tx = replyLen;
+    THROW(sw);
+}
+
+__Z_INLINE void handleSign(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx, bool streaming) {
+    if (!process_chunk(tx, rx, streaming)) {
         THROW(APDU_CODE_OK);
     }
 
@@ -156,6 +185,11 @@ void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
                 THROW(APDU_CODE_WRONG_LENGTH);
             }
 
+            // A batch only continues over consecutive INS_GET_ADDR_BATCH_SECP256K1 commands
+            if (G_io_apdu_buffer[OFFSET_INS] != INS_GET_ADDR_BATCH_SECP256K1) {
+                addr_batch_reset(&addr_batch);
+            }
+
             switch (G_io_apdu_buffer[OFFSET_INS]) {
                 case INS_GET_VERSION: {
 #ifdef TESTING_ENABLED
@@ -186,11 +220,28 @@ void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
                     break;
                 }
 
+                case INS_GET_ADDR_BATCH_SECP256K1: {
+                    if (os_global_pin_is_validated() != BOLOS_UX_OK) {
+                        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                    }
+                    handleGetAddrBatch(flags, tx, rx);
+                    break;
+                }
+
                 case INS_SIGN_SECP256K1: {
                     if (os_global_pin_is_validated() != BOLOS_UX_OK) {
                         THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
                     }
-                    handleSign(flags, tx, rx);
+                    handleSign(flags, tx, rx, false);
+                    break;
+                }
+
+                case INS_SIGN_STREAM_SECP256K1: {
+                    // Params are not shown in this mode: expert mode only
+                    if (os_global_pin_is_validated() != BOLOS_UX_OK || !app_mode_expert()) {
+                        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                    }
+                    handleSign(flags, tx, rx, true);
                     break;
                 }
 
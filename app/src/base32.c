@@ -19,48 +19,376 @@
 
 #include "base32.h"
 
+#include <stdbool.h>
 #include <string.h>
 
+// Vector backends are only built for x86 hosts, and chosen at runtime from the CPU features
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define BASE32_SIMD 1
+#else
+#define BASE32_SIMD 0
+#endif
+
+#define BASE32_BLOCK_BYTES  5
+#define BASE32_BLOCK_CHARS  8
+
+static const char base32_alphabet[] = "abcdefghijklmnopqrstuvwxyz234567";
+
+// 5 bytes (40 bits) are exactly 8 characters, whole blocks need no bit buffer or padding
+static void base32_encode_block(const uint8_t *in, char *out)
+{
+    const uint64_t v = ((uint64_t) in[0] << 32u) | ((uint64_t) in[1] << 24u) |
+                       ((uint64_t) in[2] << 16u) | ((uint64_t) in[3] << 8u) | in[4];
+    out[0] = base32_alphabet[(v >> 35u) & 0x1Fu];
+    out[1] = base32_alphabet[(v >> 30u) & 0x1Fu];
+    out[2] = base32_alphabet[(v >> 25u) & 0x1Fu];
+    out[3] = base32_alphabet[(v >> 20u) & 0x1Fu];
+    out[4] = base32_alphabet[(v >> 15u) & 0x1Fu];
+    out[5] = base32_alphabet[(v >> 10u) & 0x1Fu];
+    out[6] = base32_alphabet[(v >> 5u) & 0x1Fu];
+    out[7] = base32_alphabet[v & 0x1Fu];
+}
+
+#if BASE32_SIMD
+#include <immintrin.h>
+#include <pthread.h>
+
+// Each block is loaded with 8 byte loads, so a block can only be taken by the vector code
+// if 3 more bytes can be read after it
+#define BASE32_SIMD_LOAD_BYTES  8
+
+// Character j of a block takes 5 bits starting at bit 5j. The two bytes holding them are
+// shuffled into a big-endian 16-bit lane, shifted right with a multiply-high and masked.
+#define BASE32_SIMD_SHUFFLE     1, 0, 1, 0, 2, 1, 2, 1, 3, 2, 4, 3, 4, 3, (char) 0x80, 4
+#define BASE32_SIMD_MULTIPLIERS 32, 1024, 128, 4096, 512, 64, 2048, 256
+
+__attribute__((target("ssse3")))
+static __m128i base32_indices_ssse3(const uint8_t *in)
+{
+    const __m128i shuffle = _mm_setr_epi8(BASE32_SIMD_SHUFFLE);
+    const __m128i multipliers = _mm_setr_epi16(BASE32_SIMD_MULTIPLIERS);
+    const __m128i words = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i *) in), shuffle);
+    return _mm_and_si128(_mm_mulhi_epu16(words, multipliers), _mm_set1_epi16(0x1F));
+}
+
+// 'a' + index for letters, '2' + (index - 26) for digits
+__attribute__((target("ssse3")))
+static __m128i base32_alphabet_ssse3(__m128i indices)
+{
+    const __m128i digits = _mm_cmpgt_epi8(indices, _mm_set1_epi8(25));
+    const __m128i offset = _mm_add_epi8(_mm_set1_epi8('a'),
+                                        _mm_and_si128(digits, _mm_set1_epi8('2' - 26 - 'a')));
+    return _mm_add_epi8(indices, offset);
+}
+
+__attribute__((target("ssse3")))
+static uint32_t base32_encode_blocks_ssse3(const uint8_t *data, uint32_t numBlocks, char *result)
+{
+    uint32_t block = 0;
+    for (; block + 2 <= numBlocks; block += 2)
+    {
+        const uint8_t *in = data + block * BASE32_BLOCK_BYTES;
+        const __m128i indices = _mm_packus_epi16(base32_indices_ssse3(in),
+                                                 base32_indices_ssse3(in + BASE32_BLOCK_BYTES));
+        _mm_storeu_si128((__m128i *) (result + block * BASE32_BLOCK_CHARS), base32_alphabet_ssse3(indices));
+    }
+    return block;
+}
+
+__attribute__((target("avx2")))
+static __m256i base32_indices_avx2(const uint8_t *in)
+{
+    const __m256i shuffle = _mm256_setr_epi8(BASE32_SIMD_SHUFFLE, BASE32_SIMD_SHUFFLE);
+    const __m256i multipliers = _mm256_setr_epi16(BASE32_SIMD_MULTIPLIERS, BASE32_SIMD_MULTIPLIERS);
+    // one block in each 128-bit lane
+    const __m256i blocks = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadl_epi64((const __m128i *) in)),
+            _mm_loadl_epi64((const __m128i *) (in + BASE32_BLOCK_BYTES)), 1);
+    const __m256i words = _mm256_shuffle_epi8(blocks, shuffle);
+    return _mm256_and_si256(_mm256_mulhi_epu16(words, multipliers), _mm256_set1_epi16(0x1F));
+}
+
+__attribute__((target("avx2")))
+static uint32_t base32_encode_blocks_avx2(const uint8_t *data, uint32_t numBlocks, char *result)
+{
+    uint32_t block = 0;
+    for (; block + 4 <= numBlocks; block += 4)
+    {
+        const uint8_t *in = data + block * BASE32_BLOCK_BYTES;
+        // packing works per lane: blocks come out as 0, 2, 1, 3
+        __m256i indices = _mm256_packus_epi16(base32_indices_avx2(in),
+                                              base32_indices_avx2(in + 2 * BASE32_BLOCK_BYTES));
+        indices = _mm256_permute4x64_epi64(indices, _MM_SHUFFLE(3, 1, 2, 0));
+
+        const __m256i digits = _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25));
+        const __m256i offset = _mm256_add_epi8(_mm256_set1_epi8('a'),
+                                               _mm256_and_si256(digits, _mm256_set1_epi8('2' - 26 - 'a')));
+        _mm256_storeu_si256((__m256i *) (result + block * BASE32_BLOCK_CHARS), _mm256_add_epi8(indices, offset));
+    }
+    return block;
+}
+
+// Whole blocks left over by the AVX2 loop are still worth a 2-block SSSE3 step
+__attribute__((target("avx2")))
+static uint32_t base32_encode_blocks_avx2_ssse3(const uint8_t *data, uint32_t numBlocks, char *result)
+{
+    const uint32_t block = base32_encode_blocks_avx2(data, numBlocks, result);
+    return block + base32_encode_blocks_ssse3(data + block * BASE32_BLOCK_BYTES, numBlocks - block,
+                                              result + block * BASE32_BLOCK_CHARS);
+}
+
+// Encodes as many of numBlocks whole blocks as the backend handles, returns how many it did
+typedef uint32_t (*base32_blocks_fn)(const uint8_t *data, uint32_t numBlocks, char *result);
+
+// CPU features do not change while the process runs, they are queried once. Batch validation
+// workers encode addresses concurrently, so the first use is synchronized
+static pthread_once_t base32_features_once = PTHREAD_ONCE_INIT;
+static bool base32_has_avx2 = false;
+static bool base32_has_ssse3 = false;
+
+static void base32_detect_features()
+{
+    __builtin_cpu_init();
+    base32_has_avx2 = __builtin_cpu_supports("avx2");
+    base32_has_ssse3 = __builtin_cpu_supports("ssse3");
+}
+
+static base32_blocks_fn base32_resolve_backend(base32_backend_e backend)
+{
+    pthread_once(&base32_features_once, base32_detect_features);
+    const bool avx2 = base32_has_avx2;
+    const bool ssse3 = base32_has_ssse3;
+
+    switch (backend)
+    {
+        case base32_backend_auto:
+            return avx2 ? base32_encode_blocks_avx2_ssse3 : (ssse3 ? base32_encode_blocks_ssse3 : NULL);
+        case base32_backend_avx2:
+            return avx2 ? base32_encode_blocks_avx2_ssse3 : NULL;
+        case base32_backend_ssse3:
+            return ssse3 ? base32_encode_blocks_ssse3 : NULL;
+        default:
+            return NULL;
+    }
+}
+
+// The automatic choice is resolved once, on first use; NULL means the scalar code only
+static pthread_once_t base32_auto_once = PTHREAD_ONCE_INIT;
+static base32_blocks_fn base32_auto_blocks = NULL;
+
+static void base32_resolve_auto()
+{
+    base32_auto_blocks = base32_resolve_backend(base32_backend_auto);
+}
+
+static base32_blocks_fn base32_backend_blocks(base32_backend_e backend)
+{
+    if (backend != base32_backend_auto)
+    {
+        return base32_resolve_backend(backend);
+    }
+    pthread_once(&base32_auto_once, base32_resolve_auto);
+    return base32_auto_blocks;
+}
+#endif
+
+static uint32_t base32_encode_impl(base32_backend_e backend,
+                                   const uint8_t *data,
+                                   uint32_t length,
+                                   char *result,
+                                   uint32_t resultLen)
+{
+    if (length > (1 << 28))
+    {
+        return -1;
+    }
+
+    // The output is silently truncated to resultLen characters
+    const uint32_t encodedLen = base32_encoded_len(length);
+    const uint32_t count = encodedLen < resultLen ? encodedLen : resultLen;
+
+    // whole blocks whose characters all fit
+    const uint32_t numBlocks = (length / BASE32_BLOCK_BYTES) < (count / BASE32_BLOCK_CHARS) ?
+                               (length / BASE32_BLOCK_BYTES) : (count / BASE32_BLOCK_CHARS);
+    uint32_t block = 0;
+
+#if BASE32_SIMD
+    // blocks the vector code can load without reading past data
+    const uint32_t loadableBlocks = length >= BASE32_SIMD_LOAD_BYTES ?
+                                    (length - BASE32_SIMD_LOAD_BYTES) / BASE32_BLOCK_BYTES + 1 : 0;
+    const uint32_t simdBlocks = numBlocks < loadableBlocks ? numBlocks : loadableBlocks;
+    const base32_blocks_fn encodeBlocks = base32_backend_blocks(backend);
+    if (encodeBlocks != NULL)
+    {
+        block = encodeBlocks(data, simdBlocks, result);
+    }
+#else
+    (void) backend;
+#endif
+
+    for (; block < numBlocks; block++)
+    {
+        base32_encode_block(data + block * BASE32_BLOCK_BYTES, result + block * BASE32_BLOCK_CHARS);
+    }
+
+    // Partial block at the end, padded with zero bits
+    const uint32_t done = numBlocks * BASE32_BLOCK_CHARS;
+    base32_encode_range(data, length, done, result + done, count - done);
+
+    if (count < resultLen)
+    {
+        result[count] = '\000';
+    }
+    return count;
+}
+
 uint32_t base32_encode(const uint8_t *data,
                        uint32_t length,
                        char *result,
                        uint32_t resultLen)
 {
-    if (length < 0 || length > (1 << 28))
+    return base32_encode_impl(base32_backend_auto, data, length, result, resultLen);
+}
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+uint32_t base32_encode_backend(base32_backend_e backend,
+                               const uint8_t *data,
+                               uint32_t length,
+                               char *result,
+                               uint32_t resultLen)
+{
+    return base32_encode_impl(backend, data, length, result, resultLen);
+}
+#endif
+
+uint32_t base32_encoded_len(uint32_t length)
+{
+    return (uint32_t) (((uint64_t) length * 8u + 4u) / 5u);
+}
+
+uint32_t base32_encode_range(const uint8_t *data,
+                             uint32_t length,
+                             uint32_t firstChar,
+                             char *result,
+                             uint32_t count)
+{
+    const uint32_t encodedLen = base32_encoded_len(length);
+    if (firstChar >= encodedLen)
+    {
+        return 0;
+    }
+    if (count > encodedLen - firstChar)
+    {
+        count = encodedLen - firstChar;
+    }
+
+    // Character i holds bits [5i, 5i + 5) of data, the last one is padded with zero bits
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint32_t bit = (firstChar + i) * 5u;
+        const uint32_t byte = bit / 8u;
+        uint32_t window = (uint32_t) data[byte] << 8u;
+        if (byte + 1 < length)
+        {
+            window |= data[byte + 1];
+        }
+        const uint32_t index = 0x1Fu & (window >> (11u - bit % 8u));
+        result[i] = base32_alphabet[index];
+    }
+    return count;
+}
+
+#define BASE32_INVALID  0xFF
+
+// Value of each character of the alphabet, BASE32_INVALID for anything else (padding and upper case included)
+static const uint8_t base32_values[256] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+        0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+uint32_t base32_decode(const char *encoded,
+                       uint32_t encodedLen,
+                       uint8_t *result,
+                       uint32_t resultLen)
+{
+    if (encodedLen > (1 << 28))
     {
         return -1;
     }
-    uint32_t count = 0;
-    if (length > 0)
+
+    // Only lengths base32_encode can produce are accepted
+    const uint32_t length = (uint32_t) (((uint64_t) encodedLen * 5u) / 8u);
+    if (base32_encoded_len(length) != encodedLen || length > resultLen)
+    {
+        return -1;
+    }
+
+    // 8 characters (40 bits) are exactly 5 bytes
+    const uint8_t *in = (const uint8_t *) encoded;
+    const uint32_t numBlocks = length / BASE32_BLOCK_BYTES;
+    for (uint32_t block = 0; block < numBlocks; block++, in += BASE32_BLOCK_CHARS)
     {
-        uint32_t buffer = data[0];
-        uint32_t next = 1;
-        uint32_t bitsLeft = 8;
-        while (count < resultLen && (bitsLeft > 0 || next < length))
+        uint64_t v = 0;
+        uint8_t invalid = 0;
+        for (uint32_t i = 0; i < BASE32_BLOCK_CHARS; i++)
         {
-            if (bitsLeft < 5)
-            {
-                if (next < length)
-                {
-                    buffer <<= 8;
-                    buffer |= data[next++] & 0xFF;
-                    bitsLeft += 8;
-                }
-                else
-                {
-                    uint32_t pad = 5u - bitsLeft;
-                    buffer <<= pad;
-                    bitsLeft += pad;
-                }
-            }
-            uint32_t index = 0x1Fu & (buffer >> (bitsLeft - 5u));
-            bitsLeft -= 5;
-            result[count++] = "abcdefghijklmnopqrstuvwxyz234567"[index];
+            const uint8_t value = base32_values[in[i]];
+            invalid |= value;
+            v = (v << 5u) | (value & 0x1Fu);
         }
+        // only BASE32_INVALID has bit 7 set
+        if (invalid & 0x80u)
+        {
+            return -1;
+        }
+
+        uint8_t *out = result + block * BASE32_BLOCK_BYTES;
+        out[0] = (uint8_t) (v >> 32u);
+        out[1] = (uint8_t) (v >> 24u);
+        out[2] = (uint8_t) (v >> 16u);
+        out[3] = (uint8_t) (v >> 8u);
+        out[4] = (uint8_t) v;
     }
-    if (count < resultLen)
+
+    // Partial block at the end, the padding bits must be zero so that encoding gives the same text back
+    uint32_t buffer = 0;
+    uint32_t bits = 0;
+    uint32_t count = numBlocks * BASE32_BLOCK_BYTES;
+    for (uint32_t i = numBlocks * BASE32_BLOCK_CHARS; i < encodedLen; i++)
     {
-        result[count] = '\000';
+        const uint8_t value = base32_values[(uint8_t) encoded[i]];
+        if (value == BASE32_INVALID)
+        {
+            return -1;
+        }
+        buffer = (buffer << 5u) | value;
+        bits += 5;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            result[count++] = (uint8_t) (buffer >> bits);
+            buffer &= (1u << bits) - 1u;
+        }
     }
+    if (buffer != 0)
+    {
+        return -1;
+    }
+
     return count;
 }
@@ -35,9 +35,6 @@
 //   ABCDEFGHIJKLMNOPQRSTUVWXYZ234567
 // This alphabet is documented in RFC 4648/3548
 //
-// We allow white-space and hyphens, but all other characters are considered
-// invalid.
-//
 // All functions return the number of output bytes or -1 on error. If the
 // output buffer is too small, the result will silently be truncated.
 
@@ -52,6 +49,34 @@ extern "C" {
 uint32_t base32_encode(const uint8_t *data, unsigned int length,
                        char *result, uint32_t bufSize) __attribute__((visibility("hidden")));
 
+typedef enum {
+    base32_backend_auto,
+    base32_backend_scalar,
+    base32_backend_ssse3,
+    base32_backend_avx2,
+} base32_backend_e;
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+// Host only: base32_encode with a given backend, backends the CPU does not support fall back to scalar code.
+// base32_encode uses the fastest one available.
+uint32_t base32_encode_backend(base32_backend_e backend, const uint8_t *data, uint32_t length,
+                               char *result, uint32_t resultLen) __attribute__((visibility("hidden")));
+#endif
+
+// Reverses base32_encode. Only the lower case alphabet is accepted, without padding, white-space or hyphens,
+// and the unused bits of the last character must be zero: any accepted text is encoded back to itself.
+// Returns the number of bytes written to result, or -1 if the text is not valid or result is too small.
+uint32_t base32_decode(const char *encoded, uint32_t encodedLen,
+                       uint8_t *result, uint32_t resultLen) __attribute__((visibility("hidden")));
+
+// Number of characters base32_encode produces for length bytes
+uint32_t base32_encoded_len(uint32_t length) __attribute__((visibility("hidden")));
+
+// Writes count characters of the encoding of data, starting at character firstChar, without NUL termination.
+// Returns the number of characters written, less than count past the end of the encoding.
+uint32_t base32_encode_range(const uint8_t *data, uint32_t length, uint32_t firstChar,
+                             char *result, uint32_t count) __attribute__((visibility("hidden")));
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,245 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "bignum_decimal.h"
+#include "page_slice.h"
+#include <string.h>
+#include <zxmacros.h>
+
+#define DECIMAL_LIMB_BASE       1000000000u
+#define DECIMAL_LIMB_DIGITS     9
+#define DECIMAL_LIMB64_BASE     10000000000000000000ULL
+#define DECIMAL_LIMB64_DIGITS   19
+
+#define BIGNUM_DECIMAL_MAX_WORDS    (BIGNUM_DECIMAL_MAX_LEN / 4)
+
+// Digits are produced from the least significant one. The sink decides where each one goes:
+// - plain: written backwards from the end of out, moved to the front once the value is done
+// - counting: only numDigits is updated
+// - fixed point page: the digits shown in a page of the fixed point text are written
+typedef enum {
+    sink_plain,
+    sink_counting,
+    sink_fixed_point_page,
+} decimal_sink_mode_e;
+
+typedef struct {
+    decimal_sink_mode_e mode;
+    // plain
+    char *out;
+    uint16_t pos;
+    // digits produced so far
+    uint16_t numDigits;
+    // fixed point page
+    uint16_t totalDigits;
+    uint8_t decimals;
+    page_slice_t slice;
+} decimal_sink_t;
+
+// Position of a digit in the fixed point text, as laid out by fpstr_to_str
+__Z_INLINE uint16_t fixedPointPosition(uint16_t totalDigits, uint8_t decimals, uint16_t digitPos) {
+    if (totalDigits <= decimals) {
+        // "0." and zero padding come first
+        return 2 + (decimals - totalDigits) + digitPos;
+    }
+    // the point goes in front of the decimals
+    return digitPos < totalDigits - decimals ? digitPos : digitPos + 1;
+}
+
+__Z_INLINE bool sink_put(decimal_sink_t *sink, char digit) {
+    switch (sink->mode) {
+        case sink_plain:
+            if (sink->pos == 0) {
+                return false;
+            }
+            sink->out[--sink->pos] = digit;
+            break;
+        case sink_counting:
+            break;
+        case sink_fixed_point_page: {
+            const uint16_t pos = fixedPointPosition(sink->totalDigits, sink->decimals,
+                                                    sink->totalDigits - 1 - sink->numDigits);
+            page_slicePut(&sink->slice, pos, digit);
+            break;
+        }
+    }
+    sink->numDigits++;
+    return true;
+}
+
+// Emits the digits of v, zero padded to minDigits
+__Z_INLINE bool decimal_emit(decimal_sink_t *sink, uint64_t v, uint8_t minDigits) {
+    uint8_t written = 0;
+    while (v != 0 || written < minDigits) {
+        if (!sink_put(sink, (char) ('0' + (v % 10)))) {
+            return false;
+        }
+        v /= 10;
+        written++;
+    }
+    return true;
+}
+
+// Repeated division of base 2^32 words by 10^9, each remainder is one 9 digit limb
+static bool decimal_fromWords(decimal_sink_t *sink, uint32_t *words, uint8_t numWords) {
+    while (numWords > 0) {
+        uint64_t rem = 0;
+        for (uint8_t i = 0; i < numWords; i++) {
+            const uint64_t cur = (rem << 32u) | words[i];
+            words[i] = (uint32_t) (cur / DECIMAL_LIMB_BASE);
+            rem = cur % DECIMAL_LIMB_BASE;
+        }
+
+        // most significant words become zero as the value shrinks
+        uint8_t skip = 0;
+        while (skip < numWords && words[skip] == 0) {
+            skip++;
+        }
+        if (skip > 0) {
+            numWords -= skip;
+            memmove(words, words + skip, numWords * sizeof(uint32_t));
+        }
+
+        // the last limb is not padded
+        if (!decimal_emit(sink, rem, numWords > 0 ? DECIMAL_LIMB_DIGITS : 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool decimal_convert(decimal_sink_t *sink, const uint8_t *value, uint16_t valueLen) {
+    // leading zeros do not change the value
+    while (valueLen > 0 && *value == 0) {
+        value++;
+        valueLen--;
+    }
+    if (valueLen > BIGNUM_DECIMAL_MAX_LEN) {
+        return false;
+    }
+
+    if (valueLen <= sizeof(uint64_t)) {
+        uint64_t v = 0;
+        for (uint16_t i = 0; i < valueLen; i++) {
+            v = (v << 8u) | value[i];
+        }
+        return decimal_emit(sink, v, 1);
+    }
+
+#if defined(__SIZEOF_INT128__)
+    if (valueLen <= sizeof(unsigned __int128)) {
+        unsigned __int128 v = 0;
+        for (uint16_t i = 0; i < valueLen; i++) {
+            v = (v << 8u) | value[i];
+        }
+        // 2^128 < 10^39, so at most two padded limbs come before the head
+        while (v >= DECIMAL_LIMB64_BASE) {
+            if (!decimal_emit(sink, (uint64_t) (v % DECIMAL_LIMB64_BASE), DECIMAL_LIMB64_DIGITS)) {
+                return false;
+            }
+            v /= DECIMAL_LIMB64_BASE;
+        }
+        return decimal_emit(sink, (uint64_t) v, 1);
+    }
+#endif
+
+    // big-endian words, the first one takes the bytes that do not fill a whole word
+    uint32_t words[BIGNUM_DECIMAL_MAX_WORDS];
+    const uint8_t numWords = (uint8_t) ((valueLen + 3) / 4);
+    uint8_t wordIdx = 0;
+    uint8_t bytesInWord = (uint8_t) (valueLen % 4 == 0 ? 4 : valueLen % 4);
+    uint32_t word = 0;
+    for (uint16_t i = 0; i < valueLen; i++) {
+        word = (word << 8u) | value[i];
+        if (--bytesInWord == 0) {
+            words[wordIdx++] = word;
+            word = 0;
+            bytesInWord = 4;
+        }
+    }
+
+    return decimal_fromWords(sink, words, numWords);
+}
+
+bool bignumBigEndian_to_decimal(char *out, uint16_t outLen, const uint8_t *value, uint16_t valueLen) {
+    if (out == NULL || outLen < 2) {
+        return false;
+    }
+    MEMZERO(out, outLen);
+
+    decimal_sink_t sink;
+    MEMZERO(&sink, sizeof(sink));
+    sink.mode = sink_plain;
+    sink.out = out;
+    sink.pos = outLen - 1;
+
+    if (!decimal_convert(&sink, value, valueLen)) {
+        return false;
+    }
+
+    memmove(out, out + sink.pos, sink.numDigits);
+    out[sink.numDigits] = 0;
+    return true;
+}
+
+bool bignumBigEndian_to_fpstr_page(char *outVal, uint16_t outValLen,
+                                   const uint8_t *value, uint16_t valueLen, uint8_t decimals,
+                                   uint8_t pageIdx, uint8_t *pageCount) {
+    if (outVal != NULL) {
+        MEMZERO(outVal, outValLen);
+    }
+    *pageCount = 0;
+
+    // Only the number of digits is needed to lay the text out
+    decimal_sink_t sink;
+    MEMZERO(&sink, sizeof(sink));
+    sink.mode = sink_counting;
+    if (!decimal_convert(&sink, value, valueLen)) {
+        return false;
+    }
+
+    const uint16_t totalDigits = sink.numDigits;
+    const uint16_t textLen = decimals == 0 ? totalDigits :
+                             (totalDigits <= decimals ? decimals + 2 : totalDigits + 1);
+
+    if (outVal == NULL) {
+        return true;
+    }
+
+    MEMZERO(&sink, sizeof(sink));
+    if (!page_sliceInit(&sink.slice, outVal, outValLen, textLen, pageIdx, pageCount)) {
+        return false;
+    }
+    if (sink.slice.first == sink.slice.last) {
+        return true;
+    }
+
+    // Fixed characters: "0." and zero padding, or the decimal point
+    if (decimals > 0 && totalDigits <= decimals) {
+        page_slicePut(&sink.slice, 0, '0');
+        page_slicePut(&sink.slice, 1, '.');
+        for (uint16_t pos = 2; pos < 2 + decimals - totalDigits; pos++) {
+            page_slicePut(&sink.slice, pos, '0');
+        }
+    } else if (decimals > 0) {
+        page_slicePut(&sink.slice, totalDigits - decimals, '.');
+    }
+
+    sink.mode = sink_fixed_point_page;
+    sink.totalDigits = totalDigits;
+    sink.decimals = decimals;
+    return decimal_convert(&sink, value, valueLen);
+}
@@ -0,0 +1,55 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Longest value (in bytes) bignumBigEndian_to_decimal converts, enough for any bigint in a message
+#define BIGNUM_DECIMAL_MAX_LEN  128
+
+/// Writes the decimal digits of an unsigned big-endian integer, without leading zeros ("0" for zero).
+/// The text is the same as bignumBigEndian_to_bcd followed by bignumBigEndian_bcdprint, but the cost
+/// grows with the number of 9 digit limbs instead of bits x bcd bytes.
+/// \param out receives the NUL terminated digits
+/// \param outLen size of out
+/// \param value big-endian integer
+/// \param valueLen size of value, at most BIGNUM_DECIMAL_MAX_LEN
+/// \return false if the value is too long or the digits do not fit in out
+bool bignumBigEndian_to_decimal(char *out, uint16_t outLen, const uint8_t *value, uint16_t valueLen);
+
+/// Writes one page of the fixed point text of an unsigned big-endian integer, without an intermediate buffer.
+/// The pages are the same as fpstr_to_str over the decimal digits followed by pageString
+/// (trailing zeros are kept, "0.000..." for zero).
+/// \param outVal receives the NUL terminated page, always cleared
+/// \param outValLen size of outVal, each page holds outValLen - 1 characters
+/// \param value big-endian integer, may be empty for zero
+/// \param valueLen size of value, at most BIGNUM_DECIMAL_MAX_LEN
+/// \param decimals number of digits after the decimal point, 0 for an integer
+/// \param pageIdx page to write, nothing is written if it is past the last one
+/// \param pageCount receives the number of pages, 0 if outValLen cannot hold a page
+/// \return false if the value is too long or the text needs more than 255 pages
+bool bignumBigEndian_to_fpstr_page(char *outVal, uint16_t outValLen,
+                                   const uint8_t *value, uint16_t valueLen, uint8_t decimals,
+                                   uint8_t pageIdx, uint8_t *pageCount);
+
+#ifdef __cplusplus
+}
+#endif
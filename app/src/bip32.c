@@ -0,0 +1,257 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "bip32.h"
+#include <string.h>
+#include "zxmacros.h"
+
+#define HMAC_SHA512_LEN 64
+
+#if defined(TARGET_NANOS) || defined(TARGET_NANOX)
+#include "cx.h"
+
+__Z_INLINE void bip32_hmacSha512(const uint8_t *key, uint16_t keyLen, const uint8_t *in, uint16_t inLen,
+                                 uint8_t *out) {
+    cx_hmac_sha512(key, keyLen, in, inLen, out, HMAC_SHA512_LEN);
+}
+
+#else
+
+// Hosts have no SHA-512 in this tree, this is the FIPS 180-4 one, only used by the HMAC below
+
+#define SHA512_BLOCK_LEN 128
+
+static const uint64_t SHA512_K[80] = {
+        0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc, 0x3956c25bf348b538,
+        0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242, 0x12835b0145706fbe,
+        0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2, 0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
+        0xc19bf174cf692694, 0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+        0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5, 0x983e5152ee66dfab,
+        0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4, 0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+        0x06ca6351e003826f, 0x142929670a0e6e70, 0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed,
+        0x53380d139d95b3df, 0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+        0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30, 0xd192e819d6ef5218,
+        0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8, 0x19a4c116b8d2d0c8, 0x1e376c085141ab53,
+        0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8, 0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373,
+        0x682e6ff3d6b2b8a3, 0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+        0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b, 0xca273eceea26619c,
+        0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178, 0x06f067aa72176fba, 0x0a637dc5a2c898a6,
+        0x113f9804bef90dae, 0x1b710b35131c471b, 0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
+        0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817,
+};
+
+typedef struct {
+    uint64_t h[8];
+    uint8_t block[SHA512_BLOCK_LEN];
+    uint32_t blockLen;
+    uint64_t totalLen;
+} sha512_state_t;
+
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64u - (n))))
+
+static void sha512_compress(sha512_state_t *s, const uint8_t *block) {
+    uint64_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = 0;
+        for (int j = 0; j < 8; j++) {
+            w[i] = (w[i] << 8u) | block[8 * i + j];
+        }
+    }
+    for (int i = 16; i < 80; i++) {
+        const uint64_t s0 = ROTR64(w[i - 15], 1u) ^ ROTR64(w[i - 15], 8u) ^ (w[i - 15] >> 7u);
+        const uint64_t s1 = ROTR64(w[i - 2], 19u) ^ ROTR64(w[i - 2], 61u) ^ (w[i - 2] >> 6u);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t v[8];
+    MEMCPY(v, s->h, sizeof(v));
+    for (int i = 0; i < 80; i++) {
+        const uint64_t S1 = ROTR64(v[4], 14u) ^ ROTR64(v[4], 18u) ^ ROTR64(v[4], 41u);
+        const uint64_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+        const uint64_t t1 = v[7] + S1 + ch + SHA512_K[i] + w[i];
+        const uint64_t S0 = ROTR64(v[0], 28u) ^ ROTR64(v[0], 34u) ^ ROTR64(v[0], 39u);
+        const uint64_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+        memmove(v + 1, v, 7 * sizeof(uint64_t));
+        v[4] += t1;
+        v[0] = t1 + S0 + maj;
+    }
+    for (int i = 0; i < 8; i++) {
+        s->h[i] += v[i];
+    }
+    MEMZERO(w, sizeof(w));
+    MEMZERO(v, sizeof(v));
+}
+
+static void sha512_init(sha512_state_t *s) {
+    static const uint64_t IV[8] = {
+            0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+            0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179,
+    };
+    MEMZERO(s, sizeof(sha512_state_t));
+    MEMCPY(s->h, IV, sizeof(IV));
+}
+
+static void sha512_update(sha512_state_t *s, const uint8_t *in, uint32_t inLen) {
+    s->totalLen += inLen;
+    while (inLen > 0) {
+        const uint32_t n = SHA512_BLOCK_LEN - s->blockLen < inLen ? SHA512_BLOCK_LEN - s->blockLen : inLen;
+        MEMCPY(s->block + s->blockLen, in, n);
+        s->blockLen += n;
+        in += n;
+        inLen -= n;
+        if (s->blockLen == SHA512_BLOCK_LEN) {
+            sha512_compress(s, s->block);
+            s->blockLen = 0;
+        }
+    }
+}
+
+static void sha512_final(sha512_state_t *s, uint8_t *out) {
+    const uint64_t bits = s->totalLen * 8u;
+    s->block[s->blockLen++] = 0x80;
+    if (s->blockLen > SHA512_BLOCK_LEN - 16) {
+        MEMZERO(s->block + s->blockLen, SHA512_BLOCK_LEN - s->blockLen);
+        sha512_compress(s, s->block);
+        s->blockLen = 0;
+    }
+    // the length is 128 bits, messages here are far below 2^64 bits
+    MEMZERO(s->block + s->blockLen, SHA512_BLOCK_LEN - s->blockLen);
+    for (int i = 0; i < 8; i++) {
+        s->block[SHA512_BLOCK_LEN - 1 - i] = (uint8_t) (bits >> (8u * i));
+    }
+    sha512_compress(s, s->block);
+
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            out[8 * i + j] = (uint8_t) (s->h[i] >> (56u - 8u * j));
+        }
+    }
+    MEMZERO(s, sizeof(sha512_state_t));
+}
+
+// RFC 2104, keys are never longer than a block here
+static void bip32_hmacSha512(const uint8_t *key, uint16_t keyLen, const uint8_t *in, uint16_t inLen,
+                             uint8_t *out) {
+    uint8_t pad[SHA512_BLOCK_LEN];
+    uint8_t inner[HMAC_SHA512_LEN];
+    sha512_state_t s;
+
+    MEMZERO(pad, sizeof(pad));
+    MEMCPY(pad, key, keyLen);
+    for (int i = 0; i < SHA512_BLOCK_LEN; i++) {
+        pad[i] ^= 0x36u;
+    }
+    sha512_init(&s);
+    sha512_update(&s, pad, sizeof(pad));
+    sha512_update(&s, in, inLen);
+    sha512_final(&s, inner);
+
+    for (int i = 0; i < SHA512_BLOCK_LEN; i++) {
+        pad[i] ^= 0x36u ^ 0x5cu;
+    }
+    sha512_init(&s);
+    sha512_update(&s, pad, sizeof(pad));
+    sha512_update(&s, inner, sizeof(inner));
+    sha512_final(&s, out);
+
+    MEMZERO(pad, sizeof(pad));
+    MEMZERO(inner, sizeof(inner));
+}
+
+#endif
+
+// secp256k1 group order
+static const uint8_t SECP256K1_ORDER[BIP32_KEY_LEN] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+        0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41,
+};
+
+// Big-endian 256-bit numbers. Only runs on private keys: no branch or early exit depends on their bytes
+
+// 1 if a < b
+__Z_INLINE uint8_t scalar_less(const uint8_t *a, const uint8_t *b) {
+    uint16_t borrow = 0;
+    for (int i = BIP32_KEY_LEN - 1; i >= 0; i--) {
+        borrow = (uint16_t) ((uint16_t) a[i] - b[i] - borrow) >> 15u;
+    }
+    return (uint8_t) borrow;
+}
+
+__Z_INLINE bool scalar_isZero(const uint8_t *a) {
+    uint8_t acc = 0;
+    for (int i = 0; i < BIP32_KEY_LEN; i++) {
+        acc |= a[i];
+    }
+    return acc == 0;
+}
+
+// out = (a + b) mod n, with a, b < n
+__Z_INLINE void scalar_addModOrder(uint8_t *out, const uint8_t *a, const uint8_t *b) {
+    uint8_t sum[BIP32_KEY_LEN];
+    uint8_t reduced[BIP32_KEY_LEN];
+    uint16_t carry = 0;
+    for (int i = BIP32_KEY_LEN - 1; i >= 0; i--) {
+        carry = (uint16_t) (a[i] + b[i] + carry);
+        sum[i] = (uint8_t) carry;
+        carry >>= 8u;
+    }
+    uint16_t borrow = 0;
+    for (int i = BIP32_KEY_LEN - 1; i >= 0; i--) {
+        const uint16_t d = (uint16_t) ((uint16_t) sum[i] - SECP256K1_ORDER[i] - borrow);
+        reduced[i] = (uint8_t) d;
+        borrow = d >> 15u;
+    }
+
+    // a + b < 2n: n is subtracted once if the sum overflowed 256 bits or is at least n
+    const uint8_t mask = (uint8_t) -(uint8_t) (carry | (borrow ^ 1u));
+    for (int i = 0; i < BIP32_KEY_LEN; i++) {
+        out[i] = (uint8_t) ((reduced[i] & mask) | (sum[i] & (uint8_t) ~mask));
+    }
+    MEMZERO(sum, sizeof(sum));
+    MEMZERO(reduced, sizeof(reduced));
+}
+
+bool bip32_deriveChildKey(const uint8_t *parentKey, const uint8_t *chainCode, const uint8_t *parentPublicKey,
+                          uint32_t index, uint8_t *childKey, uint8_t *childChainCode) {
+    uint8_t data[BIP32_PUBLIC_KEY_LEN + 4];
+    uint8_t I[HMAC_SHA512_LEN];
+
+    if (index & BIP32_HARDENED) {
+        data[0] = 0x00;
+        MEMCPY(data + 1, parentKey, BIP32_KEY_LEN);
+    } else {
+        MEMCPY(data, parentPublicKey, BIP32_PUBLIC_KEY_LEN);
+    }
+    data[33] = (uint8_t) (index >> 24u);
+    data[34] = (uint8_t) (index >> 16u);
+    data[35] = (uint8_t) (index >> 8u);
+    data[36] = (uint8_t) index;
+
+    bip32_hmacSha512(chainCode, BIP32_CHAIN_CODE_LEN, data, sizeof(data), I);
+
+    bool valid = scalar_less(I, SECP256K1_ORDER);
+    if (valid) {
+        scalar_addModOrder(childKey, I, parentKey);
+        valid = !scalar_isZero(childKey);
+    }
+    if (valid && childChainCode != NULL) {
+        MEMCPY(childChainCode, I + BIP32_KEY_LEN, BIP32_CHAIN_CODE_LEN);
+    }
+
+    MEMZERO(data, sizeof(data));
+    MEMZERO(I, sizeof(I));
+    return valid;
+}
@@ -0,0 +1,39 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BIP32_HARDENED          0x80000000u
+#define BIP32_KEY_LEN           32
+#define BIP32_CHAIN_CODE_LEN    32
+#define BIP32_PUBLIC_KEY_LEN    33
+
+/// BIP32 CKDpriv on secp256k1: child private key at index, from the parent node
+/// \param parentPublicKey compressed public key of parentKey, only read for non-hardened indexes
+/// \param childChainCode receives the chain code of the child, can be NULL
+/// \return false if the child is not a valid key (IL >= n or a zero key, probability lower than 1 in 2^127)
+bool bip32_deriveChildKey(const uint8_t *parentKey, const uint8_t *chainCode, const uint8_t *parentPublicKey,
+                          uint32_t index, uint8_t *childKey, uint8_t *childChainCode);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,656 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+
+#include "blake2b_dispatch.h"
+#include <stdbool.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BLAKE2B_SIMD 1
+#include <immintrin.h>
+#include <pthread.h>
+#else
+#define BLAKE2B_SIMD 0
+#endif
+
+// The twelve rounds written out, sigma is then indexed with constants and the message words
+// are picked at compile time
+#define BLAKE2B_ROUNDS(ROUND)                                                                       \
+    do {                                                                                            \
+        ROUND(0); ROUND(1); ROUND(2); ROUND(3); ROUND(4); ROUND(5);                                 \
+        ROUND(6); ROUND(7); ROUND(8); ROUND(9); ROUND(10); ROUND(11);                               \
+    } while (0)
+
+typedef void (*blake2b_compress_fn)(blake2b_state *S, const uint8_t *block);
+
+static const uint64_t blake2b_IV[8] = {
+        0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+        0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+};
+
+static const uint8_t blake2b_sigma[12][16] = {
+        {0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15},
+        {14, 10, 4,  8,  9,  15, 13, 6,  1,  12, 0,  2,  11, 7,  5,  3},
+        {11, 8,  12, 0,  5,  2,  15, 13, 10, 14, 3,  6,  7,  1,  9,  4},
+        {7,  9,  3,  1,  13, 12, 11, 14, 2,  6,  5,  10, 4,  0,  15, 8},
+        {9,  0,  5,  7,  2,  4,  10, 15, 14, 1,  11, 12, 6,  8,  3,  13},
+        {2,  12, 6,  10, 0,  11, 8,  3,  4,  13, 7,  5,  15, 14, 1,  9},
+        {12, 5,  1,  15, 14, 13, 4,  10, 0,  7,  6,  3,  9,  2,  8,  11},
+        {13, 11, 7,  14, 12, 1,  3,  9,  5,  0,  15, 4,  8,  6,  2,  10},
+        {6,  15, 14, 9,  11, 3,  0,  8,  12, 2,  13, 7,  1,  4,  10, 5},
+        {10, 2,  8,  4,  7,  6,  1,  5,  15, 11, 9,  14, 3,  12, 13, 0},
+        {0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15},
+        {14, 10, 4,  8,  9,  15, 13, 6,  1,  12, 0,  2,  11, 7,  5,  3},
+};
+
+static uint64_t blake2b_load64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8u) | p[i];
+    }
+    return v;
+}
+
+static uint64_t blake2b_rotr64(uint64_t x, unsigned int n) {
+    return (x >> n) | (x << (64u - n));
+}
+
+static void blake2b_loadMessage(uint64_t m[16], const uint8_t *block) {
+    for (int i = 0; i < 16; i++) {
+        m[i] = blake2b_load64(block + 8 * i);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Portable
+
+#define BLAKE2B_G(r, i, a, b, c, d)                                 \
+    do {                                                            \
+        a = a + b + m[blake2b_sigma[r][2 * (i)]];                   \
+        d = blake2b_rotr64(d ^ a, 32);                              \
+        c = c + d;                                                  \
+        b = blake2b_rotr64(b ^ c, 24);                              \
+        a = a + b + m[blake2b_sigma[r][2 * (i) + 1]];               \
+        d = blake2b_rotr64(d ^ a, 16);                              \
+        c = c + d;                                                  \
+        b = blake2b_rotr64(b ^ c, 63);                              \
+    } while (0)
+
+#define PORTABLE_ROUND(r)                               \
+    do {                                                \
+        BLAKE2B_G(r, 0, v[0], v[4], v[8], v[12]);       \
+        BLAKE2B_G(r, 1, v[1], v[5], v[9], v[13]);       \
+        BLAKE2B_G(r, 2, v[2], v[6], v[10], v[14]);      \
+        BLAKE2B_G(r, 3, v[3], v[7], v[11], v[15]);      \
+        BLAKE2B_G(r, 4, v[0], v[5], v[10], v[15]);      \
+        BLAKE2B_G(r, 5, v[1], v[6], v[11], v[12]);      \
+        BLAKE2B_G(r, 6, v[2], v[7], v[8], v[13]);       \
+        BLAKE2B_G(r, 7, v[3], v[4], v[9], v[14]);       \
+    } while (0)
+
+static void blake2b_compress_portable(blake2b_state *S, const uint8_t *block) {
+    uint64_t m[16];
+    uint64_t v[16];
+    blake2b_loadMessage(m, block);
+
+    for (int i = 0; i < 8; i++) {
+        v[i] = S->h[i];
+        v[i + 8] = blake2b_IV[i];
+    }
+    v[12] ^= S->t[0];
+    v[13] ^= S->t[1];
+    v[14] ^= S->f[0];
+    v[15] ^= S->f[1];
+
+    BLAKE2B_ROUNDS(PORTABLE_ROUND);
+
+    for (int i = 0; i < 8; i++) {
+        S->h[i] ^= v[i] ^ v[i + 8];
+    }
+}
+
+#if BLAKE2B_SIMD
+//////////////////////////////////////////////////////////////////////////////////////////////
+// SSE4.1: each row of the state is split in two 128-bit halves, two G functions run side by side
+
+// rotations by 24 and 16 are byte shuffles, by 32 a dword shuffle
+#define BLAKE2B_ROT24_MASK  3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10
+#define BLAKE2B_ROT16_MASK  2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9
+
+#define SSE_ROT32(x)        _mm_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define SSE_ROT24(x)        _mm_shuffle_epi8((x), rot24)
+#define SSE_ROT16(x)        _mm_shuffle_epi8((x), rot16)
+#define SSE_ROT63(x)        _mm_xor_si128(_mm_srli_epi64((x), 63), _mm_add_epi64((x), (x)))
+
+#define SSE_G_HALF(al, ah, bl, bh, cl, ch, dl, dh, ml, mh, ROT_D, ROT_B)   \
+    do {                                                                    \
+        al = _mm_add_epi64(_mm_add_epi64(al, bl), ml);                      \
+        ah = _mm_add_epi64(_mm_add_epi64(ah, bh), mh);                      \
+        dl = ROT_D(_mm_xor_si128(dl, al));                                  \
+        dh = ROT_D(_mm_xor_si128(dh, ah));                                  \
+        cl = _mm_add_epi64(cl, dl);                                         \
+        ch = _mm_add_epi64(ch, dh);                                         \
+        bl = ROT_B(_mm_xor_si128(bl, cl));                                  \
+        bh = ROT_B(_mm_xor_si128(bh, ch));                                  \
+    } while (0)
+
+// message words for G functions 2i (low lane) and 2i+1 (high lane)
+#define SSE_MSG(r, g0, g1, k)   _mm_set_epi64x((int64_t) m[blake2b_sigma[r][2 * (g1) + (k)]], \
+                                               (int64_t) m[blake2b_sigma[r][2 * (g0) + (k)]])
+
+// Diagonalize: rotate rows b, c and d left by 1, 2 and 3 words, so the diagonals line up as columns
+#define SSE_DIAGONALIZE()                                                   \
+    do {                                                                    \
+        __m128i t0 = _mm_alignr_epi8(bh, bl, 8);                            \
+        __m128i t1 = _mm_alignr_epi8(bl, bh, 8);                            \
+        bl = t0;                                                            \
+        bh = t1;                                                            \
+        t0 = cl;                                                            \
+        cl = ch;                                                            \
+        ch = t0;                                                            \
+        t0 = _mm_alignr_epi8(dl, dh, 8);                                    \
+        t1 = _mm_alignr_epi8(dh, dl, 8);                                    \
+        dl = t0;                                                            \
+        dh = t1;                                                            \
+    } while (0)
+
+#define SSE_UNDIAGONALIZE()                                                 \
+    do {                                                                    \
+        __m128i t0 = _mm_alignr_epi8(bl, bh, 8);                            \
+        __m128i t1 = _mm_alignr_epi8(bh, bl, 8);                            \
+        bl = t0;                                                            \
+        bh = t1;                                                            \
+        t0 = cl;                                                            \
+        cl = ch;                                                            \
+        ch = t0;                                                            \
+        t0 = _mm_alignr_epi8(dh, dl, 8);                                    \
+        t1 = _mm_alignr_epi8(dl, dh, 8);                                    \
+        dl = t0;                                                            \
+        dh = t1;                                                            \
+    } while (0)
+
+#define SSE_ROUND(r)                                                                                            \
+    do {                                                                                                        \
+        SSE_G_HALF(al, ah, bl, bh, cl, ch, dl, dh, SSE_MSG(r, 0, 1, 0), SSE_MSG(r, 2, 3, 0), SSE_ROT32, SSE_ROT24); \
+        SSE_G_HALF(al, ah, bl, bh, cl, ch, dl, dh, SSE_MSG(r, 0, 1, 1), SSE_MSG(r, 2, 3, 1), SSE_ROT16, SSE_ROT63); \
+        SSE_DIAGONALIZE();                                                                                      \
+        SSE_G_HALF(al, ah, bl, bh, cl, ch, dl, dh, SSE_MSG(r, 4, 5, 0), SSE_MSG(r, 6, 7, 0), SSE_ROT32, SSE_ROT24); \
+        SSE_G_HALF(al, ah, bl, bh, cl, ch, dl, dh, SSE_MSG(r, 4, 5, 1), SSE_MSG(r, 6, 7, 1), SSE_ROT16, SSE_ROT63); \
+        SSE_UNDIAGONALIZE();                                                                                    \
+    } while (0)
+
+__attribute__((target("sse4.1")))
+static void blake2b_compress_sse41(blake2b_state *S, const uint8_t *block) {
+    const __m128i rot24 = _mm_setr_epi8(BLAKE2B_ROT24_MASK);
+    const __m128i rot16 = _mm_setr_epi8(BLAKE2B_ROT16_MASK);
+
+    uint64_t m[16];
+    memcpy(m, block, sizeof(m));
+
+    __m128i al = _mm_loadu_si128((const __m128i *) &S->h[0]);
+    __m128i ah = _mm_loadu_si128((const __m128i *) &S->h[2]);
+    __m128i bl = _mm_loadu_si128((const __m128i *) &S->h[4]);
+    __m128i bh = _mm_loadu_si128((const __m128i *) &S->h[6]);
+    __m128i cl = _mm_loadu_si128((const __m128i *) &blake2b_IV[0]);
+    __m128i ch = _mm_loadu_si128((const __m128i *) &blake2b_IV[2]);
+    __m128i dl = _mm_xor_si128(_mm_loadu_si128((const __m128i *) &blake2b_IV[4]),
+                               _mm_loadu_si128((const __m128i *) &S->t[0]));
+    __m128i dh = _mm_xor_si128(_mm_loadu_si128((const __m128i *) &blake2b_IV[6]),
+                               _mm_loadu_si128((const __m128i *) &S->f[0]));
+
+    BLAKE2B_ROUNDS(SSE_ROUND);
+
+    _mm_storeu_si128((__m128i *) &S->h[0], _mm_xor_si128(_mm_loadu_si128((const __m128i *) &S->h[0]),
+                                                         _mm_xor_si128(al, cl)));
+    _mm_storeu_si128((__m128i *) &S->h[2], _mm_xor_si128(_mm_loadu_si128((const __m128i *) &S->h[2]),
+                                                         _mm_xor_si128(ah, ch)));
+    _mm_storeu_si128((__m128i *) &S->h[4], _mm_xor_si128(_mm_loadu_si128((const __m128i *) &S->h[4]),
+                                                         _mm_xor_si128(bl, dl)));
+    _mm_storeu_si128((__m128i *) &S->h[6], _mm_xor_si128(_mm_loadu_si128((const __m128i *) &S->h[6]),
+                                                         _mm_xor_si128(bh, dh)));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// AVX2: each row of the state is one 256-bit register, the four G functions of a step run together
+
+#define AVX_ROT32(x)        _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define AVX_ROT24(x)        _mm256_shuffle_epi8((x), rot24)
+#define AVX_ROT16(x)        _mm256_shuffle_epi8((x), rot16)
+#define AVX_ROT63(x)        _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+#define AVX_G(a, b, c, d, m0, m1)                                           \
+    do {                                                                    \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), m0);                   \
+        d = AVX_ROT32(_mm256_xor_si256(d, a));                              \
+        c = _mm256_add_epi64(c, d);                                         \
+        b = AVX_ROT24(_mm256_xor_si256(b, c));                              \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), m1);                   \
+        d = AVX_ROT16(_mm256_xor_si256(d, a));                              \
+        c = _mm256_add_epi64(c, d);                                         \
+        b = AVX_ROT63(_mm256_xor_si256(b, c));                              \
+    } while (0)
+
+// message words for G functions g..g+3
+#define AVX_MSG(r, g, k)    _mm256_set_epi64x((int64_t) m[blake2b_sigma[r][2 * ((g) + 3) + (k)]], \
+                                              (int64_t) m[blake2b_sigma[r][2 * ((g) + 2) + (k)]], \
+                                              (int64_t) m[blake2b_sigma[r][2 * ((g) + 1) + (k)]], \
+                                              (int64_t) m[blake2b_sigma[r][2 * (g) + (k)]])
+
+// Columns, then the diagonals once rows b, c and d are rotated left by 1, 2 and 3 words
+#define AVX_ROUND(r)                                                        \
+    do {                                                                    \
+        AVX_G(a, b, c, d, AVX_MSG(r, 0, 0), AVX_MSG(r, 0, 1));              \
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));           \
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));           \
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));           \
+        AVX_G(a, b, c, d, AVX_MSG(r, 4, 0), AVX_MSG(r, 4, 1));              \
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));           \
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));           \
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));           \
+    } while (0)
+
+__attribute__((target("avx2")))
+static void blake2b_compress_avx2(blake2b_state *S, const uint8_t *block) {
+    const __m256i rot24 = _mm256_setr_epi8(BLAKE2B_ROT24_MASK, BLAKE2B_ROT24_MASK);
+    const __m256i rot16 = _mm256_setr_epi8(BLAKE2B_ROT16_MASK, BLAKE2B_ROT16_MASK);
+
+    uint64_t m[16];
+    memcpy(m, block, sizeof(m));
+
+    const __m256i h0 = _mm256_loadu_si256((const __m256i *) &S->h[0]);
+    const __m256i h1 = _mm256_loadu_si256((const __m256i *) &S->h[4]);
+    __m256i a = h0;
+    __m256i b = h1;
+    __m256i c = _mm256_loadu_si256((const __m256i *) &blake2b_IV[0]);
+    __m256i d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) &blake2b_IV[4]),
+                                 _mm256_set_epi64x((int64_t) S->f[1], (int64_t) S->f[0],
+                                                   (int64_t) S->t[1], (int64_t) S->t[0]));
+
+    BLAKE2B_ROUNDS(AVX_ROUND);
+
+    _mm256_storeu_si256((__m256i *) &S->h[0], _mm256_xor_si256(h0, _mm256_xor_si256(a, c)));
+    _mm256_storeu_si256((__m256i *) &S->h[4], _mm256_xor_si256(h1, _mm256_xor_si256(b, d)));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////
+// AVX2, four messages at once: lane l of v[i] holds word i of the state of message l
+
+#define MANY_G(r, i, a, b, c, d)                                                                    \
+    do {                                                                                            \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), m[blake2b_sigma[r][2 * (i)]]);                 \
+        d = AVX_ROT32(_mm256_xor_si256(d, a));                                                      \
+        c = _mm256_add_epi64(c, d);                                                                 \
+        b = AVX_ROT24(_mm256_xor_si256(b, c));                                                      \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), m[blake2b_sigma[r][2 * (i) + 1]]);             \
+        d = AVX_ROT16(_mm256_xor_si256(d, a));                                                      \
+        c = _mm256_add_epi64(c, d);                                                                 \
+        b = AVX_ROT63(_mm256_xor_si256(b, c));                                                      \
+    } while (0)
+
+#define MANY_ROUND(r)                                                       \
+    do {                                                                    \
+        MANY_G(r, 0, v[0], v[4], v[8], v[12]);                              \
+        MANY_G(r, 1, v[1], v[5], v[9], v[13]);                              \
+        MANY_G(r, 2, v[2], v[6], v[10], v[14]);                             \
+        MANY_G(r, 3, v[3], v[7], v[11], v[15]);                             \
+        MANY_G(r, 4, v[0], v[5], v[10], v[15]);                             \
+        MANY_G(r, 5, v[1], v[6], v[11], v[12]);                             \
+        MANY_G(r, 6, v[2], v[7], v[8], v[13]);                              \
+        MANY_G(r, 7, v[3], v[4], v[9], v[14]);                              \
+    } while (0)
+
+#define MANY_LANES  4
+
+// Hashes items[0..numItems), numItems <= MANY_LANES. Messages may have different lengths: a lane
+// that has no block left keeps its state while the others go on.
+__attribute__((target("avx2")))
+static void blake2b_many4_avx2(const blake2b_many_item_t *items, size_t numItems, size_t outlen) {
+    const __m256i rot24 = _mm256_setr_epi8(BLAKE2B_ROT24_MASK, BLAKE2B_ROT24_MASK);
+    const __m256i rot16 = _mm256_setr_epi8(BLAKE2B_ROT16_MASK, BLAKE2B_ROT16_MASK);
+
+    // last, zero padded, block of each message
+    uint8_t tails[MANY_LANES][BLAKE2B_BLOCKBYTES];
+    const uint8_t *inputs[MANY_LANES];
+    size_t lens[MANY_LANES];
+    size_t blocks[MANY_LANES];
+    size_t maxBlocks = 0;
+    for (size_t l = 0; l < MANY_LANES; l++) {
+        inputs[l] = l < numItems ? (const uint8_t *) items[l].in : NULL;
+        lens[l] = l < numItems ? items[l].inlen : 0;
+        blocks[l] = lens[l] == 0 ? 1 : (lens[l] + BLAKE2B_BLOCKBYTES - 1) / BLAKE2B_BLOCKBYTES;
+        if (blocks[l] > maxBlocks) {
+            maxBlocks = blocks[l];
+        }
+
+        const size_t tailOffset = (blocks[l] - 1) * BLAKE2B_BLOCKBYTES;
+        memset(tails[l], 0, BLAKE2B_BLOCKBYTES);
+        if (lens[l] > tailOffset) {
+            memcpy(tails[l], inputs[l] + tailOffset, lens[l] - tailOffset);
+        }
+    }
+
+    __m256i h[8];
+    for (int i = 0; i < 8; i++) {
+        h[i] = _mm256_set1_epi64x((int64_t) blake2b_IV[i]);
+    }
+    h[0] = _mm256_xor_si256(h[0], _mm256_set1_epi64x((int64_t) (0x01010000ULL ^ (uint64_t) outlen)));
+
+    for (size_t j = 0; j < maxBlocks; j++) {
+        const uint8_t *rows[MANY_LANES];
+        uint64_t counter[MANY_LANES];
+        uint64_t final[MANY_LANES];
+        uint64_t active[MANY_LANES];
+        for (size_t l = 0; l < MANY_LANES; l++) {
+            const bool last = j + 1 >= blocks[l];
+            rows[l] = last ? tails[l] : inputs[l] + j * BLAKE2B_BLOCKBYTES;
+            counter[l] = last ? lens[l] : (j + 1) * BLAKE2B_BLOCKBYTES;
+            final[l] = last ? UINT64_MAX : 0;
+            active[l] = j < blocks[l] ? UINT64_MAX : 0;
+        }
+
+        // 4x4 transposes of 64-bit words: m[i] gets word i of the four blocks
+        __m256i m[16];
+        for (int g = 0; g < 4; g++) {
+            const __m256i r0 = _mm256_loadu_si256((const __m256i *) (rows[0] + 32 * g));
+            const __m256i r1 = _mm256_loadu_si256((const __m256i *) (rows[1] + 32 * g));
+            const __m256i r2 = _mm256_loadu_si256((const __m256i *) (rows[2] + 32 * g));
+            const __m256i r3 = _mm256_loadu_si256((const __m256i *) (rows[3] + 32 * g));
+            const __m256i t0 = _mm256_unpacklo_epi64(r0, r1);
+            const __m256i t1 = _mm256_unpackhi_epi64(r0, r1);
+            const __m256i t2 = _mm256_unpacklo_epi64(r2, r3);
+            const __m256i t3 = _mm256_unpackhi_epi64(r2, r3);
+            m[4 * g + 0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+            m[4 * g + 1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+            m[4 * g + 2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+            m[4 * g + 3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+        }
+
+        __m256i v[16];
+        for (int i = 0; i < 8; i++) {
+            v[i] = h[i];
+            v[i + 8] = _mm256_set1_epi64x((int64_t) blake2b_IV[i]);
+        }
+        // messages handled here are shorter than 2^64 bytes, the high counter word stays 0
+        v[12] = _mm256_xor_si256(v[12], _mm256_loadu_si256((const __m256i *) counter));
+        v[14] = _mm256_xor_si256(v[14], _mm256_loadu_si256((const __m256i *) final));
+
+        BLAKE2B_ROUNDS(MANY_ROUND);
+
+        const __m256i mask = _mm256_loadu_si256((const __m256i *) active);
+        for (int i = 0; i < 8; i++) {
+            const __m256i next = _mm256_xor_si256(h[i], _mm256_xor_si256(v[i], v[i + 8]));
+            h[i] = _mm256_blendv_epi8(h[i], next, mask);
+        }
+    }
+
+    uint64_t words[8][MANY_LANES];
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *) words[i], h[i]);
+    }
+    for (size_t l = 0; l < numItems; l++) {
+        uint8_t digest[BLAKE2B_OUTBYTES];
+        for (int i = 0; i < 8; i++) {
+            for (int k = 0; k < 8; k++) {
+                digest[8 * i + k] = (uint8_t) (words[i][l] >> (8u * k));
+            }
+        }
+        memcpy(items[l].out, digest, outlen);
+    }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Dispatch
+
+#if BLAKE2B_SIMD
+// CPU features do not change while the process runs, they are queried once. Batch validation
+// workers hash concurrently, so the first use is synchronized
+static pthread_once_t blake2b_featuresOnce = PTHREAD_ONCE_INIT;
+static bool blake2b_hasAvx2 = false;
+static bool blake2b_hasSse41 = false;
+
+static void blake2b_detectFeatures() {
+    __builtin_cpu_init();
+    blake2b_hasAvx2 = __builtin_cpu_supports("avx2");
+    blake2b_hasSse41 = __builtin_cpu_supports("sse4.1");
+}
+#endif
+
+static blake2b_backend_e blake2b_resolve(blake2b_backend_e backend) {
+#if BLAKE2B_SIMD
+    pthread_once(&blake2b_featuresOnce, blake2b_detectFeatures);
+    const bool avx2 = blake2b_hasAvx2;
+    const bool sse41 = blake2b_hasSse41;
+
+    switch (backend) {
+        case blake2b_backend_auto:
+            return avx2 ? blake2b_backend_avx2 : (sse41 ? blake2b_backend_sse41 : blake2b_backend_portable);
+        case blake2b_backend_avx2:
+            return avx2 ? blake2b_backend_avx2 : blake2b_backend_portable;
+        case blake2b_backend_sse41:
+            return sse41 ? blake2b_backend_sse41 : blake2b_backend_portable;
+        default:
+            return blake2b_backend_portable;
+    }
+#else
+    (void) backend;
+    return blake2b_backend_portable;
+#endif
+}
+
+static blake2b_compress_fn blake2b_compressFor(blake2b_backend_e backend) {
+    switch (blake2b_resolve(backend)) {
+#if BLAKE2B_SIMD
+        case blake2b_backend_avx2:
+            return blake2b_compress_avx2;
+        case blake2b_backend_sse41:
+            return blake2b_compress_sse41;
+#endif
+        default:
+            return blake2b_compress_portable;
+    }
+}
+
+#if BLAKE2B_SIMD
+// Compression function for blake2b_backend_auto, resolved once, on the first hash
+static pthread_once_t blake2b_autoOnce = PTHREAD_ONCE_INIT;
+static blake2b_compress_fn blake2b_autoCompress = blake2b_compress_portable;
+
+static void blake2b_resolveAuto() {
+    blake2b_autoCompress = blake2b_compressFor(blake2b_backend_auto);
+}
+#endif
+
+static blake2b_compress_fn blake2b_compressAuto() {
+#if BLAKE2B_SIMD
+    pthread_once(&blake2b_autoOnce, blake2b_resolveAuto);
+    return blake2b_autoCompress;
+#else
+    return blake2b_compress_portable;
+#endif
+}
+
+blake2b_backend_e blake2b_selected_backend() {
+    return blake2b_resolve(blake2b_backend_auto);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// blake2.h interface
+
+static void blake2b_incrementCounter(blake2b_state *S, uint64_t inc) {
+    S->t[0] += inc;
+    S->t[1] += (S->t[0] < inc);
+}
+
+static int blake2b_initParams(blake2b_state *S, size_t outlen, size_t keylen) {
+    if (S == NULL || outlen == 0 || outlen > BLAKE2B_OUTBYTES || keylen > BLAKE2B_KEYBYTES) {
+        return -1;
+    }
+
+    memset(S, 0, sizeof(blake2b_state));
+    for (int i = 0; i < 8; i++) {
+        S->h[i] = blake2b_IV[i];
+    }
+    // sequential mode: fanout 1, depth 1, no salt or personalization
+    S->h[0] ^= 0x01010000ULL ^ ((uint64_t) keylen << 8u) ^ (uint64_t) outlen;
+    S->outlen = outlen;
+    return 0;
+}
+
+static int blake2b_updateWith(blake2b_compress_fn compress, blake2b_state *S, const void *pin, size_t inlen) {
+    const uint8_t *in = (const uint8_t *) pin;
+    if (inlen == 0) {
+        return 0;
+    }
+    if (S == NULL || in == NULL) {
+        return -1;
+    }
+
+    // The last block is always kept in the buffer, it is compressed by blake2b_final
+    const size_t left = S->buflen;
+    const size_t fill = BLAKE2B_BLOCKBYTES - left;
+    if (inlen > fill) {
+        S->buflen = 0;
+        memcpy(S->buf + left, in, fill);
+        blake2b_incrementCounter(S, BLAKE2B_BLOCKBYTES);
+        compress(S, S->buf);
+        in += fill;
+        inlen -= fill;
+
+        // whole blocks straight from the input
+        while (inlen > BLAKE2B_BLOCKBYTES) {
+            blake2b_incrementCounter(S, BLAKE2B_BLOCKBYTES);
+            compress(S, in);
+            in += BLAKE2B_BLOCKBYTES;
+            inlen -= BLAKE2B_BLOCKBYTES;
+        }
+    }
+    memcpy(S->buf + S->buflen, in, inlen);
+    S->buflen += inlen;
+    return 0;
+}
+
+static int blake2b_finalWith(blake2b_compress_fn compress, blake2b_state *S, void *out, size_t outlen) {
+    if (S == NULL || out == NULL || outlen < S->outlen || S->f[0] != 0) {
+        return -1;
+    }
+
+    blake2b_incrementCounter(S, S->buflen);
+    S->f[0] = UINT64_MAX;
+    if (S->last_node) {
+        S->f[1] = UINT64_MAX;
+    }
+    memset(S->buf + S->buflen, 0, BLAKE2B_BLOCKBYTES - S->buflen);
+    compress(S, S->buf);
+
+    uint8_t buffer[BLAKE2B_OUTBYTES];
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            buffer[8 * i + j] = (uint8_t) (S->h[i] >> (8u * j));
+        }
+    }
+    memcpy(out, buffer, S->outlen);
+    memset(buffer, 0, sizeof(buffer));
+    return 0;
+}
+
+int blake2b_init(blake2b_state *S, size_t outlen) {
+    return blake2b_initParams(S, outlen, 0);
+}
+
+int blake2b_init_key(blake2b_state *S, size_t outlen, const void *key, size_t keylen) {
+    if (key == NULL || keylen == 0 || blake2b_initParams(S, outlen, keylen) != 0) {
+        return -1;
+    }
+
+    // the key is hashed as a whole block of its own
+    uint8_t block[BLAKE2B_BLOCKBYTES];
+    memset(block, 0, sizeof(block));
+    memcpy(block, key, keylen);
+    blake2b_update(S, block, BLAKE2B_BLOCKBYTES);
+    memset(block, 0, sizeof(block));
+    return 0;
+}
+
+int blake2b_update(blake2b_state *S, const void *in, size_t inlen) {
+    return blake2b_updateWith(blake2b_compressAuto(), S, in, inlen);
+}
+
+int blake2b_final(blake2b_state *S, void *out, size_t outlen) {
+    return blake2b_finalWith(blake2b_compressAuto(), S, out, outlen);
+}
+
+int blake2b(void *out, size_t outlen, const void *in, size_t inlen, const void *key, size_t keylen) {
+    if ((in == NULL && inlen > 0) || out == NULL || (key == NULL && keylen > 0)) {
+        return -1;
+    }
+
+    blake2b_state S;
+    const int err = keylen > 0 ? blake2b_init_key(&S, outlen, key, keylen) : blake2b_init(&S, outlen);
+    if (err != 0) {
+        return -1;
+    }
+    blake2b_update(&S, in, inlen);
+    return blake2b_final(&S, out, outlen);
+}
+
+int blake2b_with_backend(blake2b_backend_e backend, void *out, size_t outlen, const void *in, size_t inlen) {
+    if ((in == NULL && inlen > 0) || out == NULL) {
+        return -1;
+    }
+
+    const blake2b_compress_fn compress = blake2b_compressFor(backend);
+    blake2b_state S;
+    if (blake2b_init(&S, outlen) != 0) {
+        return -1;
+    }
+    blake2b_updateWith(compress, &S, in, inlen);
+    return blake2b_finalWith(compress, &S, out, outlen);
+}
+
+int blake2b_many_with_backend(blake2b_backend_e backend, const blake2b_many_item_t *items, size_t numItems,
+                              size_t outlen) {
+    if (outlen == 0 || outlen > BLAKE2B_OUTBYTES || (items == NULL && numItems > 0)) {
+        return -1;
+    }
+    for (size_t i = 0; i < numItems; i++) {
+        if (items[i].out == NULL || (items[i].in == NULL && items[i].inlen > 0)) {
+            return -1;
+        }
+    }
+
+    backend = blake2b_resolve(backend);
+#if BLAKE2B_SIMD
+    if (backend == blake2b_backend_avx2) {
+        for (size_t i = 0; i < numItems; i += MANY_LANES) {
+            blake2b_many4_avx2(items + i, numItems - i < MANY_LANES ? numItems - i : MANY_LANES, outlen);
+        }
+        return 0;
+    }
+#endif
+
+    for (size_t i = 0; i < numItems; i++) {
+        blake2b_with_backend(backend, items[i].out, outlen, items[i].in, items[i].inlen);
+    }
+    return 0;
+}
+
+int blake2b_many(const blake2b_many_item_t *items, size_t numItems, size_t outlen) {
+    return blake2b_many_with_backend(blake2b_backend_auto, items, numItems, outlen);
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "blake2.h"
+
+// Host only: BLAKE2b behind the blake2b_init/update/final interface of blake2.h, replacing the
+// reference implementation. The compression function is chosen at runtime from the CPU features.
+
+typedef enum {
+    blake2b_backend_auto,
+    blake2b_backend_portable,
+    blake2b_backend_sse41,
+    blake2b_backend_avx2,
+} blake2b_backend_e;
+
+/// Unkeyed one-shot BLAKE2b with a given backend, backends the CPU does not support fall back to portable code.
+/// blake2b_update and blake2b_final use the fastest one available.
+/// \return 0 on success, -1 on invalid parameters (as blake2b)
+int blake2b_with_backend(blake2b_backend_e backend, void *out, size_t outlen, const void *in, size_t inlen);
+
+/// Backend blake2b_backend_auto resolves to on this CPU
+blake2b_backend_e blake2b_selected_backend();
+
+typedef struct {
+    const void *in;
+    size_t inlen;
+    uint8_t *out;
+} blake2b_many_item_t;
+
+/// Unkeyed BLAKE2b of several independent messages, all with the same digest length.
+/// With AVX2 four messages are hashed at once, one per 64-bit lane, which suits many short
+/// inputs (checksums, public key hashes) where a single message cannot use the vector width.
+/// \return 0 on success, -1 on invalid parameters
+int blake2b_many(const blake2b_many_item_t *items, size_t numItems, size_t outlen);
+
+/// blake2b_many with a given backend, only AVX2 interleaves messages, other backends hash them one by one
+int blake2b_many_with_backend(blake2b_backend_e backend, const blake2b_many_item_t *items, size_t numItems,
+                              size_t outlen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,12 +26,15 @@
 extern uint16_t action_addrResponseLen;
 
 __Z_INLINE void app_sign() {
-    const uint8_t *message = tx_get_buffer();
-    const uint16_t messageLength = tx_get_buffer_length();
+    // The message was hashed while its chunks arrived, only the signature is left
+    const uint8_t *digest = tx_get_digest();
     uint16_t replyLen = 0;
 
     MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
-    zxerr_t err = crypto_sign(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, message, messageLength, &replyLen);
+    zxerr_t err = zxerr_no_data;
+    if (digest != NULL) {
+        err = crypto_signDigest(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, digest, BLAKE2B_256_SIZE, &replyLen);
+    }
 
     if (err != zxerr_ok || replyLen == 0) {
         set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
@@ -38,6 +38,8 @@
 #define INS_GET_VERSION                 0x00
 #define INS_GET_ADDR_SECP256K1          0x01
 #define INS_SIGN_SECP256K1              0x02
+#define INS_SIGN_STREAM_SECP256K1       0x03
+#define INS_GET_ADDR_BATCH_SECP256K1    0x04
 
 void app_init();
 
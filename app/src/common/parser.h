@@ -42,6 +42,31 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
                               char *outVal, uint16_t outValLen,
                               uint8_t pageIdx, uint8_t *pageCount);
 
+//// Reentrant variants
+//// The parsed tx is stored in caller-owned memory that stays referenced by ctx->tx_obj,
+//// so independent contexts can be used concurrently. The functions above use a global tx object.
+
+//// parses a tx buffer into tx_obj
+parser_error_t parser_parse_r(parser_context_t *ctx, const uint8_t *data, size_t dataLen, parser_tx_t *tx_obj);
+
+//// verifies tx fields
+parser_error_t parser_validate_r(const parser_context_t *ctx);
+
+//// verifies tx fields without rendering them
+//// Accepts and rejects exactly the same txs as parser_validate_r (with the same error), but is much cheaper.
+//// Useful when only the verdict is needed, items still have to be rendered with parser_getItem_r to be shown.
+parser_error_t parser_validate_structural(const parser_context_t *ctx);
+
+//// returns the number of items in the current parsing context
+parser_error_t parser_getNumItems_r(const parser_context_t *ctx, uint8_t *num_items);
+
+// retrieves a readable output for each field / page
+parser_error_t parser_getItem_r(const parser_context_t *ctx,
+                                uint8_t displayIdx,
+                                char *outKey, uint16_t outKeyLen,
+                                char *outVal, uint16_t outValLen,
+                                uint8_t pageIdx, uint8_t *pageCount);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,8 @@ extern "C" {
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
+#include "parser_txdef.h"
 
 #define CHECK_PARSER_ERR(__CALL) { \
     parser_error_t __err = __CALL;  \
@@ -58,12 +60,57 @@ typedef enum {
     // Required fields
     parser_required_nonce,
     parser_required_method,
+    // Streaming sign
+    parser_stream_not_needed,
 } parser_error_t;
 
+#define PARSER_CACHE_MAX_ITEMS  40
+#define PARSER_CACHE_NO_ENTRY   0xFFFF
+
+// Rendered values kept by parser_validate so that later page requests are a copy
+// Each entry is stored in the arena as "value\0key\0"
+typedef struct {
+    uint8_t *arena;
+    uint16_t arenaSize;
+    uint16_t arenaUsed;
+    // arena offset of each display item, PARSER_CACHE_NO_ENTRY if it is not cached
+    uint16_t entries[PARSER_CACHE_MAX_ITEMS];
+    // value staged while validation renders an item
+    bool filling;
+    bool staged;
+} parser_render_cache_t;
+
+// protocol byte + the longest (BLS) payload
+#define PARSER_ADDRESS_MEMO_KEY_LEN     49
+#define PARSER_ADDRESS_CHECKSUM_LEN     4
+
+// Address checksums already computed, so that showing an address again only base32 encodes it
+typedef struct {
+    uint8_t addressLen;
+    uint8_t address[PARSER_ADDRESS_MEMO_KEY_LEN];
+    uint8_t checksum[PARSER_ADDRESS_CHECKSUM_LEN];
+    // memo clock when the entry was last used, 0 if the entry is free
+    uint32_t lastUse;
+} parser_address_memo_entry_t;
+
+typedef struct {
+    parser_address_memo_entry_t *entries;
+    uint16_t numEntries;
+    uint32_t clock;
+    // number of checksums that had to be computed
+    uint32_t misses;
+} parser_address_memo_t;
+
 typedef struct {
     const uint8_t *buffer;
-    uint16_t bufferLen;
-    uint16_t offset;
+    parser_size_t bufferLen;
+    parser_size_t offset;
+    // caller-owned storage for the parsed transaction
+    parser_tx_t *tx_obj;
+    // optional, attached after parsing
+    parser_render_cache_t *cache;
+    // optional, attached after parsing
+    parser_address_memo_t *addressMemo;
 } parser_context_t;
 
 #ifdef __cplusplus
@@ -17,7 +17,11 @@
 #include "tx.h"
 #include "apdu_codes.h"
 #include "buffering.h"
+#include "crypto.h"
 #include "parser.h"
+#include "parser_cache.h"
+#include "parser_stream.h"
+#include "parser_bounded.h"
 #include <string.h>
 #include "zxmacros.h"
 
@@ -43,6 +47,36 @@ storage_t NV_CONST N_appdata_impl __attribute__ ((aligned(64)));
 #endif
 
 parser_context_t ctx_parsed_tx;
+uint8_t tx_message_digest[BLAKE2B_256_SIZE];
+bool tx_digest_ready = false;
+
+// Only one sign mode is in use at a time
+typedef union {
+    // Buffered mode: chunks are hashed as they arrive, so signing does not read the message back from flash
+    crypto_digest_t digest;
+    // Streaming mode: the message is not kept, only the fields before the params (in ram_buffer)
+    parser_bounded_t bounded;
+} tx_state_t;
+
+tx_state_t tx_state;
+bool tx_streaming = false;
+
+#if defined(TARGET_NANOX)
+// Nano X only: Nano S parses the buffered message once, after the last chunk, and renders values again
+// when paging through them
+
+parser_stream_t tx_stream;
+
+// Values rendered by parser_validate are kept so that scrolling through the review does not render them again
+#define RENDER_CACHE_SIZE 2048
+uint8_t render_cache_arena[RENDER_CACHE_SIZE];
+parser_render_cache_t render_cache;
+
+// Checksums of the addresses being shown (to and from), so that paging through them does not hash them again
+#define ADDRESS_MEMO_ENTRIES 2
+parser_address_memo_entry_t address_memo_entries[ADDRESS_MEMO_ENTRIES];
+parser_address_memo_t address_memo;
+#endif
 
 void tx_initialize() {
     buffering_init(
@@ -55,10 +89,51 @@ void tx_initialize() {
 
 void tx_reset() {
     buffering_reset();
+#if defined(TARGET_NANOX)
+    parser_stream_init(&tx_stream, &parser_tx_obj);
+#endif
+    crypto_digestInit(&tx_state.digest);
+    tx_streaming = false;
+    tx_digest_ready = false;
+}
+
+void tx_reset_streaming() {
+    // Messages that fit the flash buffer go through the regular sign mode, which shows their params
+    parser_bounded_init(&tx_state.bounded, &parser_tx_obj, ram_buffer, sizeof(ram_buffer), FLASH_BUFFER_SIZE);
+    tx_streaming = true;
+    tx_digest_ready = false;
 }
 
 uint32_t tx_append(unsigned char *buffer, uint32_t length) {
-    return buffering_append(buffer, length);
+    if (tx_streaming) {
+        // Nothing is buffered, errors are reported by tx_parse_partial and tx_parse
+        parser_bounded_update(&tx_state.bounded, buffer, length);
+        return length;
+    }
+
+    const uint32_t added = buffering_append(buffer, length);
+    if (added == length) {
+        crypto_digestUpdate(&tx_state.digest, buffer, length);
+    }
+    return added;
+}
+
+zxerr_t tx_finish_digest() {
+    if (tx_streaming) {
+        // finished along with the message, by tx_parse
+        return zxerr_ok;
+    }
+
+    CHECK_ZXERR(crypto_digestFinal(&tx_state.digest, tx_message_digest, sizeof(tx_message_digest)))
+    tx_digest_ready = true;
+    return zxerr_ok;
+}
+
+const uint8_t *tx_get_digest() {
+    if (tx_streaming) {
+        return parser_bounded_digest(&tx_state.bounded);
+    }
+    return tx_digest_ready ? tx_message_digest : NULL;
 }
 
 uint32_t tx_get_buffer_length() {
@@ -69,17 +144,65 @@ uint8_t *tx_get_buffer() {
     return buffering_get_buffer()->data;
 }
 
-const char *tx_parse() {
-    uint8_t err = parser_parse(
-            &ctx_parsed_tx,
+const char *tx_parse_partial() {
+    if (tx_streaming) {
+        // chunks were already read by tx_append
+        if (tx_state.bounded.error != parser_ok) {
+            return parser_getErrorDescription(tx_state.bounded.error);
+        }
+        return NULL;
+    }
+
+#if defined(TARGET_NANOX)
+    const parser_error_t err = parser_stream_update(
+            &tx_stream,
             tx_get_buffer(),
             tx_get_buffer_length());
 
     if (err != parser_ok) {
         return parser_getErrorDescription(err);
     }
+#endif
+
+    // Nano S reads the whole message in tx_parse
+    return NULL;
+}
 
-    err = parser_validate(&ctx_parsed_tx);
+const char *tx_parse() {
+    uint8_t err;
+    if (tx_streaming) {
+        err = parser_bounded_finish(&tx_state.bounded, &ctx_parsed_tx);
+    } else {
+#if defined(TARGET_NANOX)
+        // Only the fields that were not complete in the previous chunks are left to read
+        err = parser_stream_finish(
+                &tx_stream,
+                &ctx_parsed_tx,
+                tx_get_buffer(),
+                tx_get_buffer_length());
+#else
+        err = parser_parse(
+                &ctx_parsed_tx,
+                tx_get_buffer(),
+                tx_get_buffer_length());
+#endif
+    }
+
+    if (err != parser_ok) {
+        return parser_getErrorDescription(err);
+    }
+
+#if defined(TARGET_NANOX)
+    parser_cacheAttach(&ctx_parsed_tx, &render_cache, render_cache_arena, sizeof(render_cache_arena));
+    parser_addressMemoInit(&address_memo, address_memo_entries, ADDRESS_MEMO_ENTRIES);
+    parser_addressMemoAttach(&ctx_parsed_tx, &address_memo);
+#endif
+
+    if (tx_streaming) {
+        err = parser_bounded_validate(&tx_state.bounded, &ctx_parsed_tx);
+    } else {
+        err = parser_validate(&ctx_parsed_tx);
+    }
     CHECK_APP_CANARY()
 
     if (err != parser_ok) {
@@ -92,7 +215,12 @@ const char *tx_parse() {
 }
 
 zxerr_t tx_getNumItems(uint8_t *num_items) {
-    parser_error_t err = parser_getNumItems(&ctx_parsed_tx, num_items);
+    parser_error_t err;
+    if (tx_streaming) {
+        err = parser_bounded_getNumItems(&tx_state.bounded, num_items);
+    } else {
+        err = parser_getNumItems(&ctx_parsed_tx, num_items);
+    }
 
     if (err != parser_ok) {
         return zxerr_no_data;
@@ -113,11 +241,20 @@ zxerr_t tx_getItem(int8_t displayIdx,
         return zxerr_no_data;
     }
 
-    parser_error_t err = parser_getItem(&ctx_parsed_tx,
-                                        displayIdx,
-                                        outKey, outKeyLen,
-                                        outVal, outValLen,
-                                        pageIdx, pageCount);
+    parser_error_t err;
+    if (tx_streaming) {
+        err = parser_bounded_getItem(&tx_state.bounded, &ctx_parsed_tx,
+                                     displayIdx,
+                                     outKey, outKeyLen,
+                                     outVal, outValLen,
+                                     pageIdx, pageCount);
+    } else {
+        err = parser_getItem(&ctx_parsed_tx,
+                             displayIdx,
+                             outKey, outKeyLen,
+                             outVal, outValLen,
+                             pageIdx, pageCount);
+    }
 
     // Convert error codes
     if (err == parser_no_data ||
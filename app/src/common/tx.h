@@ -24,6 +24,11 @@ void tx_initialize();
 /// Clears the transaction buffer
 void tx_reset();
 
+/// Starts a message in streaming mode: chunks are read as they arrive and are not kept,
+/// so the message can be larger than the transaction buffer. Params are shown as their size,
+/// followed by the message CID (see parser_bounded.h)
+void tx_reset_streaming();
+
 /// Appends buffer to the end of the current transaction buffer
 /// Transaction buffer will grow until it reaches the maximum allowed size
 /// \param buffer
@@ -31,6 +36,14 @@ void tx_reset();
 /// \return It returns an error message if the buffer is too small.
 uint32_t tx_append(unsigned char *buffer, uint32_t length);
 
+/// Finishes the digest of the chunks appended since tx_reset
+/// This function should be called once, after the last chunk has been appended.
+zxerr_t tx_finish_digest();
+
+/// Returns the digest to sign (BLAKE2B_256_SIZE bytes)
+/// \return NULL if tx_finish_digest has not been called since tx_reset
+const uint8_t *tx_get_digest();
+
 /// Returns size of the raw json transaction buffer
 /// \return
 uint32_t tx_get_buffer_length();
@@ -39,6 +52,11 @@ uint32_t tx_get_buffer_length();
 /// \return
 uint8_t *tx_get_buffer();
 
+/// Parse the fields of the message that are complete in the transaction buffer
+/// This function can be called after each chunk, so that malformed messages are rejected early.
+/// \return It returns NULL if data received so far is valid or error message otherwise.
+const char *tx_parse_partial();
+
 /// Parse message stored in transaction buffer
 /// This function should be called as soon as full buffer data is loaded.
 /// \return It returns NULL if data is valid or error message otherwise.
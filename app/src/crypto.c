@@ -15,10 +15,13 @@
 ********************************************************************************/
 
 #include "crypto.h"
+#include <string.h>
 #include "coin.h"
 #include "zxmacros.h"
 #include "base32.h"
 #include "zxformat.h"
+#include "page_slice.h"
+#include "int_decimal.h"
 
 uint32_t hdPath[HDPATH_LEN_DEFAULT];
 
@@ -29,6 +32,7 @@ bool isTestnet() {
 
 #if defined(TARGET_NANOS) || defined(TARGET_NANOX)
 #include "cx.h"
+#include "bip32.h"
 
 zxerr_t crypto_extractPublicKey(const uint32_t path[HDPATH_LEN_DEFAULT], uint8_t *pubKey, uint16_t pubKeyLen) {
     cx_ecfp_public_key_t cx_publicKey;
@@ -106,17 +110,36 @@ typedef struct {
 } __attribute__((packed)) signature_t;
 
 
-zxerr_t crypto_sign(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen, uint16_t *sigSize) {
-    if (signatureMaxlen < sizeof(signature_t) ) {
-        return zxerr_invalid_crypto_settings;
-    }
+void crypto_digestInit(crypto_digest_t *digest) {
+    cx_blake2b_init(&digest->state, BLAKE2B_256_SIZE * 8);
+}
+
+void crypto_digestUpdate(crypto_digest_t *digest, const uint8_t *chunk, uint32_t chunkLen) {
+    cx_hash(&digest->state.header, 0, chunk, chunkLen, NULL, 0);
+}
 
+__Z_INLINE void digest_finalHash(crypto_digest_t *digest, uint8_t *messageHash) {
+    cx_hash(&digest->state.header, CX_LAST, NULL, 0, messageHash, BLAKE2B_256_SIZE);
+}
+
+zxerr_t crypto_sign(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen, uint16_t *sigSize) {
     uint8_t tmp[BLAKE2B_256_SIZE];
     uint8_t message_digest[BLAKE2B_256_SIZE];
 
     blake_hash(message, messageLen, tmp, BLAKE2B_256_SIZE);
     blake_hash_cid(tmp, BLAKE2B_256_SIZE, message_digest, BLAKE2B_256_SIZE);
 
+    return crypto_signDigest(buffer, signatureMaxlen, message_digest, sizeof(message_digest), sigSize);
+}
+
+zxerr_t crypto_signDigest(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *message_digest, uint16_t digestLen, uint16_t *sigSize) {
+    if (signatureMaxlen < sizeof(signature_t) ) {
+        return zxerr_invalid_crypto_settings;
+    }
+    if (digestLen != BLAKE2B_256_SIZE) {
+        return zxerr_invalid_crypto_settings;
+    }
+
     cx_ecfp_private_key_t cx_privateKey;
     uint8_t privateKeyData[32];
     int signatureLength = 0;
@@ -172,10 +195,88 @@ zxerr_t crypto_sign(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *me
     return zxerr_ok;
 }
 
+zxerr_t crypto_fillAddressBatch(const uint32_t path[HDPATH_LEN_DEFAULT], uint8_t count,
+                                uint8_t *buffer, uint16_t bufferLen) {
+    if (bufferLen < count * ADDRESS_SECP256K1_BYTES_LEN) {
+        return zxerr_buffer_too_small;
+    }
+
+    cx_ecfp_public_key_t cx_publicKey;
+    cx_ecfp_private_key_t cx_privateKey;
+    uint8_t parentKey[BIP32_KEY_LEN];
+    uint8_t chainCode[BIP32_CHAIN_CODE_LEN];
+    uint8_t parentPublicKey[BIP32_PUBLIC_KEY_LEN];
+    uint8_t childKey[BIP32_KEY_LEN];
+#ifdef APP_TESTING
+    uint32_t childPath[HDPATH_LEN_DEFAULT];
+    uint8_t osChildKey[BIP32_KEY_LEN];
+    MEMCPY(childPath, path, sizeof(childPath));
+#endif
+
+    zxerr_t error = zxerr_ok;
+    BEGIN_TRY
+    {
+        TRY {
+            // Every component but the last is derived once, siblings are derived from that node
+            os_perso_derive_node_bip32(CX_CURVE_256K1,
+                                       path,
+                                       HDPATH_LEN_DEFAULT - 1,
+                                       parentKey, chainCode);
+
+            cx_ecfp_init_private_key(CX_CURVE_256K1, parentKey, 32, &cx_privateKey);
+            cx_ecfp_init_public_key(CX_CURVE_256K1, NULL, 0, &cx_publicKey);
+            cx_ecfp_generate_pair(CX_CURVE_256K1, &cx_publicKey, &cx_privateKey, 1);
+
+            parentPublicKey[0] = 0x02 | (cx_publicKey.W[64] & 0x01);
+            MEMCPY(parentPublicKey + 1, cx_publicKey.W + 1, 32);
+
+            for (uint8_t i = 0; i < count; i++) {
+                if (!bip32_deriveChildKey(parentKey, chainCode, parentPublicKey, path[HDPATH_LEN_DEFAULT - 1] + i,
+                                          childKey, NULL)) {
+                    error = zxerr_invalid_crypto_settings;
+                    break;
+                }
+#ifdef APP_TESTING
+                // Test builds check every child against the key the OS derives for the full path
+                childPath[HDPATH_LEN_DEFAULT - 1] = path[HDPATH_LEN_DEFAULT - 1] + i;
+                os_perso_derive_node_bip32(CX_CURVE_256K1, childPath, HDPATH_LEN_DEFAULT, osChildKey, NULL);
+                const bool sameKey = MEMCMP(osChildKey, childKey, sizeof(childKey)) == 0;
+                MEMZERO(osChildKey, sizeof(osChildKey));
+                if (!sameKey) {
+                    error = zxerr_invalid_crypto_settings;
+                    break;
+                }
+#endif
+
+                cx_ecfp_init_private_key(CX_CURVE_256K1, childKey, 32, &cx_privateKey);
+                cx_ecfp_init_public_key(CX_CURVE_256K1, NULL, 0, &cx_publicKey);
+                cx_ecfp_generate_pair(CX_CURVE_256K1, &cx_publicKey, &cx_privateKey, 1);
+
+                uint8_t *addrBytes = buffer + i * ADDRESS_SECP256K1_BYTES_LEN;
+                addrBytes[0] = ADDRESS_PROTOCOL_SECP256K1;
+                blake_hash(cx_publicKey.W, SECP256K1_PK_LEN, addrBytes + 1, ADDRESS_PROTOCOL_SECP256K1_PAYLOAD_LEN);
+            }
+        }
+        CATCH_OTHER(e) {
+            error = zxerr_ledger_api_error;
+        }
+        FINALLY {
+            MEMZERO(&cx_privateKey, sizeof(cx_privateKey));
+            MEMZERO(parentKey, sizeof(parentKey));
+            MEMZERO(chainCode, sizeof(chainCode));
+            MEMZERO(childKey, sizeof(childKey));
+        }
+    }
+    END_TRY;
+
+    return error;
+}
+
 #else
 
 #include <hexutils.h>
 #include "blake2.h"
+#include "blake2b_dispatch.h"
 
 char *crypto_testPubKey;
 
@@ -206,20 +307,67 @@ __Z_INLINE int blake_hash(const unsigned char *in, unsigned int inLen,
     return 0;
 }
 
+// State after blake2b_init(BLAKE2B_256_SIZE) and blake2b_update(PREFIX): the parameter block is
+// folded into h[0] and the prefix waits in the block buffer. CID digests start from a copy of it.
+static const blake2b_state cidPrefixState = {
+        .h = {
+                0x6a09e667f3bcc908ULL ^ 0x01010000ULL ^ BLAKE2B_256_SIZE,
+                0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+                0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+        },
+        .buf = PREFIX,
+        .buflen = CID_PREFIX_LEN,
+        .outlen = BLAKE2B_256_SIZE,
+};
+
 __Z_INLINE int blake_hash_cid(const unsigned char *in, unsigned int inLen,
                               unsigned char *out, unsigned int outLen) {
 
-    uint8_t prefix[] = PREFIX;
-
     blake2b_state s;
-    blake2b_init(&s, outLen);
-    blake2b_update(&s, prefix, sizeof(prefix));
+    if (outLen == BLAKE2B_256_SIZE) {
+        s = cidPrefixState;
+    } else {
+        uint8_t prefix[] = PREFIX;
+        blake2b_init(&s, outLen);
+        blake2b_update(&s, prefix, sizeof(prefix));
+    }
     blake2b_update(&s, in, inLen);
     blake2b_final(&s, out, outLen);
 
     return 0;
 }
 
+void addressChecksumBatch(const uint8_t *const *addresses, const uint16_t *addressLens, size_t numAddresses,
+                          uint8_t (*checksums)[CHECKSUM_LENGTH]) {
+    blake2b_many_item_t items[ADDRESS_BATCH_CHUNK];
+
+    for (size_t start = 0; start < numAddresses; start += ADDRESS_BATCH_CHUNK) {
+        const size_t count = numAddresses - start < ADDRESS_BATCH_CHUNK ? numAddresses - start : ADDRESS_BATCH_CHUNK;
+        for (size_t i = 0; i < count; i++) {
+            items[i].in = addresses[start + i];
+            items[i].inlen = addressLens[start + i];
+            items[i].out = checksums[start + i];
+        }
+        blake2b_many(items, count, CHECKSUM_LENGTH);
+    }
+}
+
+void addressFromPublicKeyBatch(const uint8_t (*publicKeys)[SECP256K1_PK_LEN], size_t numKeys,
+                               uint8_t (*addresses)[ADDRESS_PROTOCOL_LEN + ADDRESS_PROTOCOL_SECP256K1_PAYLOAD_LEN]) {
+    blake2b_many_item_t items[ADDRESS_BATCH_CHUNK];
+
+    for (size_t start = 0; start < numKeys; start += ADDRESS_BATCH_CHUNK) {
+        const size_t count = numKeys - start < ADDRESS_BATCH_CHUNK ? numKeys - start : ADDRESS_BATCH_CHUNK;
+        for (size_t i = 0; i < count; i++) {
+            addresses[start + i][0] = ADDRESS_PROTOCOL_SECP256K1;
+            items[i].in = publicKeys[start + i];
+            items[i].inlen = SECP256K1_PK_LEN;
+            items[i].out = addresses[start + i] + ADDRESS_PROTOCOL_LEN;
+        }
+        blake2b_many(items, count, ADDRESS_PROTOCOL_SECP256K1_PAYLOAD_LEN);
+    }
+}
+
 int prepareDigestToSign(const unsigned char *in, unsigned int inLen,
                         unsigned char *out, unsigned int outLen) {
 
@@ -231,6 +379,18 @@ int prepareDigestToSign(const unsigned char *in, unsigned int inLen,
     return 0;
 }
 
+void crypto_digestInit(crypto_digest_t *digest) {
+    blake2b_init(&digest->state, BLAKE2B_256_SIZE);
+}
+
+void crypto_digestUpdate(crypto_digest_t *digest, const uint8_t *chunk, uint32_t chunkLen) {
+    blake2b_update(&digest->state, chunk, chunkLen);
+}
+
+__Z_INLINE void digest_finalHash(crypto_digest_t *digest, uint8_t *messageHash) {
+    blake2b_final(&digest->state, messageHash, BLAKE2B_256_SIZE);
+}
+
 zxerr_t crypto_sign(uint8_t *signature, uint16_t signatureMaxlen,
                     const uint8_t *message, uint16_t messageLen,
                     uint16_t *sigSize) {
@@ -241,12 +401,55 @@ zxerr_t crypto_sign(uint8_t *signature, uint16_t signatureMaxlen,
     blake_hash(message, messageLen, tmp, BLAKE2B_256_SIZE);
     blake_hash_cid(tmp, BLAKE2B_256_SIZE, message_digest, BLAKE2B_256_SIZE);
 
+    return crypto_signDigest(signature, signatureMaxlen, message_digest, sizeof(message_digest), sigSize);
+}
+
+zxerr_t crypto_signDigest(uint8_t *signature, uint16_t signatureMaxlen,
+                          const uint8_t *digest, uint16_t digestLen,
+                          uint16_t *sigSize) {
+    // Empty version for non-Ledger devices: there is no key to sign with
+    UNUSED(signature);
+    UNUSED(signatureMaxlen);
+    UNUSED(digest);
+    *sigSize = 0;
+    if (digestLen != BLAKE2B_256_SIZE) {
+        return zxerr_invalid_crypto_settings;
+    }
+    return zxerr_unknown;
+}
+
+// Public keys held at once by crypto_fillAddressBatch, a multiple of the 4 lanes blake2b_many hashes together
+#define ADDRESS_FILL_BATCH_CHUNK 16
+
+zxerr_t crypto_fillAddressBatch(const uint32_t path[HDPATH_LEN_DEFAULT], uint8_t count,
+                                uint8_t *buffer, uint16_t bufferLen) {
+    if (bufferLen < count * ADDRESS_SECP256K1_BYTES_LEN) {
+        return zxerr_buffer_too_small;
+    }
+
+    // Keys come from crypto_extractPublicKey one path at a time, their addresses are hashed together,
+    // a few at a time so that the keys do not take much stack
+    uint32_t childPath[HDPATH_LEN_DEFAULT];
+    MEMCPY(childPath, path, sizeof(childPath));
+
+    uint8_t publicKeys[ADDRESS_FILL_BATCH_CHUNK][SECP256K1_PK_LEN];
+    for (uint16_t start = 0; start < count; start += ADDRESS_FILL_BATCH_CHUNK) {
+        const uint16_t chunkLen = count - start < ADDRESS_FILL_BATCH_CHUNK ? count - start : ADDRESS_FILL_BATCH_CHUNK;
+        for (uint16_t i = 0; i < chunkLen; i++) {
+            childPath[HDPATH_LEN_DEFAULT - 1] = path[HDPATH_LEN_DEFAULT - 1] + start + i;
+            CHECK_ZXERR(crypto_extractPublicKey(childPath, publicKeys[i], SECP256K1_PK_LEN))
+        }
+
+        addressFromPublicKeyBatch((const uint8_t (*)[SECP256K1_PK_LEN]) publicKeys, chunkLen,
+                                  (uint8_t (*)[ADDRESS_SECP256K1_BYTES_LEN]) (buffer + start * ADDRESS_SECP256K1_BYTES_LEN));
+    }
     return zxerr_ok;
 }
 
 #endif
 
-uint8_t decompressLEB128(const uint8_t *input, uint16_t inputSize, uint64_t *v) {
+// One byte per iteration, at most 10 bytes. The 10th byte can only carry the top bit of the value
+__Z_INLINE uint8_t decompressLEB128_bytewise(const uint8_t *input, uint16_t inputSize, uint64_t *v) {
     unsigned int i = 0;
 
     *v = 0;
@@ -274,10 +477,86 @@ uint8_t decompressLEB128(const uint8_t *input, uint16_t inputSize, uint64_t *v)
     return 0;
 }
 
-uint16_t formatProtocol(const uint8_t *addressBytes,
-                        uint16_t addressSize,
-                        uint8_t *formattedAddress,
-                        uint16_t formattedAddressSize) {
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LEB128_WORDWISE 1
+#else
+#define LEB128_WORDWISE 0
+#endif
+
+uint8_t decompressLEB128(const uint8_t *input, uint16_t inputSize, uint64_t *v) {
+#if LEB128_WORDWISE
+    // single byte values
+    if (inputSize > 0 && !(input[0] & 0x80u)) {
+        *v = input[0];
+        return 1;
+    }
+
+    // Values of up to 8 bytes (56 bits, which covers actor IDs) are decoded from a single word:
+    // the first clear continuation bit ends the value, then the 7-bit groups are packed together
+    uint64_t word = 0;
+    if (inputSize >= sizeof(word)) {
+        MEMCPY(&word, input, sizeof(word));
+    } else {
+        for (uint16_t i = 0; i < inputSize; i++) {
+            word |= (uint64_t) input[i] << (8u * i);
+        }
+    }
+
+    // bytes past inputSize are zero, so they look like terminators and must be ignored
+    const uint64_t available = inputSize >= sizeof(word) ? UINT64_MAX : (1ull << (inputSize * 8u)) - 1u;
+    const uint64_t terminators = ~word & 0x8080808080808080ull & available;
+    if (terminators != 0) {
+        const uint32_t lastBit = (uint32_t) __builtin_ctzll(terminators);
+        // keep the bytes up to and including the terminator
+        uint64_t x = word & 0x7f7f7f7f7f7f7f7full & (lastBit == 63 ? UINT64_MAX : (2ull << lastBit) - 1u);
+        x = ((x & 0x7f007f007f007f00ull) >> 1u) | (x & 0x007f007f007f007full);
+        x = ((x & 0x3fff00003fff0000ull) >> 2u) | (x & 0x00003fff00003fffull);
+        x = ((x & 0x0fffffff00000000ull) >> 4u) | (x & 0x000000000fffffffull);
+        *v = x;
+        return 1;
+    }
+#endif
+    return decompressLEB128_bytewise(input, inputSize, v);
+}
+
+uint8_t compressLEB128(uint64_t v, uint8_t *output, uint16_t outputSize) {
+    // 7 bits per byte, zero still takes one byte
+    uint8_t len = 1;
+    for (uint64_t rest = v >> 7u; rest != 0; rest >>= 7u) {
+        len++;
+    }
+    if (output == NULL || outputSize < len) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < len - 1; i++) {
+        output[i] = (uint8_t) (0x80u | (v & 0x7Fu));
+        v >>= 7u;
+    }
+    output[len - 1] = (uint8_t) v;
+    return len;
+}
+
+__Z_INLINE uint16_t addressPayloadSize(uint8_t protocol) {
+    switch (protocol) {
+        case ADDRESS_PROTOCOL_SECP256K1:
+            return ADDRESS_PROTOCOL_SECP256K1_PAYLOAD_LEN;
+        case ADDRESS_PROTOCOL_ACTOR:
+            return ADDRESS_PROTOCOL_ACTOR_PAYLOAD_LEN;
+        case ADDRESS_PROTOCOL_BLS:
+            return ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN;
+        default:
+            return 0;
+    }
+}
+
+// formatProtocol with the checksum of the address already known, NULL computes it
+static uint16_t formatProtocolChecksum(const uint8_t *addressBytes,
+                                       uint16_t addressSize,
+                                       const uint8_t *checksum,
+                                       uint8_t *formattedAddress,
+                                       uint16_t formattedAddressSize) {
     if (formattedAddress == NULL || formattedAddressSize < 2u) {
         return 0;
     }
@@ -299,9 +578,9 @@ uint16_t formatProtocol(const uint8_t *addressBytes,
                 return 0;
             }
 
-            if (uint64_to_str((char *) formattedAddress + 2,
-                              (uint32_t) (formattedAddressSize - 2),
-                              val) != NULL) {
+            if (uint64_to_decimal((char *) formattedAddress + 2,
+                                  (int) (formattedAddressSize - 2),
+                                  val) != NULL) {
                 return 0;
             }
 
@@ -336,19 +615,316 @@ uint16_t formatProtocol(const uint8_t *addressBytes,
     //We don't want the first byte which is the protocol byte
     MEMCPY(payload_crc, addressBytes + 1, addressSize - 1);
     // append 4 bytes checksum to payload_crc
-    blake_hash(addressBytes, addressSize, payload_crc + payloadSize, CHECKSUM_LENGTH);
+    if (checksum != NULL) {
+        MEMCPY(payload_crc + payloadSize, checksum, CHECKSUM_LENGTH);
+    } else {
+        blake_hash(addressBytes, addressSize, payload_crc + payloadSize, CHECKSUM_LENGTH);
+    }
 
-    // Now prepare the address output
+    // Now prepare the address output, a truncated encoding is not an address
+    const uint32_t encodedLen = base32_encoded_len((uint32_t) (payloadSize + CHECKSUM_LENGTH));
     if (base32_encode(payload_crc,
                       (uint32_t) (payloadSize + CHECKSUM_LENGTH),
                       (char *)(formattedAddress + 2),
-                      (uint32_t) (formattedAddressSize - 2)) < 0) {
+                      (uint32_t) (formattedAddressSize - 2)) != encodedLen) {
         return 0;
     }
 
     return strnlen((char *) formattedAddress, formattedAddressSize);
 }
 
+uint16_t formatProtocol(const uint8_t *addressBytes,
+                        uint16_t addressSize,
+                        uint8_t *formattedAddress,
+                        uint16_t formattedAddressSize) {
+    return formatProtocolChecksum(addressBytes, addressSize, NULL, formattedAddress, formattedAddressSize);
+}
+
+void addressChecksum(const uint8_t *addressBytes, uint16_t addressSize, uint8_t *checksum) {
+    blake_hash(addressBytes, addressSize, checksum, CHECKSUM_LENGTH);
+}
+
+bool formatProtocolPage(const uint8_t *addressBytes, uint16_t addressSize, const uint8_t *checksum,
+                        char *outVal, uint16_t outValLen,
+                        uint8_t pageIdx, uint8_t *pageCount) {
+    MEMZERO(outVal, outValLen);
+    *pageCount = 0;
+    if (addressBytes == NULL || addressSize < 2u) {
+        return false;
+    }
+
+    const uint8_t protocol = addressBytes[0];
+
+    // network and protocol, or the whole address for ID addresses
+    char prefix[2 + 21];
+    MEMZERO(prefix, sizeof(prefix));
+    prefix[0] = isTestnet() ? 't' : 'f';
+    prefix[1] = (char) (protocol + '0');
+
+    page_slice_t slice;
+    uint16_t payloadSize = 0;
+    switch (protocol) {
+        case ADDRESS_PROTOCOL_ID: {
+            uint64_t val = 0;
+            if (!decompressLEB128(addressBytes + 1, addressSize - 1, &val)) {
+                return false;
+            }
+            if (uint64_to_decimal(prefix + 2, sizeof(prefix) - 2, val) != NULL) {
+                return false;
+            }
+            const size_t textLen = strlen(prefix);
+            if (!page_sliceInit(&slice, outVal, outValLen, textLen, pageIdx, pageCount)) {
+                return false;
+            }
+            page_slicePutString(&slice, 0, prefix, textLen);
+            return true;
+        }
+        case ADDRESS_PROTOCOL_SECP256K1:
+            payloadSize = ADDRESS_PROTOCOL_SECP256K1_PAYLOAD_LEN;
+            break;
+        case ADDRESS_PROTOCOL_ACTOR:
+            payloadSize = ADDRESS_PROTOCOL_ACTOR_PAYLOAD_LEN;
+            break;
+        case ADDRESS_PROTOCOL_BLS:
+            payloadSize = ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN;
+            break;
+        default:
+            return false;
+    }
+
+    if (addressSize != payloadSize + 1) {
+        return false;
+    }
+
+    // the length of the base32 text only depends on the protocol
+    const uint32_t encodedLen = base32_encoded_len(payloadSize + CHECKSUM_LENGTH);
+    if (!page_sliceInit(&slice, outVal, outValLen, 2 + encodedLen, pageIdx, pageCount)) {
+        return false;
+    }
+    page_slicePutString(&slice, 0, prefix, 2);
+    if (slice.last <= 2) {
+        return true;
+    }
+
+    uint8_t payload_crc[ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN + CHECKSUM_LENGTH];
+    MEMZERO(payload_crc, sizeof(payload_crc));
+    MEMCPY(payload_crc, addressBytes + 1, payloadSize);
+
+    // characters before this one are payload only, the checksum is not needed for them
+    const uint32_t firstChecksumChar = (payloadSize * 8u) / 5u;
+    const uint32_t firstChar = slice.first > 2 ? (uint32_t) (slice.first - 2) : 0;
+    const uint32_t lastChar = (uint32_t) (slice.last - 2);
+    if (lastChar > firstChecksumChar) {
+        if (checksum != NULL) {
+            MEMCPY(payload_crc + payloadSize, checksum, CHECKSUM_LENGTH);
+        } else {
+            addressChecksum(addressBytes, addressSize, payload_crc + payloadSize);
+        }
+    }
+
+    base32_encode_range(payload_crc, payloadSize + CHECKSUM_LENGTH, firstChar,
+                        slice.out + (firstChar + 2 - slice.first), lastChar - firstChar);
+    return true;
+}
+
+// Everything address_parse checks but the checksum, which is left in checksum
+static uint16_t address_decode(const char *text, uint16_t textLen, bool *testnet,
+                               uint8_t *addressBytes, uint16_t addressSize,
+                               uint8_t *checksum) {
+    if (text == NULL || addressBytes == NULL || textLen < 3 || addressSize < 2) {
+        return 0;
+    }
+
+    switch (text[0]) {
+        case 'f':
+            *testnet = false;
+            break;
+        case 't':
+            *testnet = true;
+            break;
+        default:
+            return 0;
+    }
+
+    if (text[1] < '0' || text[1] > '3') {
+        return 0;
+    }
+    const uint8_t protocol = (uint8_t) (text[1] - '0');
+    addressBytes[0] = protocol;
+
+    if (protocol == ADDRESS_PROTOCOL_ID) {
+        // decimal without leading zeros, up to UINT64_MAX
+        const uint16_t digits = textLen - 2;
+        if (digits > 20 || (digits > 1 && text[2] == '0')) {
+            return 0;
+        }
+        uint64_t id = 0;
+        for (uint16_t i = 2; i < textLen; i++) {
+            if (text[i] < '0' || text[i] > '9') {
+                return 0;
+            }
+            const uint64_t digit = (uint64_t) (text[i] - '0');
+            if (id > (UINT64_MAX - digit) / 10) {
+                return 0;
+            }
+            id = id * 10 + digit;
+        }
+        const uint16_t idLen = compressLEB128(id, addressBytes + 1, addressSize - 1);
+        return idLen == 0 ? 0 : idLen + 1;
+    }
+
+    const uint16_t payloadSize = addressPayloadSize(protocol);
+    if (addressSize < payloadSize + 1 ||
+        textLen != 2 + base32_encoded_len(payloadSize + CHECKSUM_LENGTH)) {
+        return 0;
+    }
+
+    uint8_t payload_crc[ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN + CHECKSUM_LENGTH];
+    if (base32_decode(text + 2, textLen - 2, payload_crc, sizeof(payload_crc)) !=
+        (uint32_t) (payloadSize + CHECKSUM_LENGTH)) {
+        return 0;
+    }
+
+    MEMCPY(addressBytes + 1, payload_crc, payloadSize);
+    MEMCPY(checksum, payload_crc + payloadSize, CHECKSUM_LENGTH);
+    return payloadSize + 1;
+}
+
+uint16_t address_parse(const char *text, uint16_t textLen, bool *testnet,
+                       uint8_t *addressBytes, uint16_t addressSize) {
+    uint8_t checksum[CHECKSUM_LENGTH];
+    const uint16_t addressLen = address_decode(text, textLen, testnet, addressBytes, addressSize, checksum);
+    if (addressLen == 0 || addressBytes[0] == ADDRESS_PROTOCOL_ID) {
+        return addressLen;
+    }
+
+    uint8_t expected[CHECKSUM_LENGTH];
+    addressChecksum(addressBytes, addressLen, expected);
+    return memcmp(expected, checksum, CHECKSUM_LENGTH) == 0 ? addressLen : 0;
+}
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+void address_parseBatch(address_batch_item_t *items, size_t numItems) {
+    // Decode everything first, checksums are then computed together
+    const uint8_t *addresses[ADDRESS_BATCH_CHUNK];
+    uint16_t addressLens[ADDRESS_BATCH_CHUNK];
+    uint8_t checksums[ADDRESS_BATCH_CHUNK][CHECKSUM_LENGTH];
+    uint8_t expected[ADDRESS_BATCH_CHUNK][CHECKSUM_LENGTH];
+    address_batch_item_t *pending[ADDRESS_BATCH_CHUNK];
+
+    for (size_t start = 0; start < numItems; start += ADDRESS_BATCH_CHUNK) {
+        const size_t end = numItems - start < ADDRESS_BATCH_CHUNK ? numItems : start + ADDRESS_BATCH_CHUNK;
+        size_t numPending = 0;
+
+        for (size_t i = start; i < end; i++) {
+            address_batch_item_t *item = &items[i];
+            item->addressLen = (uint8_t) address_decode(item->text, item->textLen, &item->testnet,
+                                                        item->address, sizeof(item->address),
+                                                        checksums[numPending]);
+            if (item->addressLen > 0 && item->address[0] != ADDRESS_PROTOCOL_ID) {
+                addresses[numPending] = item->address;
+                addressLens[numPending] = item->addressLen;
+                pending[numPending++] = item;
+            }
+        }
+
+        addressChecksumBatch(addresses, addressLens, numPending, expected);
+        for (size_t i = 0; i < numPending; i++) {
+            if (memcmp(expected[i], checksums[i], CHECKSUM_LENGTH) != 0) {
+                pending[i]->addressLen = 0;
+            }
+        }
+    }
+}
+
+void formatProtocolBatch(const uint8_t *const *addresses, const uint16_t *addressLens, size_t numAddresses,
+                         uint8_t *formattedAddresses, uint16_t formattedAddressSize, uint16_t *formattedLens) {
+    // Checksums of the addresses that need one are computed together, then each address is formatted
+    const uint8_t *pending[ADDRESS_BATCH_CHUNK];
+    uint16_t pendingLens[ADDRESS_BATCH_CHUNK];
+    uint8_t checksums[ADDRESS_BATCH_CHUNK][CHECKSUM_LENGTH];
+    const uint8_t *checksumOf[ADDRESS_BATCH_CHUNK];
+
+    for (size_t start = 0; start < numAddresses; start += ADDRESS_BATCH_CHUNK) {
+        const size_t count = numAddresses - start < ADDRESS_BATCH_CHUNK ? numAddresses - start : ADDRESS_BATCH_CHUNK;
+        size_t numPending = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t *address = addresses[start + i];
+            const uint16_t addressLen = addressLens[start + i];
+            checksumOf[i] = NULL;
+            if (address != NULL && addressLen >= 2 &&
+                addressLen == addressPayloadSize(address[0]) + ADDRESS_PROTOCOL_LEN) {
+                checksumOf[i] = checksums[numPending];
+                pending[numPending] = address;
+                pendingLens[numPending++] = addressLen;
+            }
+        }
+
+        addressChecksumBatch(pending, pendingLens, numPending, checksums);
+        for (size_t i = 0; i < count; i++) {
+            formattedLens[start + i] = formatProtocolChecksum(addresses[start + i], addressLens[start + i],
+                                                              checksumOf[i],
+                                                              formattedAddresses + (start + i) * formattedAddressSize,
+                                                              formattedAddressSize);
+        }
+    }
+}
+#endif
+
+// multibase 'b': lower case base32 without padding
+__Z_INLINE zxerr_t cid_toText(const uint8_t *cid, char *cidText, uint16_t cidTextLen) {
+    cidText[0] = 'b';
+    if (base32_encode(cid, MESSAGE_CID_LEN, cidText + 1, cidTextLen - 1) != MESSAGE_CID_TEXT_LEN - 1) {
+        return zxerr_encoding_failed;
+    }
+    return zxerr_ok;
+}
+
+zxerr_t message_cid(const uint8_t *message, uint32_t messageLen,
+                    uint8_t *cid, uint16_t cidLen,
+                    char *cidText, uint16_t cidTextLen) {
+    if (message == NULL || cid == NULL || cidText == NULL) {
+        return zxerr_no_data;
+    }
+    if (cidLen < MESSAGE_CID_LEN || cidTextLen < MESSAGE_CID_TEXT_LEN + 1) {
+        return zxerr_buffer_too_small;
+    }
+
+    const uint8_t prefix[] = PREFIX;
+    MEMCPY(cid, prefix, CID_PREFIX_LEN);
+    blake_hash(message, messageLen, cid + CID_PREFIX_LEN, BLAKE2B_256_SIZE);
+
+    return cid_toText(cid, cidText, cidTextLen);
+}
+
+zxerr_t crypto_digestFinal(crypto_digest_t *digest, uint8_t *out, uint16_t outLen) {
+    return crypto_digestFinalCid(digest, out, outLen, NULL, 0);
+}
+
+zxerr_t crypto_digestFinalCid(crypto_digest_t *digest, uint8_t *out, uint16_t outLen,
+                              char *cidText, uint16_t cidTextLen) {
+    if (outLen < BLAKE2B_256_SIZE) {
+        return zxerr_buffer_too_small;
+    }
+    if (cidText != NULL && cidTextLen < MESSAGE_CID_TEXT_LEN + 1) {
+        return zxerr_buffer_too_small;
+    }
+
+    uint8_t cid[MESSAGE_CID_LEN];
+    const uint8_t prefix[] = PREFIX;
+    MEMCPY(cid, prefix, CID_PREFIX_LEN);
+    digest_finalHash(digest, cid + CID_PREFIX_LEN);
+
+    if (cidText != NULL) {
+        CHECK_ZXERR(cid_toText(cid, cidText, cidTextLen))
+    }
+
+    // same as blake_hash_cid over the message hash
+    blake_hash(cid, MESSAGE_CID_LEN, out, BLAKE2B_256_SIZE);
+    return zxerr_ok;
+}
+
 typedef struct {
     uint8_t publicKey[SECP256K1_PK_LEN];
 
@@ -23,9 +23,16 @@ extern "C" {
 #include <zxmacros.h>
 #include "coin.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <sigutils.h>
 #include <zxerror.h>
 
+#if defined(TARGET_NANOS) || defined(TARGET_NANOX)
+#include "cx.h"
+#else
+#include "blake2.h"
+#endif
+
 #define CHECKSUM_LENGTH             4
 
 extern uint32_t hdPath[HDPATH_LEN_DEFAULT];
@@ -34,7 +41,14 @@ extern uint32_t hdPath[HDPATH_LEN_DEFAULT];
 
 #define BLAKE2B_256_SIZE            32
 
+// CIDv1, dag-cbor, blake2b-256 multihash of 32 bytes
 #define PREFIX {0x01, 0x71, 0xa0, 0xe4, 0x02, 0x20}
+#define CID_PREFIX_LEN              6
+
+// binary CID of a message: PREFIX and the blake2b-256 of the message
+#define MESSAGE_CID_LEN             (CID_PREFIX_LEN + BLAKE2B_256_SIZE)
+// 'b' followed by the base32 of the binary CID
+#define MESSAGE_CID_TEXT_LEN        62
 
 #define ADDRESS_PROTOCOL_ID         0x00
 #define ADDRESS_PROTOCOL_SECP256K1  0x01
@@ -48,22 +62,119 @@ extern uint32_t hdPath[HDPATH_LEN_DEFAULT];
 
 uint8_t decompressLEB128(const uint8_t *input, uint16_t inputSize, uint64_t *v);
 
+/// Writes v as minimal (shortest) LEB128, as ID addresses carry it
+/// \return number of bytes written, 0 if output is too small
+uint8_t compressLEB128(uint64_t v, uint8_t *output, uint16_t outputSize);
+
 uint16_t formatProtocol(const uint8_t *addressBytes, uint16_t addressSize,
                         uint8_t *formattedAddress,
                         uint16_t formattedAddressSize);
 
+/// Checksum appended to the payload of non ID addresses (CHECKSUM_LENGTH bytes)
+void addressChecksum(const uint8_t *addressBytes, uint16_t addressSize, uint8_t *checksum);
+
+/// Writes one page of the text formatProtocol produces, without rendering the rest of the address.
+/// Pages match those of pageString over the full text.
+/// \param checksum addressChecksum of the address if it is already known, NULL to compute it when needed
+/// \return false if the address is not valid
+bool formatProtocolPage(const uint8_t *addressBytes, uint16_t addressSize, const uint8_t *checksum,
+                        char *outVal, uint16_t outValLen,
+                        uint8_t pageIdx, uint8_t *pageCount);
+
+/// Parses the text formatProtocol produces back into address bytes: network, protocol digit,
+/// ID in decimal (without leading zeros) or base32 payload with a valid checksum
+/// \param testnet receives true for 't' addresses, false for 'f' ones
+/// \param addressBytes receives the protocol byte and the payload (LEB128 for ID addresses)
+/// \return number of bytes written to addressBytes, 0 if the text is not a valid address
+uint16_t address_parse(const char *text, uint16_t textLen, bool *testnet,
+                       uint8_t *addressBytes, uint16_t addressSize);
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+// Host only: batch address parsing, formatting and derivation
+
+// Items are decoded and checksummed in chunks of this size
+#define ADDRESS_BATCH_CHUNK     64
+
+typedef struct {
+    const char *text;
+    uint16_t textLen;
+    // filled by address_parseBatch, addressLen is 0 if the text is not a valid address
+    bool testnet;
+    uint8_t addressLen;
+    uint8_t address[ADDRESS_PROTOCOL_LEN + ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN];
+} address_batch_item_t;
+
+/// Same as address_parse on each item. Checksums of a chunk of items are computed together
+void address_parseBatch(address_batch_item_t *items, size_t numItems);
+
+/// addressChecksum of several addresses, hashed several at a time (see blake2b_many)
+void addressChecksumBatch(const uint8_t *const *addresses, const uint16_t *addressLens, size_t numAddresses,
+                          uint8_t (*checksums)[CHECKSUM_LENGTH]);
+
+/// formatProtocol of several addresses, their checksums are computed together
+/// \param formattedAddresses numAddresses buffers of formattedAddressSize bytes, one after the other
+/// \param formattedLens receives what formatProtocol returns for each address (0 if it is not valid)
+void formatProtocolBatch(const uint8_t *const *addresses, const uint16_t *addressLens, size_t numAddresses,
+                         uint8_t *formattedAddresses, uint16_t formattedAddressSize, uint16_t *formattedLens);
+
+/// Address bytes (protocol 1 and the blake2b-160 of the key) of several uncompressed secp256k1 public keys,
+/// as crypto_fillAddress derives them
+void addressFromPublicKeyBatch(const uint8_t (*publicKeys)[SECP256K1_PK_LEN], size_t numKeys,
+                               uint8_t (*addresses)[ADDRESS_PROTOCOL_LEN + ADDRESS_PROTOCOL_SECP256K1_PAYLOAD_LEN]);
+#endif
+
 bool isTestnet();
 
+/// CID of a serialized message, as the network refers to it
+/// \param cid receives the binary CID, MESSAGE_CID_LEN bytes
+/// \param cidText receives the text form ("bafy2bza..."), MESSAGE_CID_TEXT_LEN characters and a terminating NUL
+zxerr_t message_cid(const uint8_t *message, uint32_t messageLen,
+                    uint8_t *cid, uint16_t cidLen,
+                    char *cidText, uint16_t cidTextLen);
+
 int prepareDigestToSign(const unsigned char *in, unsigned int inLen,
                         unsigned char *out, unsigned int outLen);
 
+// Running blake2b-256 of a message that arrives in chunks
+typedef struct {
+#if defined(TARGET_NANOS) || defined(TARGET_NANOX)
+    cx_blake2b_t state;
+#else
+    blake2b_state state;
+#endif
+} crypto_digest_t;
+
+void crypto_digestInit(crypto_digest_t *digest);
+
+void crypto_digestUpdate(crypto_digest_t *digest, const uint8_t *chunk, uint32_t chunkLen);
+
+/// Finishes the running hash. out receives what prepareDigestToSign returns for the whole message
+zxerr_t crypto_digestFinal(crypto_digest_t *digest, uint8_t *out, uint16_t outLen);
+
+/// Same as crypto_digestFinal, cidText also receives the text form of the message CID (see message_cid)
+zxerr_t crypto_digestFinalCid(crypto_digest_t *digest, uint8_t *out, uint16_t outLen,
+                              char *cidText, uint16_t cidTextLen);
+
 zxerr_t crypto_extractPublicKey(const uint32_t path[HDPATH_LEN_DEFAULT], uint8_t *pubKey, uint16_t pubKeyLen);
 
 zxerr_t crypto_fillAddress(uint8_t *buffer, uint16_t bufferLen, uint16_t *addrLen);
 
+// Protocol byte and payload of a secp256k1 address, as crypto_fillAddress returns them in addrBytes
+#define ADDRESS_SECP256K1_BYTES_LEN (ADDRESS_PROTOCOL_LEN + ADDRESS_PROTOCOL_SECP256K1_PAYLOAD_LEN)
+
+/// Address bytes of count sibling keys: path, then path with its last component incremented by 1 to count - 1.
+/// The parent node is derived once for all of them. The caller checks that the last component does not overflow
+/// \param buffer receives count entries of ADDRESS_SECP256K1_BYTES_LEN bytes, one after the other
+zxerr_t crypto_fillAddressBatch(const uint32_t path[HDPATH_LEN_DEFAULT], uint8_t count,
+                                uint8_t *buffer, uint16_t bufferLen);
+
 zxerr_t crypto_sign(uint8_t *signature, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen,
                     uint16_t *sigSize);
 
+/// Same as crypto_sign, for a message whose digest (see crypto_digestFinal) is already known
+zxerr_t crypto_signDigest(uint8_t *signature, uint16_t signatureMaxlen, const uint8_t *digest, uint16_t digestLen,
+                          uint16_t *sigSize);
+
 #ifdef __cplusplus
 }
 #endif
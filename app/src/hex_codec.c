@@ -0,0 +1,301 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "hex_codec.h"
+#include <stdbool.h>
+#include <string.h>
+#include <zxmacros.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HEX_SIMD 1
+#include <immintrin.h>
+#include <pthread.h>
+#else
+#define HEX_SIMD 0
+#endif
+
+static const char hex_digits[] = "0123456789abcdef";
+
+// Value of a hex digit, 0xFF for anything else
+__Z_INLINE uint8_t hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return (uint8_t) (c - '0');
+    }
+    c = (char) (c | 0x20);
+    if (c >= 'a' && c <= 'f') {
+        return (uint8_t) (c - 'a' + 10);
+    }
+    return 0xFF;
+}
+
+static void hex_encode_scalar(const uint8_t *src, uint32_t count, char *dst) {
+    for (uint32_t i = 0; i < count; i++) {
+        dst[2 * i] = hex_digits[src[i] >> 4u];
+        dst[2 * i + 1] = hex_digits[src[i] & 0x0Fu];
+    }
+}
+
+// Decodes numBytes pairs, stops at the first invalid one
+// \return number of bytes written
+static size_t hex_decode_scalar(const char *input, size_t numBytes, uint8_t *out) {
+    for (size_t i = 0; i < numBytes; i++) {
+        const uint8_t hi = hex_value(input[2 * i]);
+        const uint8_t lo = hex_value(input[2 * i + 1]);
+        if ((hi | lo) == 0xFF) {
+            return i;
+        }
+        out[i] = (uint8_t) ((hi << 4u) | lo);
+    }
+    return numBytes;
+}
+
+#if HEX_SIMD
+// Nibbles of each byte are split, looked up in the digit table with pshufb and interleaved back
+__attribute__((target("ssse3")))
+static uint32_t hex_encode_ssse3(const uint8_t *src, uint32_t count, char *dst) {
+    const __m128i digits = _mm_loadu_si128((const __m128i *) hex_digits);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+
+    uint32_t done = 0;
+    for (; done + 16 <= count; done += 16) {
+        const __m128i bytes = _mm_loadu_si128((const __m128i *) (src + done));
+        const __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+        const __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, mask));
+        _mm_storeu_si128((__m128i *) (dst + 2 * done), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *) (dst + 2 * done + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static uint32_t hex_encode_avx2(const uint8_t *src, uint32_t count, char *dst) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) hex_digits));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    uint32_t done = 0;
+    for (; done + 32 <= count; done += 32) {
+        const __m256i bytes = _mm256_loadu_si256((const __m256i *) (src + done));
+        const __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+        const __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(bytes, mask));
+        // interleaving works per 128-bit lane, the halves are put back in order
+        const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *) (dst + 2 * done), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i *) (dst + 2 * done + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return done;
+}
+
+// Nibble values of 16 characters, valid is set to all ones for hex digits
+__attribute__((target("ssse3")))
+static __m128i hex_values_ssse3(__m128i chars, __m128i *valid) {
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    // unsigned x <= n
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    *valid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+// Decodes 16 bytes per step while every character is valid
+// \return number of bytes written, the caller goes on with scalar code from there
+__attribute__((target("ssse3")))
+static size_t hex_decode_ssse3(const char *input, size_t numBytes, uint8_t *out) {
+    // high nibble x 16 + low nibble, for each pair of characters
+    const __m128i weights = _mm_set1_epi16(0x0110);
+
+    size_t done = 0;
+    for (; done + 16 <= numBytes; done += 16) {
+        __m128i valid0, valid1;
+        const __m128i v0 = hex_values_ssse3(_mm_loadu_si128((const __m128i *) (input + 2 * done)), &valid0);
+        const __m128i v1 = hex_values_ssse3(_mm_loadu_si128((const __m128i *) (input + 2 * done + 16)), &valid1);
+        if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xFFFF) {
+            break;
+        }
+        const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(v0, weights), _mm_maddubs_epi16(v1, weights));
+        _mm_storeu_si128((__m128i *) (out + done), bytes);
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static __m256i hex_values_avx2(__m256i chars, __m256i *valid) {
+    const __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    *valid = _mm256_or_si256(isDigit, isLetter);
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+                           _mm256_and_si256(isLetter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static size_t hex_decode_avx2(const char *input, size_t numBytes, uint8_t *out) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+
+    size_t done = 0;
+    for (; done + 32 <= numBytes; done += 32) {
+        __m256i valid0, valid1;
+        const __m256i v0 = hex_values_avx2(_mm256_loadu_si256((const __m256i *) (input + 2 * done)), &valid0);
+        const __m256i v1 = hex_values_avx2(_mm256_loadu_si256((const __m256i *) (input + 2 * done + 32)), &valid1);
+        if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1) {
+            break;
+        }
+        // packing works per 128-bit lane, the quarters are put back in order
+        const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(v0, weights),
+                                                   _mm256_maddubs_epi16(v1, weights));
+        _mm256_storeu_si256((__m256i *) (out + done), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    return done;
+}
+#endif
+
+// Vector kernels of a backend, each returns how many bytes it handled. NULL leaves everything
+// to the scalar code.
+typedef struct {
+    uint32_t (*encode)(const uint8_t *src, uint32_t count, char *dst);
+    size_t (*decode)(const char *input, size_t numBytes, uint8_t *out);
+} hex_kernels_t;
+
+#if HEX_SIMD
+// CPU features do not change while the process runs, they are queried once. Batch validation
+// workers render params concurrently, so the first use is synchronized
+static pthread_once_t hex_features_once = PTHREAD_ONCE_INIT;
+static bool hex_has_avx2 = false;
+static bool hex_has_ssse3 = false;
+
+static void hex_detect_features() {
+    __builtin_cpu_init();
+    hex_has_avx2 = __builtin_cpu_supports("avx2");
+    hex_has_ssse3 = __builtin_cpu_supports("ssse3");
+}
+#endif
+
+static hex_kernels_t hex_resolve_backend(hex_backend_e backend) {
+    hex_kernels_t kernels = {NULL, NULL};
+#if HEX_SIMD
+    pthread_once(&hex_features_once, hex_detect_features);
+    const bool avx2 = hex_has_avx2;
+    const bool ssse3 = hex_has_ssse3;
+
+    if (backend == hex_backend_auto) {
+        backend = avx2 ? hex_backend_avx2 : hex_backend_ssse3;
+    }
+    if (backend == hex_backend_avx2 && avx2) {
+        kernels.encode = hex_encode_avx2;
+        kernels.decode = hex_decode_avx2;
+    } else if (backend == hex_backend_ssse3 && ssse3) {
+        kernels.encode = hex_encode_ssse3;
+        kernels.decode = hex_decode_ssse3;
+    }
+#else
+    UNUSED(backend);
+#endif
+    return kernels;
+}
+
+#if HEX_SIMD
+// Kernels for hex_backend_auto, resolved once, on first use
+static pthread_once_t hex_auto_once = PTHREAD_ONCE_INIT;
+static hex_kernels_t hex_auto_kernels = {NULL, NULL};
+
+static void hex_resolve_auto() {
+    hex_auto_kernels = hex_resolve_backend(hex_backend_auto);
+}
+#endif
+
+static hex_kernels_t hex_backend_kernels(hex_backend_e backend) {
+    if (backend != hex_backend_auto) {
+        return hex_resolve_backend(backend);
+    }
+#if HEX_SIMD
+    pthread_once(&hex_auto_once, hex_resolve_auto);
+    return hex_auto_kernels;
+#else
+    // there are no vector kernels to choose from
+    return hex_resolve_backend(backend);
+#endif
+}
+
+static void hex_encode_impl(hex_backend_e backend, const uint8_t *src, uint32_t count, char *dst) {
+    const hex_kernels_t kernels = hex_backend_kernels(backend);
+    const uint32_t done = kernels.encode != NULL ? kernels.encode(src, count, dst) : 0;
+    hex_encode_scalar(src + done, count - done, dst + 2 * done);
+}
+
+static size_t hex_decode_impl(hex_backend_e backend, uint8_t *out, uint16_t outLen, const char *input) {
+    const size_t len = strnlen(input, outLen * 2u + 1u);
+    if ((len / 2) > outLen || len % 2 == 1) {
+        return 0;
+    }
+
+    const size_t numBytes = len / 2;
+    const hex_kernels_t kernels = hex_backend_kernels(backend);
+    const size_t done = kernels.decode != NULL ? kernels.decode(input, numBytes, out) : 0;
+    // the rest, and the block with the first invalid character if there is one
+    if (hex_decode_scalar(input + 2 * done, numBytes - done, out + done) != numBytes - done) {
+        return 0;
+    }
+    return numBytes;
+}
+
+uint32_t hex_encode(char *dst, uint32_t dstLen, const uint8_t *src, uint32_t count) {
+    MEMZERO(dst, dstLen);
+    if (dstLen < 2 * count + 1) {
+        return 0;
+    }
+    hex_encode_impl(hex_backend_auto, src, count, dst);
+    return 2 * count;
+}
+
+void hex_encode_range(const uint8_t *data, uint32_t firstChar, char *out, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    // odd first character: the low nibble of its byte
+    if (firstChar % 2 == 1) {
+        *out++ = hex_digits[data[firstChar / 2] & 0x0Fu];
+        firstChar++;
+        count--;
+    }
+    const uint32_t wholeBytes = count / 2;
+    hex_encode_impl(hex_backend_auto, data + firstChar / 2, wholeBytes, out);
+    // odd last character: the high nibble of its byte
+    if (count % 2 == 1) {
+        out[2 * wholeBytes] = hex_digits[data[firstChar / 2 + wholeBytes] >> 4u];
+    }
+}
+
+size_t hex_decode(uint8_t *out, uint16_t outLen, const char *input) {
+    return hex_decode_impl(hex_backend_auto, out, outLen, input);
+}
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+uint32_t hex_encode_backend(hex_backend_e backend, char *dst, uint32_t dstLen, const uint8_t *src, uint32_t count) {
+    MEMZERO(dst, dstLen);
+    if (dstLen < 2 * count + 1) {
+        return 0;
+    }
+    hex_encode_impl(backend, src, count, dst);
+    return 2 * count;
+}
+
+size_t hex_decode_backend(hex_backend_e backend, uint8_t *out, uint16_t outLen, const char *input) {
+    return hex_decode_impl(backend, out, outLen, input);
+}
+#endif
@@ -0,0 +1,60 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Lower case hex, the vectorized counterpart of zxlib's array_to_hexstr and parseHexString.
+// x86 hosts use SSSE3 or AVX2 when the CPU has them, other targets the scalar code.
+
+typedef enum {
+    hex_backend_auto,
+    hex_backend_scalar,
+    hex_backend_ssse3,
+    hex_backend_avx2,
+} hex_backend_e;
+
+/// Same as array_to_hexstr, without its 255 byte limit: dst is cleared, then filled with
+/// 2 * count characters and a NUL if it has room for them
+/// \return number of characters written, 0 if dst is too small
+uint32_t hex_encode(char *dst, uint32_t dstLen, const uint8_t *src, uint32_t count);
+
+/// Writes count characters of the hex of data, starting at character firstChar, without NUL termination
+/// \param data bytes from which the characters are taken, at least (firstChar + count + 1) / 2 of them
+void hex_encode_range(const uint8_t *data, uint32_t firstChar, char *out, uint32_t count);
+
+/// Same as parseHexString: input is NUL terminated, upper and lower case digits are accepted.
+/// On invalid input 0 is returned and the bytes before the first invalid pair are left in out, as
+/// parseHexString does.
+/// \return number of bytes written to out, 0 if input is not valid hex or does not fit in outLen bytes
+size_t hex_decode(uint8_t *out, uint16_t outLen, const char *input);
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+// Host only: hex_encode / hex_decode with a given backend, backends the CPU does not support fall
+// back to scalar code.
+uint32_t hex_encode_backend(hex_backend_e backend, char *dst, uint32_t dstLen, const uint8_t *src, uint32_t count);
+
+size_t hex_decode_backend(hex_backend_e backend, uint8_t *out, uint16_t outLen, const char *input);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
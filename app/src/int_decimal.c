@@ -0,0 +1,130 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "int_decimal.h"
+#include <string.h>
+#include <zxmacros.h>
+#include <zxformat.h>
+
+// "00" to "99": each step of the conversion writes the last two digits of the value at once
+static const char decimal_pairs[200] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+static const uint64_t decimal_powers[INT_DECIMAL_MAX_LEN] = {
+        1ULL,
+        10ULL,
+        100ULL,
+        1000ULL,
+        10000ULL,
+        100000ULL,
+        1000000ULL,
+        10000000ULL,
+        100000000ULL,
+        1000000000ULL,
+        10000000000ULL,
+        100000000000ULL,
+        1000000000000ULL,
+        10000000000000ULL,
+        100000000000000ULL,
+        1000000000000000ULL,
+        10000000000000000ULL,
+        100000000000000000ULL,
+        1000000000000000000ULL,
+        10000000000000000000ULL,
+};
+
+uint8_t decimal_digitCount(uint64_t v) {
+    if (v == 0) {
+        return 1;
+    }
+    // log10(2) ~ 1233 / 4096: a first guess from the bit length, off by at most one
+    const uint32_t bits = 64u - (uint32_t) __builtin_clzll(v);
+    const uint32_t guess = (bits * 1233u) >> 12u;
+    return (uint8_t) (guess + (v >= decimal_powers[guess] ? 1u : 0u));
+}
+
+// Writes the digits of v in out[0, digits), digits must be decimal_digitCount(v)
+static void decimal_write(char *out, uint8_t digits, uint64_t v) {
+    char *p = out + digits;
+    // below 2^32 the divisions are cheaper, which matters on 32-bit targets
+    while (v > UINT32_MAX) {
+        const uint32_t pair = (uint32_t) (v % 100u);
+        v /= 100u;
+        p -= 2;
+        p[0] = decimal_pairs[2 * pair];
+        p[1] = decimal_pairs[2 * pair + 1];
+    }
+    uint32_t w = (uint32_t) v;
+    while (w >= 100u) {
+        const uint32_t pair = w % 100u;
+        w /= 100u;
+        p -= 2;
+        p[0] = decimal_pairs[2 * pair];
+        p[1] = decimal_pairs[2 * pair + 1];
+    }
+    if (w >= 10u) {
+        p -= 2;
+        p[0] = decimal_pairs[2 * w];
+        p[1] = decimal_pairs[2 * w + 1];
+    } else {
+        *--p = (char) ('0' + w);
+    }
+}
+
+const char *uint64_to_decimal(char *data, int dataLen, uint64_t number) {
+    const uint8_t digits = decimal_digitCount(number);
+    if (dataLen < 2 || digits >= dataLen) {
+        // too small: zxlib decides what is left in data
+        return uint64_to_str(data, dataLen, number);
+    }
+
+    MEMZERO(data, dataLen);
+    decimal_write(data, digits, number);
+    return NULL;
+}
+
+const char *int64_to_decimal(char *data, int dataLen, int64_t number) {
+    const uint64_t magnitude = number < 0 ? 0u - (uint64_t) number : (uint64_t) number;
+    const uint8_t digits = decimal_digitCount(magnitude);
+    const uint8_t sign = number < 0 ? 1 : 0;
+    if (dataLen < 2 || sign + digits >= dataLen) {
+        return int64_to_str(data, dataLen, number);
+    }
+
+    MEMZERO(data, dataLen);
+    if (sign) {
+        data[0] = '-';
+    }
+    decimal_write(data + sign, digits, magnitude);
+    return NULL;
+}
+
+uint16_t fpuint64_to_decimal(char *out, uint16_t outLen, uint64_t value, uint8_t decimals) {
+    char buffer[30];
+    MEMZERO(buffer, sizeof(buffer));
+    uint64_to_decimal(buffer, sizeof(buffer), value);
+    fpstr_to_str(out, outLen, buffer, decimals);
+    return (uint16_t) strlen(out);
+}
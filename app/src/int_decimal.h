@@ -0,0 +1,44 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Longest text of a 64-bit integer: "-9223372036854775808" or "18446744073709551615"
+#define INT_DECIMAL_MAX_LEN     20
+
+/// Number of decimal digits of v (1 for zero)
+uint8_t decimal_digitCount(uint64_t v);
+
+/// Same text, return value and buffer contents as zxlib's uint64_to_str, two digits per step.
+/// The digit count is known upfront so the text is written in place, from its last digit.
+/// \return NULL on success, an error message if data is too small
+const char *uint64_to_decimal(char *data, int dataLen, uint64_t number);
+
+/// Same as zxlib's int64_to_str, see uint64_to_decimal
+const char *int64_to_decimal(char *data, int dataLen, int64_t number);
+
+/// Same as zxlib's fpuint64_to_str, with the digits produced by uint64_to_decimal
+/// \return length of the text in out
+uint16_t fpuint64_to_decimal(char *out, uint16_t outLen, uint64_t value, uint8_t decimals);
+
+#ifdef __cplusplus
+}
+#endif
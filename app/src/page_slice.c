@@ -0,0 +1,53 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "page_slice.h"
+
+bool page_sliceInit(page_slice_t *slice, char *outVal, uint16_t outValLen,
+                    size_t textLen, uint8_t pageIdx, uint8_t *pageCount) {
+    MEMZERO(outVal, outValLen);
+    *pageCount = 0;
+    slice->out = outVal;
+    slice->first = 0;
+    slice->last = 0;
+
+    // leave space for NULL termination
+    if (outValLen < 2 || textLen == 0) {
+        return true;
+    }
+
+    const size_t pageLen = outValLen - 1u;
+    const size_t numPages = (textLen + pageLen - 1) / pageLen;
+    if (numPages > UINT8_MAX) {
+        return false;
+    }
+    *pageCount = (uint8_t) numPages;
+    if (pageIdx >= *pageCount) {
+        return true;
+    }
+
+    slice->first = pageIdx * pageLen;
+    slice->last = slice->first + pageLen < textLen ? slice->first + pageLen : textLen;
+    return true;
+}
+
+void page_slicePutString(const page_slice_t *slice, size_t pos, const char *s, size_t len) {
+    const size_t begin = pos > slice->first ? pos : slice->first;
+    const size_t end = pos + len < slice->last ? pos + len : slice->last;
+    if (begin < end) {
+        MEMCPY(slice->out + (begin - slice->first), s + (begin - pos), end - begin);
+    }
+}
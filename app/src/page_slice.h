@@ -0,0 +1,61 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zxmacros.h>
+
+// Pages as pageString/pageStringExt split them, for values that are never rendered as a whole.
+// The producer knows the length of its text beforehand and only writes the characters of one page.
+
+typedef struct {
+    char *out;
+    // text position of out[0]
+    size_t first;
+    // one past the last text position shown in this page, first == last when there is nothing to write
+    size_t last;
+} page_slice_t;
+
+/// Clears outVal and finds the slice of the text shown in page pageIdx
+/// \param slice receives the slice, its characters are written with page_slicePut
+/// \param outVal page buffer, each page holds outValLen - 1 characters
+/// \param outValLen size of outVal
+/// \param textLen number of characters of the full text
+/// \param pageIdx page to show
+/// \param pageCount receives the number of pages, 0 if outValLen cannot hold a page or the text is empty
+/// \return false if the text needs more than 255 pages
+bool page_sliceInit(page_slice_t *slice, char *outVal, uint16_t outValLen,
+                    size_t textLen, uint8_t pageIdx, uint8_t *pageCount);
+
+/// Writes the character at text position pos if it is shown in the slice
+__Z_INLINE void page_slicePut(const page_slice_t *slice, size_t pos, char c) {
+    if (pos >= slice->first && pos < slice->last) {
+        slice->out[pos - slice->first] = c;
+    }
+}
+
+/// Writes the part of s (placed at text position pos) that is shown in the slice
+void page_slicePutString(const page_slice_t *slice, size_t pos, const char *s, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
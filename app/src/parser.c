@@ -17,8 +17,10 @@
 #include <stdio.h>
 #include <zxmacros.h>
 #include "parser_impl.h"
-#include "bignum.h"
+#include "bignum_decimal.h"
+#include "int_decimal.h"
 #include "parser.h"
+#include "parser_cache.h"
 #include "parser_txdef.h"
 #include "coin.h"
 #include "zxformat.h"
@@ -31,18 +33,55 @@ void __assert_fail(const char * assertion, const char * file, unsigned int line,
 #endif
 
 parser_error_t parser_parse(parser_context_t *ctx, const uint8_t *data, size_t dataLen) {
-    CHECK_PARSER_ERR(parser_init(ctx, data, dataLen))
-    return _read(ctx, &parser_tx_obj);
+    return parser_parse_r(ctx, data, dataLen, &parser_tx_obj);
 }
 
 parser_error_t parser_validate(const parser_context_t *ctx) {
+    return parser_validate_r(ctx);
+}
+
+parser_error_t parser_getNumItems(const parser_context_t *ctx, uint8_t *num_items) {
+    return parser_getNumItems_r(ctx, num_items);
+}
+
+parser_error_t parser_getItem(const parser_context_t *ctx,
+                              uint8_t displayIdx,
+                              char *outKey, uint16_t outKeyLen,
+                              char *outVal, uint16_t outValLen,
+                              uint8_t pageIdx, uint8_t *pageCount) {
+    return parser_getItem_r(ctx, displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+}
+
+parser_error_t parser_parse_r(parser_context_t *ctx, const uint8_t *data, size_t dataLen, parser_tx_t *tx_obj) {
+    if (tx_obj == NULL) {
+        return parser_init_context_empty;
+    }
+
+    CHECK_PARSER_ERR(parser_init(ctx, data, dataLen))
+    ctx->tx_obj = tx_obj;
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+    // Messages the specialized decoder does not accept go through tinycbor, which reports the error
+    if (_readSchema(ctx, ctx->tx_obj)) {
+        return parser_ok;
+    }
+#endif
+
+    return _read(ctx, ctx->tx_obj);
+}
+
+parser_error_t parser_validate_r(const parser_context_t *ctx) {
     zemu_log("parser_validate");
-    CHECK_PARSER_ERR(_validateTx(ctx, &parser_tx_obj))
+    if (ctx->tx_obj == NULL) {
+        return parser_init_context_empty;
+    }
+
+    CHECK_PARSER_ERR(_validateTx(ctx, ctx->tx_obj))
     zemu_log("parser_validate::validated\n");
 
     // Iterate through all items to check that all can be shown and are valid
     uint8_t numItems = 0;
-    CHECK_PARSER_ERR(parser_getNumItems(ctx, &numItems));
+    CHECK_PARSER_ERR(parser_getNumItems_r(ctx, &numItems));
 
     char log_tmp[100];
     snprintf(log_tmp, sizeof(log_tmp), "parser_validate %d\n", numItems);
@@ -53,89 +92,141 @@ parser_error_t parser_validate(const parser_context_t *ctx) {
 
     for (uint8_t idx = 0; idx < numItems; idx++) {
         uint8_t pageCount = 0;
-        CHECK_PARSER_ERR(parser_getItem(ctx, idx, tmpKey, sizeof(tmpKey), tmpVal, sizeof(tmpVal), 0, &pageCount))
+        // Values rendered here are kept in the render cache, if one is attached
+        parser_cacheBegin(ctx);
+        const parser_error_t err = parser_getItem_r(ctx, idx, tmpKey, sizeof(tmpKey), tmpVal, sizeof(tmpVal), 0, &pageCount);
+        parser_cacheEnd(ctx, idx, err == parser_ok ? tmpKey : NULL);
+        CHECK_PARSER_ERR(err)
     }
 
     zemu_log("parser_validate::ok\n");
     return parser_ok;
 }
 
-parser_error_t parser_getNumItems(const parser_context_t *ctx, uint8_t *num_items) {
+parser_error_t parser_getNumItems_r(const parser_context_t *ctx, uint8_t *num_items) {
     zemu_log("parser_getNumItems\n");
-    *num_items = _getNumItems(ctx, &parser_tx_obj);
+    if (ctx->tx_obj == NULL) {
+        return parser_init_context_empty;
+    }
+
+    *num_items = _getNumItems(ctx, ctx->tx_obj);
     return parser_ok;
 }
 
 #define LESS_THAN_64_DIGIT(num_digit) if (num_digit > 64) return parser_value_out_of_range;
 
-__Z_INLINE bool format_quantity(const bigint_t *b,
-                                uint8_t *bcd, uint16_t bcdSize,
-                                char *bignum, uint16_t bignumSize) {
-
-    if (b->len < 2) {
-        snprintf(bignum, bignumSize, "0");
-        return true;
-    }
-
-    // first byte of b is the sign byte so we can remove this one
-    bignumBigEndian_to_bcd(bcd, bcdSize, b->buffer + 1, b->len - 1);
-    return bignumBigEndian_bcdprint(bignum, bignumSize, bcd, bcdSize);
+// first byte of a bigint is the sign byte, zero has no magnitude bytes at all
+__Z_INLINE bool format_fixedPointPage(const parser_context_t *ctx, const bigint_t *b,
+                                      char *outVal, uint16_t outValLen,
+                                      uint8_t pageIdx, uint8_t *pageCount) {
+    const uint8_t *magnitude = ctx->buffer + b->offset + 1;
+    const uint16_t magnitudeLen = b->len < 2 ? 0 : b->len - 1;
+    return bignumBigEndian_to_fpstr_page(outVal, outValLen, magnitude, magnitudeLen,
+                                         COIN_AMOUNT_DECIMAL_PLACES, pageIdx, pageCount);
 }
 
-parser_error_t parser_printParam(const parser_tx_t *tx, uint8_t paramIdx,
+parser_error_t parser_printParam(const parser_context_t *ctx, uint8_t paramIdx,
                                  char *outVal, uint16_t outValLen,
                                  uint8_t pageIdx, uint8_t *pageCount) {
-    return _printParam(tx, paramIdx, outVal, outValLen, pageIdx, pageCount);
+    return _printParam(ctx, paramIdx, outVal, outValLen, pageIdx, pageCount);
 }
 
-__Z_INLINE parser_error_t parser_printBigIntFixedPoint(const bigint_t *b,
+__Z_INLINE parser_error_t parser_printBigIntFixedPoint(const parser_context_t *ctx, const bigint_t *b,
                                                        char *outVal, uint16_t outValLen,
                                                        uint8_t pageIdx, uint8_t *pageCount) {
 
     LESS_THAN_64_DIGIT(b->len)
 
-    char bignum[160];
-    union {
-        // overlapping arrays to avoid excessive stack usage. Do not use at the same time
-        uint8_t bcd[80];
-        char output[160];
-    } overlapped;
-
-    MEMZERO(overlapped.bcd, sizeof(overlapped.bcd));
-    MEMZERO(bignum, sizeof(bignum));
+    // While validating, the whole text is kept in the render cache if it fits in one page of the free space
+    uint16_t stageSize = 0;
+    char *stage = parser_cacheStageBuffer(ctx, &stageSize);
+    if (stage != NULL) {
+        uint8_t stagePages = 0;
+        if (format_fixedPointPage(ctx, b, stage, stageSize, 0, &stagePages) && stagePages == 1) {
+            parser_cacheStaged(ctx);
+        }
+    }
 
-    if (!format_quantity(b, overlapped.bcd, sizeof(overlapped.bcd), bignum, sizeof(bignum))) {
+    // Only the requested page is produced, straight from the binary value
+    if (!format_fixedPointPage(ctx, b, outVal, outValLen, pageIdx, pageCount)) {
         return parser_unexpected_value;
     }
-
-    fpstr_to_str(overlapped.output, sizeof(overlapped.output), bignum, COIN_AMOUNT_DECIMAL_PLACES);
-    pageString(outVal, outValLen, overlapped.output, pageIdx, pageCount);
     return parser_ok;
 }
 
-__Z_INLINE parser_error_t parser_printAddress(const address_t *a,
+__Z_INLINE parser_error_t parser_printAddress(const parser_context_t *ctx, const address_t *a,
                                               char *outVal, uint16_t outValLen,
                                               uint8_t pageIdx, uint8_t *pageCount) {
 
+    const uint8_t *address = ctx->buffer + a->offset;
+
+    // the checksum is computed once per address when a memo is attached, ID addresses have none
+    uint8_t checksumBuffer[PARSER_ADDRESS_CHECKSUM_LEN];
+    const uint8_t *checksum = NULL;
+    if (address[0] != ADDRESS_PROTOCOL_ID) {
+        checksum = parser_addressChecksum(ctx, address, a->len, checksumBuffer);
+    }
+
+    // While validating, the whole address is kept in the render cache if it fits in one page of the free space
+    uint16_t stageSize = 0;
+    char *stage = parser_cacheStageBuffer(ctx, &stageSize);
+    if (stage != NULL) {
+        uint8_t stagePages = 0;
+        if (formatProtocolPage(address, a->len, checksum, stage, stageSize, 0, &stagePages) && stagePages == 1) {
+            parser_cacheStaged(ctx);
+        }
+    }
+
     // the format :
     // network (1 byte) + protocol (1 byte) + base 32 [ payload (20 bytes or 48 bytes) + checksum (optional - 4bytes)]
-    // Max we need 84 bytes to support BLS + 16 bytes padding
-    char outBuffer[84 + 16];
-    MEMZERO(outBuffer, sizeof(outBuffer));
-
-    if (formatProtocol(a->buffer, a->len, (uint8_t *) outBuffer, sizeof(outBuffer)) == 0) {
+    // only the characters of the requested page are produced
+    if (!formatProtocolPage(address, a->len, checksum, outVal, outValLen, pageIdx, pageCount)) {
         return parser_invalid_address;
     }
+    return parser_ok;
+}
 
-    pageString(outVal, outValLen, outBuffer, pageIdx, pageCount);
+// The checks below fail exactly when the matching print function would
+
+__Z_INLINE parser_error_t parser_checkBigInt(const bigint_t *b) {
+    LESS_THAN_64_DIGIT(b->len)
     return parser_ok;
 }
 
-parser_error_t parser_getItem(const parser_context_t *ctx,
-                              uint8_t displayIdx,
-                              char *outKey, uint16_t outKeyLen,
-                              char *outVal, uint16_t outValLen,
-                              uint8_t pageIdx, uint8_t *pageCount) {
+__Z_INLINE parser_error_t parser_checkAddress(const parser_context_t *ctx, const address_t *a) {
+    // protocol and length were verified while parsing, only ID payloads may still be malformed
+    if (ctx->buffer[a->offset] == ADDRESS_PROTOCOL_ID) {
+        uint64_t id = 0;
+        if (!decompressLEB128(ctx->buffer + a->offset + 1, a->len - 1, &id)) {
+            return parser_invalid_address;
+        }
+    }
+    return parser_ok;
+}
+
+parser_error_t parser_validate_structural(const parser_context_t *ctx) {
+    if (ctx->tx_obj == NULL) {
+        return parser_init_context_empty;
+    }
+
+    const parser_tx_t *tx = ctx->tx_obj;
+    CHECK_PARSER_ERR(_validateTx(ctx, tx))
+
+    // Same order as the items, so that the first failure is the one parser_validate_r reports
+    CHECK_PARSER_ERR(parser_checkAddress(ctx, &tx->to))
+    CHECK_PARSER_ERR(parser_checkAddress(ctx, &tx->from))
+    CHECK_PARSER_ERR(parser_checkBigInt(&tx->value))
+    CHECK_PARSER_ERR(parser_checkBigInt(&tx->gaspremium))
+    CHECK_PARSER_ERR(parser_checkBigInt(&tx->gasfeecap))
+    CHECK_PARSER_ERR(checkMethod(tx->method))
+    return _checkParams(ctx);
+}
+
+parser_error_t parser_getItem_r(const parser_context_t *ctx,
+                                uint8_t displayIdx,
+                                char *outKey, uint16_t outKeyLen,
+                                char *outVal, uint16_t outValLen,
+                                uint8_t pageIdx, uint8_t *pageCount) {
     char log_tmp[100];
     snprintf(log_tmp, sizeof(log_tmp), "getItem %d\n", displayIdx);
     zemu_log(log_tmp);
@@ -147,28 +238,34 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
     *pageCount = 0;
 
     uint8_t numItems = 0;
-    CHECK_PARSER_ERR(parser_getNumItems(ctx, &numItems))
+    CHECK_PARSER_ERR(parser_getNumItems_r(ctx, &numItems))
     CHECK_APP_CANARY()
 
     if (displayIdx < 0 || displayIdx >= numItems) {
         return parser_no_data;
     }
 
+    if (parser_cacheGetItem(ctx, displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount)) {
+        return parser_ok;
+    }
+
+    const parser_tx_t *tx = ctx->tx_obj;
+
     if (displayIdx == 0) {
         snprintf(outKey, outKeyLen, "To ");
-        return parser_printAddress(&parser_tx_obj.to,
+        return parser_printAddress(ctx, &tx->to,
                                    outVal, outValLen, pageIdx, pageCount);
     }
 
     if (displayIdx == 1) {
         snprintf(outKey, outKeyLen, "From ");
-        return parser_printAddress(&parser_tx_obj.from,
+        return parser_printAddress(ctx, &tx->from,
                                    outVal, outValLen, pageIdx, pageCount);
     }
 
     if (displayIdx == 2) {
         snprintf(outKey, outKeyLen, "Nonce ");
-        if (uint64_to_str(outVal, outValLen, parser_tx_obj.nonce) != NULL) {
+        if (uint64_to_decimal(outVal, outValLen, tx->nonce) != NULL) {
             return parser_unexepected_error;
         }
         *pageCount = 1;
@@ -177,12 +274,12 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
 
     if (displayIdx == 3) {
         snprintf(outKey, outKeyLen, "Value ");
-        return parser_printBigIntFixedPoint(&parser_tx_obj.value, outVal, outValLen, pageIdx, pageCount);
+        return parser_printBigIntFixedPoint(ctx, &tx->value, outVal, outValLen, pageIdx, pageCount);
     }
 
     if (displayIdx == 4) {
         snprintf(outKey, outKeyLen, "Gas Limit ");
-        if (int64_to_str(outVal, outValLen, parser_tx_obj.gaslimit) != NULL) {
+        if (int64_to_decimal(outVal, outValLen, tx->gaslimit) != NULL) {
             return parser_unexepected_error;
         }
         *pageCount = 1;
@@ -191,32 +288,32 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
 
     if (displayIdx == 5) {
         snprintf(outKey, outKeyLen, "Gas Premium ");
-        return parser_printBigIntFixedPoint(&parser_tx_obj.gaspremium, outVal, outValLen, pageIdx, pageCount);
+        return parser_printBigIntFixedPoint(ctx, &tx->gaspremium, outVal, outValLen, pageIdx, pageCount);
     }
 
     if (displayIdx == 6) {
         snprintf(outKey, outKeyLen, "Gas Fee Cap ");
-        return parser_printBigIntFixedPoint(&parser_tx_obj.gasfeecap, outVal, outValLen, pageIdx, pageCount);
+        return parser_printBigIntFixedPoint(ctx, &tx->gasfeecap, outVal, outValLen, pageIdx, pageCount);
     }
 
     if (displayIdx == 7) {
         snprintf(outKey, outKeyLen, "Method ");
         *pageCount = 1;
 
-        CHECK_PARSER_ERR(checkMethod(parser_tx_obj.method));
-        if (parser_tx_obj.method == 0) {
+        CHECK_PARSER_ERR(checkMethod(tx->method));
+        if (tx->method == 0) {
             snprintf(outVal, outValLen, "Transfer ");
             return parser_ok;
         } else {
             char buffer[100];
             MEMZERO(buffer, sizeof(buffer));
-            fpuint64_to_str(buffer, sizeof(buffer), parser_tx_obj.method, 0);
-            pageString(outVal, outValLen, buffer, pageIdx, pageCount);
+            fpuint64_to_decimal(buffer, sizeof(buffer), tx->method, 0);
+            parser_pageValue(ctx, outVal, outValLen, buffer, pageIdx, pageCount);
             return parser_ok;
         }
     }
 
-    if (parser_tx_obj.numparams == 0) {
+    if (tx->numparams == 0) {
         snprintf(outKey, outKeyLen, "Params ");
         snprintf(outVal, outValLen, "- NONE -");
         return parser_ok;
@@ -226,7 +323,7 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
     int32_t paramIdxSigned = displayIdx - 8;
 
     // end of params
-    if (paramIdxSigned < 0 || paramIdxSigned >= parser_tx_obj.numparams) {
+    if (paramIdxSigned < 0 || paramIdxSigned >= tx->numparams) {
         return parser_unexpected_field;
     }
 
@@ -235,5 +332,5 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
     snprintf(outKey, outKeyLen, "Params |%d| ", paramIdx + 1);
 
     zemu_log_stack(outKey);
-    return parser_printParam(&parser_tx_obj, paramIdx, outVal, outValLen, pageIdx, pageCount);
+    return parser_printParam(ctx, paramIdx, outVal, outValLen, pageIdx, pageCount);
 }
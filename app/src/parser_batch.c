@@ -0,0 +1,173 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+
+#include "parser_batch.h"
+#include "parser.h"
+#include "parser_cache.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BATCH_MAX_THREADS   256
+#define BATCH_CACHE_LINE    64
+// Each worker keeps the checksums of the addresses it has seen, hot senders are then hashed once per worker
+#ifndef BATCH_ADDRESS_MEMO_ENTRIES
+#define BATCH_ADDRESS_MEMO_ENTRIES  64
+#endif
+
+// Each worker owns a contiguous share of the batch. Items are claimed one at a time
+// with an atomic increment, so idle workers can steal from the share of busy ones.
+typedef struct {
+    atomic_size_t next;
+    size_t end;
+    uint8_t padding[BATCH_CACHE_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+} batch_share_t;
+
+typedef struct {
+    const parser_batch_item_t *items;
+    parser_error_t *results;
+    batch_share_t *shares;
+    uint32_t numWorkers;
+} batch_job_t;
+
+typedef struct {
+    batch_job_t *job;
+    uint32_t workerIdx;
+} batch_worker_t;
+
+static parser_error_t batch_processItem(const parser_batch_item_t *item, parser_address_memo_t *memo) {
+    parser_tx_t tx_obj;
+    parser_context_t ctx;
+
+    CHECK_PARSER_ERR(parser_parse_r(&ctx, item->buffer, item->bufferLen, &tx_obj))
+    CHECK_PARSER_ERR(parser_addressMemoAttach(&ctx, memo))
+    return parser_validate_r(&ctx);
+}
+
+static void batch_drainShare(batch_job_t *job, batch_share_t *share, parser_address_memo_t *memo) {
+    while (true) {
+        const size_t idx = atomic_fetch_add_explicit(&share->next, 1, memory_order_relaxed);
+        if (idx >= share->end) {
+            return;
+        }
+        job->results[idx] = batch_processItem(&job->items[idx], memo);
+    }
+}
+
+static void *batch_workerMain(void *arg) {
+    const batch_worker_t *worker = (const batch_worker_t *) arg;
+    batch_job_t *job = worker->job;
+
+    parser_address_memo_entry_t memoEntries[BATCH_ADDRESS_MEMO_ENTRIES];
+    parser_address_memo_t memo;
+    parser_addressMemoInit(&memo, memoEntries, BATCH_ADDRESS_MEMO_ENTRIES);
+
+    // Own share first, then visit the other workers in order and steal what is left
+    for (uint32_t i = 0; i < job->numWorkers; i++) {
+        batch_drainShare(job, &job->shares[(worker->workerIdx + i) % job->numWorkers], &memo);
+    }
+
+    return NULL;
+}
+
+static uint32_t batch_defaultThreads() {
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) {
+        return 1;
+    }
+    return cores > BATCH_MAX_THREADS ? BATCH_MAX_THREADS : (uint32_t) cores;
+}
+
+parser_error_t parser_batch_validate(const parser_batch_item_t *items, size_t numItems,
+                                     parser_error_t *results, uint32_t numThreads) {
+    if (numItems == 0) {
+        return parser_ok;
+    }
+    if (items == NULL || results == NULL) {
+        return parser_no_data;
+    }
+
+    if (numThreads == 0) {
+        numThreads = batch_defaultThreads();
+    }
+    if (numThreads > BATCH_MAX_THREADS) {
+        numThreads = BATCH_MAX_THREADS;
+    }
+    if (numThreads > numItems) {
+        numThreads = (uint32_t) numItems;
+    }
+
+    if (numThreads == 1) {
+        parser_address_memo_entry_t memoEntries[BATCH_ADDRESS_MEMO_ENTRIES];
+        parser_address_memo_t memo;
+        parser_addressMemoInit(&memo, memoEntries, BATCH_ADDRESS_MEMO_ENTRIES);
+        for (size_t i = 0; i < numItems; i++) {
+            results[i] = batch_processItem(&items[i], &memo);
+        }
+        return parser_ok;
+    }
+
+    batch_share_t *shares = aligned_alloc(BATCH_CACHE_LINE, sizeof(batch_share_t) * numThreads);
+    batch_worker_t *workers = calloc(numThreads, sizeof(batch_worker_t));
+    pthread_t *threads = calloc(numThreads, sizeof(pthread_t));
+    if (shares == NULL || workers == NULL || threads == NULL) {
+        free(shares);
+        free(workers);
+        free(threads);
+        return parser_unexepected_error;
+    }
+
+    batch_job_t job = {
+            .items = items,
+            .results = results,
+            .shares = shares,
+            .numWorkers = numThreads,
+    };
+
+    for (uint32_t i = 0; i < numThreads; i++) {
+        atomic_init(&shares[i].next, (numItems * i) / numThreads);
+        shares[i].end = (numItems * (i + 1)) / numThreads;
+        workers[i].job = &job;
+        workers[i].workerIdx = i;
+    }
+
+    // The calling thread acts as worker 0
+    uint32_t started = 1;
+    for (uint32_t i = 1; i < numThreads; i++, started++) {
+        if (pthread_create(&threads[i], NULL, batch_workerMain, &workers[i]) != 0) {
+            break;
+        }
+    }
+
+    // Shares of workers that could not be started are stolen by the others
+    batch_workerMain(&workers[0]);
+
+    for (uint32_t i = 1; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(shares);
+    free(workers);
+    free(threads);
+    return parser_ok;
+}
+
+#endif
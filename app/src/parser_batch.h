@@ -0,0 +1,46 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "parser_common.h"
+
+// Host only: batch validation is not available in Ledger builds
+
+typedef struct {
+    const uint8_t *buffer;
+    size_t bufferLen;
+} parser_batch_item_t;
+
+/// Parses and validates (which renders every display item) each message in items.
+/// Work is distributed across numThreads workers that steal from each other once their own share is done.
+/// Each worker keeps the checksums of the last BATCH_ADDRESS_MEMO_ENTRIES addresses it has shown.
+/// \param items messages to check, buffers must stay valid during the call
+/// \param numItems number of messages
+/// \param results receives the parser_error_t of items[i] in results[i]
+/// \param numThreads number of workers, 0 uses all online cores
+/// \return parser_ok if the batch could be processed (individual results are in results)
+parser_error_t parser_batch_validate(const parser_batch_item_t *items, size_t numItems,
+                                     parser_error_t *results, uint32_t numThreads);
+
+#ifdef __cplusplus
+}
+#endif
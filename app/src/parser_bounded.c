@@ -0,0 +1,353 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#include "parser_bounded.h"
+#include "parser.h"
+#include "parser_impl.h"
+#include "int_decimal.h"
+#include <stdio.h>
+#include <zxmacros.h>
+#include <zxformat.h>
+
+#define CBOR_MAJOR_TYPE_UINT        0
+#define CBOR_MAJOR_TYPE_NEGINT      1
+#define CBOR_MAJOR_TYPE_BYTES       2
+#define CBOR_MAJOR_TYPE_TEXT        3
+#define CBOR_MAJOR_TYPE_ARRAY       4
+#define CBOR_MAJOR_TYPE_MAP         5
+#define CBOR_MAJOR_TYPE_TAG         6
+#define CBOR_MAJOR_TYPE_SIMPLE      7
+
+// Additional information values
+#define CBOR_AI_UINT8               24
+#define CBOR_AI_UINT64              27
+#define CBOR_SIMPLE_MIN_EXTENDED    32
+
+void parser_bounded_init(parser_bounded_t *bounded, parser_tx_t *tx_obj, uint8_t *window, parser_size_t windowSize,
+                         uint64_t bufferedMaxLen) {
+    MEMZERO(bounded, sizeof(parser_bounded_t));
+    bounded->tx_obj = tx_obj;
+    bounded->window = window;
+    bounded->windowSize = windowSize;
+    bounded->bufferedMaxLen = bufferedMaxLen;
+    bounded->error = parser_ok;
+    crypto_digestInit(&bounded->digest);
+}
+
+// Reads the fields in the window from the start, the window is small enough for that to be cheap
+static parser_error_t bounded_readHeader(parser_bounded_t *bounded) {
+    parser_context_t c;
+    if (parser_init(&c, bounded->window, bounded->windowLen) != parser_ok) {
+        return parser_cbor_unexpected_EOF;
+    }
+    c.tx_obj = bounded->tx_obj;
+
+    CborParser parser;
+    CborValue it;
+    CborValue arrayContainer;
+    CHECK_PARSER_ERR(_readStart(&c, &parser, &it, &arrayContainer))
+    for (uint8_t field = tx_field_version; field < tx_field_method; field++) {
+        CHECK_PARSER_ERR(_readField(&c, bounded->tx_obj, field, &arrayContainer))
+    }
+
+    parser_size_t paramsOffset = 0;
+    CHECK_PARSER_ERR(_readMethodHeader(&c, bounded->tx_obj, &arrayContainer, &paramsOffset, &bounded->paramsLen))
+
+    bounded->headerLen = paramsOffset;
+    bounded->headerDone = true;
+    return parser_ok;
+}
+
+// Length of an item head from its initial byte. Indefinite lengths (and the break that ends them) are not
+// accepted in the params, there is no reason to use them and they would need more state
+static parser_error_t bounded_headLen(uint8_t initialByte, uint8_t *headLen) {
+    const uint8_t additionalInfo = initialByte & 0x1F;
+    if (additionalInfo < CBOR_AI_UINT8) {
+        *headLen = 1;
+        return parser_ok;
+    }
+    if (additionalInfo > CBOR_AI_UINT64) {
+        return parser_cbor_unexpected;
+    }
+    *headLen = (uint8_t) (1 + (1 << (additionalInfo - CBOR_AI_UINT8)));
+    return parser_ok;
+}
+
+// An item is complete: it counts for its container, and completes the containers it was the last item of
+static void bounded_itemDone(parser_bounded_t *bounded) {
+    while (bounded->depth > 0) {
+        if (--bounded->itemsLeft[bounded->depth - 1] > 0) {
+            return;
+        }
+        bounded->depth--;
+    }
+    bounded->paramsDone = true;
+}
+
+// Checks the head in itemHead, bytesLeft params bytes follow it
+static parser_error_t bounded_readItemHead(parser_bounded_t *bounded, uint64_t bytesLeft) {
+    const uint8_t majorType = bounded->itemHead[0] >> 5;
+    uint64_t argument = bounded->itemHead[0] & 0x1F;
+    if (bounded->itemHeadLen > 1) {
+        argument = 0;
+        for (uint8_t i = 1; i < bounded->itemHeadLen; i++) {
+            argument = (argument << 8) | bounded->itemHead[i];
+        }
+    }
+
+    // Params are one array or map, as _readParams accepts them
+    const bool topLevel = bounded->depth == 0;
+    if (topLevel) {
+        if (majorType != CBOR_MAJOR_TYPE_ARRAY && majorType != CBOR_MAJOR_TYPE_MAP) {
+            return parser_unexpected_type;
+        }
+        if (argument > MAX_PARAMS_COUNT) {
+            return parser_value_out_of_range;
+        }
+    }
+
+    switch (majorType) {
+        case CBOR_MAJOR_TYPE_UINT:
+        case CBOR_MAJOR_TYPE_NEGINT:
+            bounded_itemDone(bounded);
+            return parser_ok;
+        case CBOR_MAJOR_TYPE_BYTES:
+        case CBOR_MAJOR_TYPE_TEXT:
+            if (argument > bytesLeft) {
+                return parser_unexpected_buffer_end;
+            }
+            bounded->stringLeft = argument;
+            if (argument == 0) {
+                bounded_itemDone(bounded);
+            }
+            return parser_ok;
+        case CBOR_MAJOR_TYPE_ARRAY:
+        case CBOR_MAJOR_TYPE_MAP: {
+            // every item takes at least one byte
+            const uint64_t itemsPerEntry = majorType == CBOR_MAJOR_TYPE_MAP ? 2 : 1;
+            if (argument > bytesLeft / itemsPerEntry) {
+                return parser_unexpected_buffer_end;
+            }
+            if (argument == 0) {
+                bounded_itemDone(bounded);
+                return parser_ok;
+            }
+            if (bounded->depth == PARSER_BOUNDED_PARAMS_MAX_DEPTH) {
+                return parser_value_out_of_range;
+            }
+            bounded->itemsLeft[bounded->depth++] = argument * itemsPerEntry;
+            return parser_ok;
+        }
+        case CBOR_MAJOR_TYPE_TAG:
+            // the tagged item follows, and counts in place of the tag
+            return parser_ok;
+        case CBOR_MAJOR_TYPE_SIMPLE:
+        default:
+            // one byte simple values below 32 are not well-formed
+            if (bounded->itemHeadLen == 2 && argument < CBOR_SIMPLE_MIN_EXTENDED) {
+                return parser_cbor_unexpected;
+            }
+            bounded_itemDone(bounded);
+            return parser_ok;
+    }
+}
+
+static parser_error_t bounded_readParams(parser_bounded_t *bounded, const uint8_t *data, size_t dataLen) {
+    if (dataLen == 0) {
+        return parser_ok;
+    }
+
+    // Anything after the params is past the end of the message
+    if (dataLen > bounded->paramsLen - bounded->paramsReceived) {
+        return parser_unexpected_characters;
+    }
+
+    // Walks the items of the params, heads and strings can be split across chunks
+    size_t pos = 0;
+    while (pos < dataLen) {
+        if (bounded->paramsDone) {
+            return parser_unexpected_characters;
+        }
+
+        if (bounded->stringLeft > 0) {
+            const size_t skipped = bounded->stringLeft < dataLen - pos ? (size_t) bounded->stringLeft : dataLen - pos;
+            pos += skipped;
+            bounded->stringLeft -= skipped;
+            if (bounded->stringLeft == 0) {
+                bounded_itemDone(bounded);
+            }
+            continue;
+        }
+
+        bounded->itemHead[bounded->itemHeadLen++] = data[pos++];
+        uint8_t headLen = 0;
+        CHECK_PARSER_ERR(bounded_headLen(bounded->itemHead[0], &headLen))
+        if (bounded->itemHeadLen < headLen) {
+            continue;
+        }
+
+        const uint64_t bytesLeft = bounded->paramsLen - bounded->paramsReceived - pos;
+        CHECK_PARSER_ERR(bounded_readItemHead(bounded, bytesLeft))
+        bounded->itemHeadLen = 0;
+    }
+
+    bounded->paramsReceived += dataLen;
+    return parser_ok;
+}
+
+static parser_error_t bounded_read(parser_bounded_t *bounded, const uint8_t *chunk, size_t chunkLen) {
+    if (bounded->headerDone) {
+        return bounded_readParams(bounded, chunk, chunkLen);
+    }
+
+    const size_t windowFree = bounded->windowSize - bounded->windowLen;
+    const size_t copied = chunkLen < windowFree ? chunkLen : windowFree;
+    MEMCPY(bounded->window + bounded->windowLen, chunk, copied);
+    bounded->windowLen += (parser_size_t) copied;
+
+    const parser_error_t err = bounded_readHeader(bounded);
+    if (err == parser_cbor_unexpected_EOF) {
+        // The field being read is larger than what the window can keep
+        return bounded->windowLen < bounded->windowSize ? parser_ok : parser_value_out_of_range;
+    }
+    CHECK_PARSER_ERR(err)
+
+    // Bytes after the params header are params, they are dropped from the window
+    const parser_size_t paramsInWindow = bounded->windowLen - bounded->headerLen;
+    bounded->windowLen = bounded->headerLen;
+    CHECK_PARSER_ERR(bounded_readParams(bounded, bounded->window + bounded->headerLen, paramsInWindow))
+    return bounded_readParams(bounded, chunk + copied, chunkLen - copied);
+}
+
+parser_error_t parser_bounded_update(parser_bounded_t *bounded, const uint8_t *chunk, size_t chunkLen) {
+    if (bounded->tx_obj == NULL || bounded->window == NULL) {
+        return parser_init_context_empty;
+    }
+    if (bounded->error != parser_ok) {
+        return bounded->error;
+    }
+
+    crypto_digestUpdate(&bounded->digest, chunk, chunkLen);
+    bounded->messageLen += chunkLen;
+    bounded->error = bounded_read(bounded, chunk, chunkLen);
+    return bounded->error;
+}
+
+parser_error_t parser_bounded_finish(parser_bounded_t *bounded, parser_context_t *ctx) {
+    if (bounded->tx_obj == NULL || bounded->window == NULL) {
+        return parser_init_context_empty;
+    }
+    CHECK_PARSER_ERR(bounded->error)
+
+    // The message ends with the params, which end with their container
+    if (!bounded->headerDone || bounded->paramsReceived != bounded->paramsLen ||
+        (bounded->paramsLen > 0 && !bounded->paramsDone)) {
+        bounded->error = parser_cbor_unexpected_EOF;
+        return bounded->error;
+    }
+
+    if (bounded->messageLen <= bounded->bufferedMaxLen) {
+        bounded->error = parser_stream_not_needed;
+        return bounded->error;
+    }
+
+    if (crypto_digestFinalCid(&bounded->digest, bounded->digestToSign, sizeof(bounded->digestToSign),
+                              bounded->cidText, sizeof(bounded->cidText)) != zxerr_ok) {
+        bounded->error = parser_unexepected_error;
+        return bounded->error;
+    }
+
+    CHECK_PARSER_ERR(parser_init(ctx, bounded->window, bounded->headerLen))
+    ctx->tx_obj = bounded->tx_obj;
+    bounded->finished = true;
+    return parser_ok;
+}
+
+parser_error_t parser_bounded_validate(const parser_bounded_t *bounded, const parser_context_t *ctx) {
+    // Message fields, params are not in the window so tx_obj has none
+    CHECK_PARSER_ERR(parser_validate_r(ctx))
+
+    uint8_t numItems = 0;
+    CHECK_PARSER_ERR(parser_bounded_getNumItems(bounded, &numItems))
+
+    char tmpKey[40];
+    char tmpVal[40];
+    for (uint8_t idx = 0; idx < numItems; idx++) {
+        if (idx >= PARSER_BOUNDED_FIRST_FIELD && idx < PARSER_BOUNDED_FIRST_FIELD + PARSER_BOUNDED_FIELD_ITEMS) {
+            continue;
+        }
+        uint8_t pageCount = 0;
+        CHECK_PARSER_ERR(parser_bounded_getItem(bounded, ctx, idx, tmpKey, sizeof(tmpKey),
+                                                tmpVal, sizeof(tmpVal), 0, &pageCount))
+    }
+    return parser_ok;
+}
+
+parser_error_t parser_bounded_getNumItems(const parser_bounded_t *bounded, uint8_t *num_items) {
+    if (!bounded->finished) {
+        return parser_no_data;
+    }
+    *num_items = 1 + PARSER_BOUNDED_FIELD_ITEMS + (bounded->paramsLen > 0 ? 1 : 0) + 1;
+    return parser_ok;
+}
+
+parser_error_t parser_bounded_getItem(const parser_bounded_t *bounded, const parser_context_t *ctx,
+                                      uint8_t displayIdx,
+                                      char *outKey, uint16_t outKeyLen,
+                                      char *outVal, uint16_t outValLen,
+                                      uint8_t pageIdx, uint8_t *pageCount) {
+    uint8_t numItems = 0;
+    CHECK_PARSER_ERR(parser_bounded_getNumItems(bounded, &numItems))
+
+    if (displayIdx >= PARSER_BOUNDED_FIRST_FIELD && displayIdx < PARSER_BOUNDED_FIRST_FIELD + PARSER_BOUNDED_FIELD_ITEMS) {
+        return parser_getItem_r(ctx, displayIdx - PARSER_BOUNDED_FIRST_FIELD,
+                                outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+    }
+
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+    snprintf(outKey, outKeyLen, "?");
+    snprintf(outVal, outValLen, " ");
+    *pageCount = 0;
+
+    if (displayIdx >= numItems) {
+        return parser_no_data;
+    }
+
+    if (displayIdx == 0) {
+        snprintf(outKey, outKeyLen, "Warning ");
+        pageString(outVal, outValLen, "Params not shown, check the CID", pageIdx, pageCount);
+        return parser_ok;
+    }
+
+    if (displayIdx == numItems - 1) {
+        snprintf(outKey, outKeyLen, "Message CID ");
+        pageString(outVal, outValLen, bounded->cidText, pageIdx, pageCount);
+        return parser_ok;
+    }
+
+    snprintf(outKey, outKeyLen, "Params ");
+    *pageCount = 1;
+    char bytesText[21];
+    if (uint64_to_decimal(bytesText, sizeof(bytesText), bounded->paramsLen) != NULL) {
+        return parser_unexepected_error;
+    }
+    snprintf(outVal, outValLen, "%s bytes", bytesText);
+    return parser_ok;
+}
+
+const uint8_t *parser_bounded_digest(const parser_bounded_t *bounded) {
+    return bounded->finished ? bounded->digestToSign : NULL;
+}
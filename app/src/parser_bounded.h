@@ -0,0 +1,111 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "parser_common.h"
+#include "crypto.h"
+
+// Display items of a message read in bounded mode: a warning that the params are not shown, the message
+// fields, then the size of the params (only if there are params) and the message CID
+#define PARSER_BOUNDED_FIRST_FIELD  1
+#define PARSER_BOUNDED_FIELD_ITEMS  8
+
+// Containers that can be open at once in the params, deeper ones are rejected
+#define PARSER_BOUNDED_PARAMS_MAX_DEPTH 8
+
+// Reads a message of any length with a fixed amount of memory, as chunks arrive.
+// The fields before the params are kept in a caller-owned window. Params are not kept: their CBOR
+// structure is checked as they arrive, they are shown as their size, and the message CID identifies
+// the whole message.
+// The struct must not be moved while in use.
+typedef struct {
+    parser_tx_t *tx_obj;
+
+    // fields before the params, only the first headerLen bytes once the params header has been read
+    uint8_t *window;
+    parser_size_t windowSize;
+    parser_size_t windowLen;
+    parser_size_t headerLen;
+    bool headerDone;
+
+    uint64_t paramsLen;
+    uint64_t paramsReceived;
+
+    // params item being read: its head (initial byte and argument), or the string payload left to skip
+    uint8_t itemHead[9];
+    uint8_t itemHeadLen;
+    uint64_t stringLeft;
+    // items left in each open container, map keys and values count as one item each
+    uint64_t itemsLeft[PARSER_BOUNDED_PARAMS_MAX_DEPTH];
+    uint8_t depth;
+    // the params container is complete, nothing can follow it
+    bool paramsDone;
+
+    // messages up to this length are rejected, see parser_bounded_init
+    uint64_t bufferedMaxLen;
+    uint64_t messageLen;
+
+    crypto_digest_t digest;
+    // filled by parser_bounded_finish
+    bool finished;
+    uint8_t digestToSign[BLAKE2B_256_SIZE];
+    char cidText[MESSAGE_CID_TEXT_LEN + 1];
+
+    parser_error_t error;
+} parser_bounded_t;
+
+/// Starts reading a new message
+/// \param bounded reader state
+/// \param tx_obj caller-owned storage for the parsed transaction
+/// \param window caller-owned storage for the fields before the params, messages whose fields
+///        do not fit are rejected with parser_value_out_of_range
+/// \param bufferedMaxLen messages of at most this many bytes are rejected with parser_stream_not_needed:
+///        they fit the buffer of the regular sign mode, which shows every param
+void parser_bounded_init(parser_bounded_t *bounded, parser_tx_t *tx_obj, uint8_t *window, parser_size_t windowSize,
+                         uint64_t bufferedMaxLen);
+
+/// Reads the next chunk of the message, which does not have to be kept by the caller
+/// \return parser_ok if no error was found yet, otherwise the first error found (every later call returns it too)
+parser_error_t parser_bounded_update(parser_bounded_t *bounded, const uint8_t *chunk, size_t chunkLen);
+
+/// Checks that the whole message has been received, params included, and finishes its digest and CID
+/// On return, ctx references the fields kept in the window, as parser_parse_r would for a message without params
+parser_error_t parser_bounded_finish(parser_bounded_t *bounded, parser_context_t *ctx);
+
+/// Renders every display item once, as parser_validate_r does
+parser_error_t parser_bounded_validate(const parser_bounded_t *bounded, const parser_context_t *ctx);
+
+parser_error_t parser_bounded_getNumItems(const parser_bounded_t *bounded, uint8_t *num_items);
+
+parser_error_t parser_bounded_getItem(const parser_bounded_t *bounded, const parser_context_t *ctx,
+                                      uint8_t displayIdx,
+                                      char *outKey, uint16_t outKeyLen,
+                                      char *outVal, uint16_t outValLen,
+                                      uint8_t pageIdx, uint8_t *pageCount);
+
+/// Digest to sign (BLAKE2B_256_SIZE bytes), the same prepareDigestToSign returns for the whole message
+/// \return NULL until parser_bounded_finish succeeds
+const uint8_t *parser_bounded_digest(const parser_bounded_t *bounded);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,192 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "parser_cache.h"
+#include <stdio.h>
+#include <string.h>
+#include <zxmacros.h>
+#include "zxformat.h"
+#include "crypto.h"
+
+parser_error_t parser_cacheAttach(parser_context_t *ctx, parser_render_cache_t *cache,
+                                  uint8_t *arena, uint16_t arenaSize) {
+    if (ctx == NULL || cache == NULL || arena == NULL) {
+        return parser_no_data;
+    }
+
+    MEMZERO(cache, sizeof(parser_render_cache_t));
+    cache->arena = arena;
+    cache->arenaSize = arenaSize;
+    for (uint8_t i = 0; i < PARSER_CACHE_MAX_ITEMS; i++) {
+        cache->entries[i] = PARSER_CACHE_NO_ENTRY;
+    }
+
+    ctx->cache = cache;
+    return parser_ok;
+}
+
+void parser_cacheBegin(const parser_context_t *ctx) {
+    if (ctx->cache == NULL) {
+        return;
+    }
+    ctx->cache->filling = true;
+    ctx->cache->staged = false;
+}
+
+void parser_cacheEnd(const parser_context_t *ctx, uint8_t displayIdx, const char *key) {
+    parser_render_cache_t *cache = ctx->cache;
+    if (cache == NULL) {
+        return;
+    }
+
+    const bool staged = cache->staged;
+    cache->filling = false;
+    cache->staged = false;
+
+    // Only values that went through parser_pageValue are staged, others are cheap to render
+    if (!staged || key == NULL || displayIdx >= PARSER_CACHE_MAX_ITEMS ||
+        cache->entries[displayIdx] != PARSER_CACHE_NO_ENTRY) {
+        return;
+    }
+
+    char *value = (char *) cache->arena + cache->arenaUsed;
+    const size_t valueSize = strlen(value) + 1;
+    const size_t keySize = strlen(key) + 1;
+    if (keySize > (size_t) (cache->arenaSize - cache->arenaUsed) - valueSize) {
+        return;
+    }
+
+    MEMCPY(value + valueSize, key, keySize);
+    cache->entries[displayIdx] = cache->arenaUsed;
+    cache->arenaUsed += valueSize + keySize;
+}
+
+bool parser_cacheGetItem(const parser_context_t *ctx, uint8_t displayIdx,
+                         char *outKey, uint16_t outKeyLen,
+                         char *outVal, uint16_t outValLen,
+                         uint8_t pageIdx, uint8_t *pageCount) {
+    const parser_render_cache_t *cache = ctx->cache;
+    if (cache == NULL || displayIdx >= PARSER_CACHE_MAX_ITEMS ||
+        cache->entries[displayIdx] == PARSER_CACHE_NO_ENTRY) {
+        return false;
+    }
+
+    const char *value = (const char *) cache->arena + cache->entries[displayIdx];
+    const char *key = value + strlen(value) + 1;
+
+    snprintf(outKey, outKeyLen, "%s", key);
+    pageString(outVal, outValLen, value, pageIdx, pageCount);
+    return true;
+}
+
+char *parser_cacheStageBuffer(const parser_context_t *ctx, uint16_t *bufferSize) {
+    *bufferSize = 0;
+    parser_render_cache_t *cache = ctx->cache;
+    if (cache == NULL || !cache->filling) {
+        return NULL;
+    }
+
+    // the key is appended by parser_cacheEnd, keep at least one byte for it
+    const uint16_t available = cache->arenaSize - cache->arenaUsed;
+    if (available < 2) {
+        return NULL;
+    }
+    *bufferSize = available - 1;
+    return (char *) cache->arena + cache->arenaUsed;
+}
+
+void parser_cacheStaged(const parser_context_t *ctx) {
+    if (ctx->cache != NULL && ctx->cache->filling) {
+        ctx->cache->staged = true;
+    }
+}
+
+void parser_pageValue(const parser_context_t *ctx,
+                      char *outVal, uint16_t outValLen,
+                      const char *value,
+                      uint8_t pageIdx, uint8_t *pageCount) {
+    parser_render_cache_t *cache = ctx->cache;
+    if (cache != NULL && cache->filling) {
+        // the key is appended by parser_cacheEnd, keep at least one byte for it
+        const size_t valueSize = strlen(value) + 1;
+        cache->staged = valueSize < (size_t) (cache->arenaSize - cache->arenaUsed);
+        if (cache->staged) {
+            MEMCPY(cache->arena + cache->arenaUsed, value, valueSize);
+        }
+    }
+
+    pageString(outVal, outValLen, value, pageIdx, pageCount);
+}
+
+parser_error_t parser_addressMemoInit(parser_address_memo_t *memo,
+                                      parser_address_memo_entry_t *entries, uint16_t numEntries) {
+    if (memo == NULL || entries == NULL || numEntries == 0) {
+        return parser_no_data;
+    }
+
+    MEMZERO(memo, sizeof(parser_address_memo_t));
+    MEMZERO(entries, sizeof(parser_address_memo_entry_t) * numEntries);
+    memo->entries = entries;
+    memo->numEntries = numEntries;
+    return parser_ok;
+}
+
+parser_error_t parser_addressMemoAttach(parser_context_t *ctx, parser_address_memo_t *memo) {
+    if (ctx == NULL || memo == NULL || memo->entries == NULL) {
+        return parser_no_data;
+    }
+    ctx->addressMemo = memo;
+    return parser_ok;
+}
+
+const uint8_t *parser_addressChecksum(const parser_context_t *ctx,
+                                      const uint8_t *address, uint16_t addressLen,
+                                      uint8_t *checksum) {
+    parser_address_memo_t *memo = ctx->addressMemo;
+    if (memo == NULL || addressLen == 0 || addressLen > PARSER_ADDRESS_MEMO_KEY_LEN) {
+        return NULL;
+    }
+
+    memo->clock++;
+    if (memo->clock == 0) {
+        // the clock wrapped around, start over rather than keeping a wrong order
+        MEMZERO(memo->entries, sizeof(parser_address_memo_entry_t) * memo->numEntries);
+        memo->clock = 1;
+    }
+
+    // Lookup, remembering the least recently used entry in case it is missing
+    parser_address_memo_entry_t *victim = &memo->entries[0];
+    for (uint16_t i = 0; i < memo->numEntries; i++) {
+        parser_address_memo_entry_t *entry = &memo->entries[i];
+        if (entry->lastUse != 0 && entry->addressLen == addressLen &&
+            memcmp(entry->address, address, addressLen) == 0) {
+            entry->lastUse = memo->clock;
+            MEMCPY(checksum, entry->checksum, PARSER_ADDRESS_CHECKSUM_LEN);
+            return checksum;
+        }
+        if (entry->lastUse < victim->lastUse) {
+            victim = entry;
+        }
+    }
+
+    memo->misses++;
+    addressChecksum(address, addressLen, victim->checksum);
+    MEMCPY(victim->address, address, addressLen);
+    victim->addressLen = (uint8_t) addressLen;
+    victim->lastUse = memo->clock;
+    MEMCPY(checksum, victim->checksum, PARSER_ADDRESS_CHECKSUM_LEN);
+    return checksum;
+}
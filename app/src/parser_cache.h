@@ -0,0 +1,81 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "parser_common.h"
+
+/// Attaches a render cache to a parsed context. Must be called after parsing and before parser_validate,
+/// which fills it. Items that do not fit in the arena are rendered again on every request.
+/// \param ctx parsed context, it keeps a reference to cache
+/// \param cache caller-owned, must outlive the use of ctx
+/// \param arena caller-owned storage for the rendered strings
+/// \param arenaSize size of arena in bytes
+parser_error_t parser_cacheAttach(parser_context_t *ctx, parser_render_cache_t *cache,
+                                  uint8_t *arena, uint16_t arenaSize);
+
+/// Starts rendering a display item while validating
+void parser_cacheBegin(const parser_context_t *ctx);
+
+/// Finishes rendering a display item while validating, key is NULL if rendering failed
+void parser_cacheEnd(const parser_context_t *ctx, uint8_t displayIdx, const char *key);
+
+/// Serves a display item from the cache
+/// \return true if the item was cached, outKey/outVal/pageCount are then filled as parser_getItem would
+bool parser_cacheGetItem(const parser_context_t *ctx, uint8_t displayIdx,
+                         char *outKey, uint16_t outKeyLen,
+                         char *outVal, uint16_t outValLen,
+                         uint8_t pageIdx, uint8_t *pageCount);
+
+/// While validating, returns where a value can be rendered in full to be staged in the cache
+/// \param bufferSize receives the space available, NUL termination included
+/// \return NULL if nothing is being cached
+char *parser_cacheStageBuffer(const parser_context_t *ctx, uint16_t *bufferSize);
+
+/// Marks the value written to parser_cacheStageBuffer as complete, parser_cacheEnd will keep it
+void parser_cacheStaged(const parser_context_t *ctx);
+
+/// Pages a fully rendered value. While validating, a copy is staged in the cache
+void parser_pageValue(const parser_context_t *ctx,
+                      char *outVal, uint16_t outValLen,
+                      const char *value,
+                      uint8_t pageIdx, uint8_t *pageCount);
+
+/// Prepares an address memo, entries are evicted least recently used first once all are taken
+/// \param memo caller-owned, can be shared by the contexts of consecutive messages (not concurrently)
+/// \param entries caller-owned storage for the memo
+/// \param numEntries number of entries
+parser_error_t parser_addressMemoInit(parser_address_memo_t *memo,
+                                      parser_address_memo_entry_t *entries, uint16_t numEntries);
+
+/// Attaches an address memo to a parsed context, addresses are then checksummed at most once
+parser_error_t parser_addressMemoAttach(parser_context_t *ctx, parser_address_memo_t *memo);
+
+/// Checksum of an address, from the memo attached to ctx if it was already computed
+/// \param checksum receives PARSER_ADDRESS_CHECKSUM_LEN bytes
+/// \return NULL if no memo is attached or the address is too long to be kept, checksum otherwise
+const uint8_t *parser_addressChecksum(const parser_context_t *ctx,
+                                      const uint8_t *address, uint16_t addressLen,
+                                      uint8_t *checksum);
+
+#ifdef __cplusplus
+}
+#endif
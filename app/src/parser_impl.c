@@ -14,12 +14,17 @@
 *  limitations under the License.
 ********************************************************************************/
 
+#include <string.h>
 #include <zxmacros.h>
 #include "parser_impl.h"
 #include "parser_txdef.h"
 #include "cbor.h"
 #include "app_mode.h"
 #include "zxformat.h"
+#include "parser_cache.h"
+#include "page_slice.h"
+#include "int_decimal.h"
+#include "hex_codec.h"
 
 parser_tx_t parser_tx_obj;
 
@@ -33,28 +38,32 @@ __Z_INLINE parser_error_t parser_mapCborError(CborError err);
 
 #define CHECK_CBOR_TYPE(type, expected) {if ((type)!=(expected)) return parser_unexpected_type;}
 
-#define INIT_CBOR_PARSER(c, it)  \
-    CborParser parser;           \
-    CHECK_CBOR_MAP_ERR(cbor_parser_init((c)->buffer + (c)->offset, (c)->bufferLen - (c)->offset, 0, &parser, &(it)))
-
 parser_error_t parser_init_context(parser_context_t *ctx,
                                    const uint8_t *buffer,
-                                   uint16_t bufferSize) {
+                                   size_t bufferSize) {
     ctx->offset = 0;
     ctx->buffer = NULL;
     ctx->bufferLen = 0;
+    ctx->tx_obj = NULL;
+    ctx->cache = NULL;
+    ctx->addressMemo = NULL;
 
     if (bufferSize == 0 || buffer == NULL) {
         // Not available, use defaults
         return parser_init_context_empty;
     }
 
+    // Larger buffers cannot be referenced by parser_size_t offsets (only on devices)
+    if (bufferSize > PARSER_SIZE_MAX) {
+        return parser_context_unexpected_size;
+    }
+
     ctx->buffer = buffer;
-    ctx->bufferLen = bufferSize;
+    ctx->bufferLen = (parser_size_t) bufferSize;
     return parser_ok;
 }
 
-parser_error_t parser_init(parser_context_t *ctx, const uint8_t *buffer, uint16_t bufferSize) {
+parser_error_t parser_init(parser_context_t *ctx, const uint8_t *buffer, size_t bufferSize) {
     CHECK_PARSER_ERR(parser_init_context(ctx, buffer, bufferSize))
     return parser_ok;
 }
@@ -127,26 +136,68 @@ const char *parser_getErrorDescription(parser_error_t err) {
             return "Required field nonce";
         case parser_required_method:
             return "Required field method";
+            // Streaming sign
+        case parser_stream_not_needed:
+            return "Message fits sign buffer";
         default:
             return "Unrecognized error code";
     }
 }
 
-__Z_INLINE parser_error_t readAddress(address_t *address, CborValue *value) {
+// Locates the payload of a byte string inside the parsed buffer without copying it.
+// Errors match those of cbor_value_copy_byte_string into a buffer of maxLen bytes.
+// Strings split in several chunks are not contiguous, so they are rejected.
+__Z_INLINE parser_error_t readByteStringView(const parser_context_t *c, const CborValue *value,
+                                             size_t maxLen, buffer_view_t *view) {
+    PARSER_ASSERT_OR_ERROR(cbor_value_is_byte_string(value), parser_unexpected_type)
+
+    CborValue it = *value;
+    const uint8_t *data = NULL;
+    size_t dataLen = 0;
+    bool contiguous = true;
+
+    // Walking until the last chunk also checks the header of the next item
+    while (true) {
+        const void *chunk = NULL;
+        size_t chunkLen = 0;
+        CHECK_CBOR_MAP_ERR(get_string_chunk(&it, &chunk, &chunkLen))
+        if (chunk == NULL) {
+            break;
+        }
+        if (chunkLen == 0) {
+            continue;
+        }
+        if (data != NULL) {
+            contiguous = false;
+        }
+        data = chunk;
+        dataLen += chunkLen;
+    }
+
+    PARSER_ASSERT_OR_ERROR(dataLen <= maxLen, parser_cbor_unexpected)
+    PARSER_ASSERT_OR_ERROR(contiguous, parser_cbor_unexpected)
+
+    view->offset = data != NULL ? (parser_size_t) (data - c->buffer) : 0;
+    view->len = (parser_size_t) dataLen;
+    return parser_ok;
+}
+
+__Z_INLINE parser_error_t readAddress(const parser_context_t *c, address_t *address, CborValue *value) {
     CHECK_CBOR_TYPE(cbor_value_get_type(value), CborByteStringType)
 
-    CborValue dummy;
     MEMZERO(address, sizeof(address_t));
-    address->len = sizeof_field(address_t, buffer);
+    CHECK_PARSER_ERR(readByteStringView(c, value, MAX_ADDRESS_LEN, address))
 
-    PARSER_ASSERT_OR_ERROR(cbor_value_is_byte_string(value), parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_copy_byte_string(value, (uint8_t *) address->buffer, &address->len, &dummy))
+    return _checkAddress(c, address);
+}
 
+// Verify size and protocol of an address located in the buffer
+parser_error_t _checkAddress(const parser_context_t *c, const address_t *address) {
     // Addresses are at least 2 characters Protocol + random data
     PARSER_ASSERT_OR_ERROR(address->len > 1, parser_invalid_address)
 
     // Verify size and protocol
-    switch (address->buffer[0]) {
+    switch (c->buffer[address->offset]) {
         case ADDRESS_PROTOCOL_ID:
             // protocol 0
             PARSER_ASSERT_OR_ERROR(address->len - 1 < 21, parser_invalid_address)
@@ -170,16 +221,17 @@ __Z_INLINE parser_error_t readAddress(address_t *address, CborValue *value) {
     return parser_ok;
 }
 
-__Z_INLINE parser_error_t readBigInt(bigint_t *bigint, CborValue *value) {
+__Z_INLINE parser_error_t readBigInt(const parser_context_t *c, bigint_t *bigint, CborValue *value) {
     CHECK_CBOR_TYPE(cbor_value_get_type(value), CborByteStringType)
-    CborValue dummy;
 
     MEMZERO(bigint, sizeof(bigint_t));
-    bigint->len = sizeof_field(bigint_t, buffer);
+    CHECK_PARSER_ERR(readByteStringView(c, value, MAX_BIGINT_LEN, bigint))
 
-    PARSER_ASSERT_OR_ERROR(cbor_value_is_byte_string(value), parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_copy_byte_string(value, (uint8_t *) bigint->buffer, &bigint->len, &dummy))
+    return _checkBigInt(c, bigint);
+}
 
+// Only positive values (sign byte 0x00) are accepted
+parser_error_t _checkBigInt(const parser_context_t *c, const bigint_t *bigint) {
     // We have an empty value so value is default (zero)
     PARSER_ASSERT_OR_ERROR(bigint->len != 0, parser_ok)
 
@@ -187,93 +239,193 @@ __Z_INLINE parser_error_t readBigInt(bigint_t *bigint, CborValue *value) {
     PARSER_ASSERT_OR_ERROR(bigint->len > 1, parser_unexpected_value)
 
     // negative bigint, should be positive
-    PARSER_ASSERT_OR_ERROR(bigint->buffer[0] == 0x00, parser_unexpected_value)
+    PARSER_ASSERT_OR_ERROR(c->buffer[bigint->offset] == 0x00, parser_unexpected_value)
 
     return parser_ok;
 }
 
-parser_error_t printValue(const struct CborValue *value,
+// Number of characters a string param is shown with: two per byte for byte strings (hex),
+// text strings up to their first NUL byte
+__Z_INLINE parser_error_t stringRenderedLen(const struct CborValue *value, size_t *renderedLen) {
+    const bool hex = cbor_value_is_byte_string(value);
+    CborValue it = *value;
+    bool terminated = false;
+    *renderedLen = 0;
+
+    // Strings may be split in chunks, they are walked in place
+    while (true) {
+        const void *chunk = NULL;
+        size_t chunkLen = 0;
+        CHECK_CBOR_MAP_ERR(get_string_chunk(&it, &chunk, &chunkLen))
+        if (chunk == NULL) {
+            break;
+        }
+        if (hex) {
+            *renderedLen += 2 * chunkLen;
+            continue;
+        }
+        if (!terminated) {
+            const uint8_t *nul = memchr(chunk, 0, chunkLen);
+            terminated = nul != NULL;
+            *renderedLen += terminated ? (size_t) (nul - (const uint8_t *) chunk) : chunkLen;
+        }
+    }
+
+    PARSER_ASSERT_OR_ERROR(*renderedLen <= MAX_PARAM_RENDERED_LEN, parser_value_out_of_range)
+    return parser_ok;
+}
+
+// Pages a string param straight from the message buffer, params can be as large as the message
+// so they are never copied or rendered as a whole. Pages match those of pageString.
+__Z_INLINE parser_error_t printStringPage(const struct CborValue *value, size_t renderedLen,
+                                          char *outVal, uint16_t outValLen,
+                                          uint8_t pageIdx, uint8_t *pageCount) {
+    const bool hex = cbor_value_is_byte_string(value);
+
+    page_slice_t slice;
+    PARSER_ASSERT_OR_ERROR(page_sliceInit(&slice, outVal, outValLen, renderedLen, pageIdx, pageCount),
+                           parser_display_page_out_of_range)
+
+    CborValue it = *value;
+    size_t chunkStart = 0;
+    while (chunkStart < slice.last) {
+        const void *chunk = NULL;
+        size_t chunkLen = 0;
+        CHECK_CBOR_MAP_ERR(get_string_chunk(&it, &chunk, &chunkLen))
+        if (chunk == NULL) {
+            break;
+        }
+
+        const uint8_t *data = chunk;
+        const size_t chunkEnd = chunkStart + (hex ? 2 * chunkLen : chunkLen);
+        if (!hex) {
+            page_slicePutString(&slice, chunkStart, (const char *) data, chunkLen);
+        } else {
+            // the part of this chunk's hex shown in the page
+            const size_t from = chunkStart > slice.first ? chunkStart : slice.first;
+            const size_t to = chunkEnd < slice.last ? chunkEnd : slice.last;
+            if (from < to) {
+                hex_encode_range(data, (uint32_t) (from - chunkStart), slice.out + (from - slice.first),
+                                 (uint32_t) (to - from));
+            }
+        }
+        chunkStart = chunkEnd;
+    }
+
+    return parser_ok;
+}
+
+parser_error_t printValue(const parser_context_t *c, const struct CborValue *value,
                           char *outVal, uint16_t outValLen,
                           uint8_t pageIdx, uint8_t *pageCount) {
-    uint8_t buff[200];
-    size_t buffLen = sizeof(buff);
-    MEMZERO(buff, sizeof(buff));
-
+    UNUSED(c);
     snprintf(outVal, outValLen, "-- EMPTY --");
 
     switch (value->type) {
-        case CborByteStringType: {
-            CHECK_CBOR_MAP_ERR(cbor_value_copy_byte_string(value, buff, &buffLen, NULL /* next */))
+        case CborByteStringType:
+        case CborTextStringType: {
+            size_t renderedLen = 0;
+            CHECK_PARSER_ERR(stringRenderedLen(value, &renderedLen))
             CHECK_APP_CANARY()
 
-            if (buffLen > 0) {
-                char hexStr[401];
-                MEMZERO(hexStr, sizeof(hexStr));
-                size_t count = array_to_hexstr(hexStr, sizeof(hexStr), buff, buffLen);
-                PARSER_ASSERT_OR_ERROR(count == buffLen * 2, parser_value_out_of_range)
-                CHECK_APP_CANARY()
-
-                pageString(outVal, outValLen, hexStr, pageIdx, pageCount);
+            // empty byte strings keep the placeholder
+            if (renderedLen > 0 || value->type == CborTextStringType) {
+                CHECK_PARSER_ERR(printStringPage(value, renderedLen, outVal, outValLen, pageIdx, pageCount))
                 CHECK_APP_CANARY()
             }
             break;
         }
-        case CborTextStringType: {
-            CHECK_CBOR_MAP_ERR(cbor_value_copy_text_string(value, (char *) buff, &buffLen, NULL /* next */))
-            CHECK_APP_CANARY()
+        case CborIntegerType: {
+            int64_t paramValue = 0;
+            CHECK_CBOR_MAP_ERR(cbor_value_get_int64_checked(value, &paramValue))
+            int64_to_decimal(outVal, outValLen, paramValue);
+            break;
+        }
+        default:
+            snprintf(outVal, outValLen, "Type: %d", value->type);
+    }
+    return parser_ok;
+}
 
-            if (buffLen >= 0) {
-                pageString(outVal, outValLen, (char *) buff, pageIdx, pageCount);
-            }
+// Same checks as printValue, without producing any text
+__Z_INLINE parser_error_t checkValue(const struct CborValue *value) {
+    switch (value->type) {
+        case CborByteStringType:
+        case CborTextStringType: {
+            size_t renderedLen = 0;
+            CHECK_PARSER_ERR(stringRenderedLen(value, &renderedLen))
             break;
         }
         case CborIntegerType: {
             int64_t paramValue = 0;
             CHECK_CBOR_MAP_ERR(cbor_value_get_int64_checked(value, &paramValue))
-            int64_to_str(outVal, outValLen, paramValue);
             break;
         }
         default:
-            snprintf(outVal, outValLen, "Type: %d", value->type);
+            break;
     }
     return parser_ok;
 }
 
-parser_error_t _printParam(const parser_tx_t *tx, uint8_t paramIdx,
+__Z_INLINE uint8_t paramsIndexStride(uint8_t numparams) {
+    if (numparams <= MAX_PARAMS_INDEX) {
+        return 1;
+    }
+    return (numparams + MAX_PARAMS_INDEX - 1) / MAX_PARAMS_INDEX;
+}
+
+parser_error_t _printParam(const parser_context_t *c, uint8_t paramIdx,
                            char *outVal, uint16_t outValLen,
                            uint8_t pageIdx, uint8_t *pageCount) {
     CHECK_APP_CANARY()
+    const parser_tx_t *tx = c->tx_obj;
 
     if (paramIdx >= tx->numparams) {
         return parser_value_out_of_range;
     }
 
+    // Jump to the closest indexed param. Params were already walked by readMethod
+    const uint8_t stride = paramsIndexStride(tx->numparams);
+    const uint8_t *paramsEnd = c->buffer + tx->params.offset + tx->params.len;
+    const uint8_t *ptr = c->buffer + tx->paramsIndex[paramIdx / stride];
+
     CborParser parser;
-    CborValue itContainer;
-    CHECK_CBOR_MAP_ERR(cbor_parser_init(tx->params, MAX_PARAMS_BUFFER_SIZE, 0, &parser, &itContainer))
+    CborValue itParam;
+    CHECK_CBOR_MAP_ERR(cbor_parser_init(ptr, paramsEnd - ptr, 0, &parser, &itParam))
     CHECK_APP_CANARY()
 
-    CborValue itParams = itContainer;
-
-    /// Enter container?
-    if (itContainer.type == CborMapType || itContainer.type == CborArrayType) {
-        CHECK_CBOR_MAP_ERR(cbor_value_enter_container(&itContainer, &itParams))
+    // Each param is read as a top-level item, so skipping one means restarting after it
+    for (uint8_t i = 0; i < paramIdx % stride; ++i) {
+        CHECK_CBOR_MAP_ERR(cbor_value_advance(&itParam))
+        ptr = itParam.ptr;
+        CHECK_CBOR_MAP_ERR(cbor_parser_init(ptr, paramsEnd - ptr, 0, &parser, &itParam))
         CHECK_APP_CANARY()
-        for (uint8_t i = 0; i < paramIdx; ++i) {
-            CHECK_CBOR_MAP_ERR(cbor_value_advance(&itParams))
-            CHECK_APP_CANARY()
-        }
     }
 
-    CHECK_PARSER_ERR(printValue(&itParams, outVal, outValLen, pageIdx, pageCount))
+    return printValue(c, &itParam, outVal, outValLen, pageIdx, pageCount);
+}
+
+parser_error_t _checkParams(const parser_context_t *c) {
+    const parser_tx_t *tx = c->tx_obj;
+    if (tx->numparams == 0) {
+        return parser_ok;
+    }
+
+    const uint8_t *paramsEnd = c->buffer + tx->params.offset + tx->params.len;
+    const uint8_t *ptr = c->buffer + tx->paramsIndex[0];
 
-    /// Leave container
-    if (itContainer.type == CborMapType || itContainer.type == CborArrayType) {
-        while (!cbor_value_at_end(&itParams)) {
-            CHECK_CBOR_MAP_ERR(cbor_value_advance(&itParams))
+    CborParser parser;
+    CborValue itParam;
+    CHECK_CBOR_MAP_ERR(cbor_parser_init(ptr, paramsEnd - ptr, 0, &parser, &itParam))
+
+    // Params are visited in order, reading each one as a top-level item like _printParam does
+    for (uint8_t i = 0; i < tx->numparams; ++i) {
+        if (i > 0) {
+            CHECK_CBOR_MAP_ERR(cbor_value_advance(&itParam))
+            ptr = itParam.ptr;
+            CHECK_CBOR_MAP_ERR(cbor_parser_init(ptr, paramsEnd - ptr, 0, &parser, &itParam))
         }
-        CHECK_CBOR_MAP_ERR(cbor_value_leave_container(&itContainer, &itParams))
-        CHECK_APP_CANARY()
+        CHECK_PARSER_ERR(checkValue(&itParam))
     }
 
     return parser_ok;
@@ -287,14 +439,15 @@ parser_error_t checkMethod(uint64_t methodValue) {
     return parser_unexpected_method;
 }
 
-__Z_INLINE parser_error_t readMethod(parser_tx_t *tx, CborValue *value) {
+__Z_INLINE parser_error_t readMethod(const parser_context_t *c, parser_tx_t *tx, CborValue *value) {
 
     uint64_t methodValue;
     PARSER_ASSERT_OR_ERROR(cbor_value_is_unsigned_integer(value), parser_unexpected_type)
     CHECK_CBOR_MAP_ERR(cbor_value_get_uint64(value, &methodValue))
 
     tx->numparams = 0;
-    MEMZERO(tx->params, sizeof(tx->params));
+    MEMZERO(&tx->params, sizeof(tx->params));
+    MEMZERO(tx->paramsIndex, sizeof(tx->paramsIndex));
 
     CHECK_PARSER_ERR(checkMethod(methodValue))
 
@@ -315,7 +468,7 @@ __Z_INLINE parser_error_t readMethod(parser_tx_t *tx, CborValue *value) {
         return parser_ok;
     }
 
-    // This area reads the entire params byte string (if present) into the txn->params
+    // This area locates the entire params byte string (if present) in txn->params
     // and sets txn->numparams to the number of params within cbor container
     // Parsing of the individual params is deferred until the display stage
 
@@ -327,121 +480,198 @@ __Z_INLINE parser_error_t readMethod(parser_tx_t *tx, CborValue *value) {
 
     size_t paramsBufferSize = 0;
     CHECK_CBOR_MAP_ERR(cbor_value_get_string_length(value, &paramsBufferSize))
-    PARSER_ASSERT_OR_ERROR(paramsBufferSize <= sizeof(tx->params), parser_unexpected_number_items)
+    PARSER_ASSERT_OR_ERROR(paramsBufferSize <= MAX_PARAMS_BUFFER_SIZE, parser_unexpected_number_items)
 
     // short-circuit if there are no params
     if (paramsBufferSize != 0) {
-        size_t paramsLen = sizeof(tx->params);
-        CHECK_CBOR_MAP_ERR(cbor_value_copy_byte_string(value, tx->params, &paramsLen, NULL /* next */))
-        PARSER_ASSERT_OR_ERROR(paramsLen <= sizeof(tx->params), parser_unexpected_value)
-        PARSER_ASSERT_OR_ERROR(paramsLen == paramsBufferSize, parser_unexpected_number_items)
-
-        CborParser parser;
-        CborValue itParams;
-        CHECK_CBOR_MAP_ERR(cbor_parser_init(tx->params, paramsLen, 0, &parser, &itParams))
-
-        switch (itParams.type) {
-            case CborArrayType: {
-                size_t arrayLength = 0;
-                CHECK_CBOR_MAP_ERR(cbor_value_get_array_length(&itParams, &arrayLength))
-                PARSER_ASSERT_OR_ERROR(arrayLength < UINT8_MAX, parser_value_out_of_range)
-                tx->numparams = arrayLength;
-                break;
-            }
-            case CborMapType: {
-                size_t mapLength = 0;
-                CHECK_CBOR_MAP_ERR(cbor_value_get_map_length(&itParams, &mapLength))
-                PARSER_ASSERT_OR_ERROR(mapLength < UINT8_MAX, parser_value_out_of_range)
-                tx->numparams = mapLength;
-                break;
-            }
-            case CborInvalidType:
-            default:
-                return parser_unexpected_type;
-        }
+        CHECK_PARSER_ERR(readByteStringView(c, value, MAX_PARAMS_BUFFER_SIZE, &tx->params))
+        PARSER_ASSERT_OR_ERROR(tx->params.len == paramsBufferSize, parser_unexpected_number_items)
+        CHECK_PARSER_ERR(_readParams(c, tx))
     }
     tx->method = methodValue;
 
     return parser_ok;
 }
 
-parser_error_t _read(const parser_context_t *c, parser_tx_t *v) {
-    CborValue it;
-    INIT_CBOR_PARSER(c, it)
-    PARSER_ASSERT_OR_ERROR(!cbor_value_at_end(&it), parser_unexpected_buffer_end)
+// Number of bytes taken by the header (initial byte and length) of a definite length string
+__Z_INLINE parser_size_t stringHeaderLen(const CborValue *value) {
+    const uint8_t additionalInfo = *value->ptr & 0x1F;
+    if (additionalInfo < 24) {
+        return 1;
+    }
+    return 1 + (1 << (additionalInfo - 24));
+}
+
+parser_error_t _readMethodHeader(const parser_context_t *c, parser_tx_t *tx, CborValue *value,
+                                 parser_size_t *paramsOffset, uint64_t *paramsLen) {
+    uint64_t methodValue;
+    PARSER_ASSERT_OR_ERROR(cbor_value_is_unsigned_integer(value), parser_unexpected_type)
+    CHECK_CBOR_MAP_ERR(cbor_value_get_uint64(value, &methodValue))
+
+    tx->numparams = 0;
+    MEMZERO(&tx->params, sizeof(tx->params));
+    MEMZERO(tx->paramsIndex, sizeof(tx->paramsIndex));
+
+    CHECK_PARSER_ERR(checkMethod(methodValue))
+
+    PARSER_ASSERT_OR_ERROR(cbor_value_is_valid(value), parser_unexpected_type)
+    CHECK_CBOR_MAP_ERR(cbor_value_advance(value))
+    CHECK_CBOR_TYPE(value->type, CborByteStringType)
+
+    // Only the string header has to be in the buffer. Strings split in several chunks are
+    // rejected, as readByteStringView does
+    PARSER_ASSERT_OR_ERROR(cbor_value_is_length_known(value), parser_cbor_unexpected)
+    size_t paramsBufferSize = 0;
+    CHECK_CBOR_MAP_ERR(cbor_value_get_string_length(value, &paramsBufferSize))
+
+    // method0 should have zero arguments
+    PARSER_ASSERT_OR_ERROR(methodValue != 0 || paramsBufferSize == 0, parser_unexpected_number_items)
+
+    tx->method = methodValue;
+    *paramsOffset = (parser_size_t) (value->ptr - c->buffer) + stringHeaderLen(value);
+    *paramsLen = paramsBufferSize;
+    return parser_ok;
+}
+
+// Counts and indexes the params located in tx->params
+parser_error_t _readParams(const parser_context_t *c, parser_tx_t *tx) {
+    CborParser parser;
+    CborValue itParams;
+    CHECK_CBOR_MAP_ERR(cbor_parser_init(c->buffer + tx->params.offset, tx->params.len, 0, &parser, &itParams))
+
+    switch (itParams.type) {
+        case CborArrayType: {
+            size_t arrayLength = 0;
+            CHECK_CBOR_MAP_ERR(cbor_value_get_array_length(&itParams, &arrayLength))
+            PARSER_ASSERT_OR_ERROR(arrayLength <= MAX_PARAMS_COUNT, parser_value_out_of_range)
+            tx->numparams = arrayLength;
+            break;
+        }
+        case CborMapType: {
+            size_t mapLength = 0;
+            CHECK_CBOR_MAP_ERR(cbor_value_get_map_length(&itParams, &mapLength))
+            PARSER_ASSERT_OR_ERROR(mapLength <= MAX_PARAMS_COUNT, parser_value_out_of_range)
+            tx->numparams = mapLength;
+            break;
+        }
+        case CborInvalidType:
+        default:
+            return parser_unexpected_type;
+    }
+
+    // Walk the container once and index the top-level items so that rendering does not
+    // have to. Map keys and values are separate items, only the first numparams are shown
+    const uint8_t stride = paramsIndexStride(tx->numparams);
+    CborValue itContainer;
+    CHECK_CBOR_MAP_ERR(cbor_value_enter_container(&itParams, &itContainer))
+    for (uint16_t i = 0; !cbor_value_at_end(&itContainer); i++) {
+        if (i < tx->numparams && i % stride == 0) {
+            tx->paramsIndex[i / stride] = (parser_size_t) (itContainer.ptr - c->buffer);
+        }
+        CHECK_CBOR_MAP_ERR(cbor_value_advance(&itContainer))
+    }
+    CHECK_CBOR_MAP_ERR(cbor_value_leave_container(&itParams, &itContainer))
+
+    return parser_ok;
+}
+
+parser_error_t _readStart(const parser_context_t *c, CborParser *parser, CborValue *it, CborValue *arrayContainer) {
+    CHECK_CBOR_MAP_ERR(cbor_parser_init(c->buffer + c->offset, c->bufferLen - c->offset, 0, parser, it))
+    PARSER_ASSERT_OR_ERROR(!cbor_value_at_end(it), parser_unexpected_buffer_end)
 
     // It is an array
-    PARSER_ASSERT_OR_ERROR(cbor_value_is_array(&it), parser_unexpected_type)
+    PARSER_ASSERT_OR_ERROR(cbor_value_is_array(it), parser_unexpected_type)
     size_t arraySize;
-    CHECK_CBOR_MAP_ERR(cbor_value_get_array_length(&it, &arraySize))
+    CHECK_CBOR_MAP_ERR(cbor_value_get_array_length(it, &arraySize))
 
     // Depends if we have params or not
     PARSER_ASSERT_OR_ERROR(arraySize == 10 || arraySize == 9, parser_unexpected_number_items)
 
-    CborValue arrayContainer;
-    PARSER_ASSERT_OR_ERROR(cbor_value_is_container(&it), parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_enter_container(&it, &arrayContainer))
+    PARSER_ASSERT_OR_ERROR(cbor_value_is_container(it), parser_unexpected_type)
+    CHECK_CBOR_MAP_ERR(cbor_value_enter_container(it, arrayContainer))
+
+    return parser_ok;
+}
+
+parser_error_t _readField(const parser_context_t *c, parser_tx_t *v, uint8_t field, CborValue *arrayContainer) {
+    switch (field) {
+        case tx_field_version:
+            PARSER_ASSERT_OR_ERROR(cbor_value_is_integer(arrayContainer), parser_unexpected_type)
+            CHECK_CBOR_MAP_ERR(cbor_value_get_int64_checked(arrayContainer, &v->version))
+            PARSER_ASSERT_OR_ERROR(arrayContainer->type != CborInvalidType, parser_unexpected_type)
+            CHECK_CBOR_MAP_ERR(cbor_value_advance(arrayContainer))
+
+            if (v->version != COIN_SUPPORTED_TX_VERSION) {
+                return parser_unexpected_tx_version;
+            }
+            return parser_ok;
+
+        case tx_field_to:
+            CHECK_PARSER_ERR(readAddress(c, &v->to, arrayContainer))
+            break;
+
+        case tx_field_from:
+            CHECK_PARSER_ERR(readAddress(c, &v->from, arrayContainer))
+            break;
+
+        case tx_field_nonce:
+            PARSER_ASSERT_OR_ERROR(cbor_value_is_unsigned_integer(arrayContainer), parser_unexpected_type)
+            CHECK_CBOR_MAP_ERR(cbor_value_get_uint64(arrayContainer, &v->nonce))
+            break;
+
+        case tx_field_value:
+            CHECK_PARSER_ERR(readBigInt(c, &v->value, arrayContainer))
+            break;
+
+        case tx_field_gaslimit:
+            PARSER_ASSERT_OR_ERROR(cbor_value_is_integer(arrayContainer), parser_unexpected_type)
+            CHECK_CBOR_MAP_ERR(cbor_value_get_int64_checked(arrayContainer, &v->gaslimit))
+            break;
+
+        case tx_field_gasfeecap:
+            CHECK_PARSER_ERR(readBigInt(c, &v->gasfeecap, arrayContainer))
+            break;
+
+        case tx_field_gaspremium:
+            CHECK_PARSER_ERR(readBigInt(c, &v->gaspremium, arrayContainer))
+            break;
 
-    // "version" field
-    PARSER_ASSERT_OR_ERROR(cbor_value_is_integer(&arrayContainer), parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_get_int64_checked(&arrayContainer, &v->version))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
+        case tx_field_method:
+            // also reads the params that follow the method
+            CHECK_PARSER_ERR(readMethod(c, v, arrayContainer))
+            break;
 
-    if (v->version != COIN_SUPPORTED_TX_VERSION) {
-        return parser_unexpected_tx_version;
+        default:
+            return parser_unexpected_field;
     }
 
-    // "to" field
-    CHECK_PARSER_ERR(readAddress(&v->to, &arrayContainer))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
-
-    // "from" field
-    CHECK_PARSER_ERR(readAddress(&v->from, &arrayContainer))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
-
-    // "nonce" field
-    PARSER_ASSERT_OR_ERROR(cbor_value_is_unsigned_integer(&arrayContainer), parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_get_uint64(&arrayContainer, &v->nonce))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
-
-    // "value" field
-    CHECK_PARSER_ERR(readBigInt(&v->value, &arrayContainer))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
-
-    // "gasLimit" field
-    PARSER_ASSERT_OR_ERROR(cbor_value_is_integer(&arrayContainer), parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_get_int64_checked(&arrayContainer, &v->gaslimit))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
-
-    // "gasFeeCap" field
-    CHECK_PARSER_ERR(readBigInt(&v->gasfeecap, &arrayContainer))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
-
-    // "gasPremium" field
-    CHECK_PARSER_ERR(readBigInt(&v->gaspremium, &arrayContainer))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
-
-    // "method" field
-    CHECK_PARSER_ERR(readMethod(v, &arrayContainer))
-    PARSER_ASSERT_OR_ERROR(arrayContainer.type != CborInvalidType, parser_unexpected_type)
-    CHECK_CBOR_MAP_ERR(cbor_value_advance(&arrayContainer))
-
-    CHECK_CBOR_MAP_ERR(cbor_value_leave_container(&it, &arrayContainer))
+    PARSER_ASSERT_OR_ERROR(arrayContainer->type != CborInvalidType, parser_unexpected_type)
+    CHECK_CBOR_MAP_ERR(cbor_value_advance(arrayContainer))
+    return parser_ok;
+}
+
+parser_error_t _readEnd(const parser_context_t *c, CborValue *it, CborValue *arrayContainer) {
+    CHECK_CBOR_MAP_ERR(cbor_value_leave_container(it, arrayContainer))
 
     // End of buffer does not match end of parsed data
-    PARSER_ASSERT_OR_ERROR(it.ptr == c->buffer + c->bufferLen, parser_cbor_unexpected_EOF)
+    PARSER_ASSERT_OR_ERROR(it->ptr == c->buffer + c->bufferLen, parser_cbor_unexpected_EOF)
 
     return parser_ok;
 }
 
+parser_error_t _read(const parser_context_t *c, parser_tx_t *v) {
+    CborParser parser;
+    CborValue it;
+    CborValue arrayContainer;
+    CHECK_PARSER_ERR(_readStart(c, &parser, &it, &arrayContainer))
+
+    for (uint8_t field = 0; field < tx_field_count; field++) {
+        CHECK_PARSER_ERR(_readField(c, v, field, &arrayContainer))
+    }
+
+    return _readEnd(c, &it, &arrayContainer);
+}
+
 parser_error_t _validateTx(const parser_context_t *c, const parser_tx_t *v) {
     (void) c;
     (void) v;
@@ -18,6 +18,7 @@
 #include "parser_common.h"
 #include "parser_txdef.h"
 #include "crypto.h"
+#include "cbor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,15 +26,58 @@ extern "C" {
 
 extern parser_tx_t parser_tx_obj;
 
-parser_error_t parser_init(parser_context_t *ctx, const uint8_t *buffer, uint16_t bufferSize);
+parser_error_t parser_init(parser_context_t *ctx, const uint8_t *buffer, size_t bufferSize);
+
+// Message fields in the order they are read
+typedef enum {
+    tx_field_version = 0,
+    tx_field_to,
+    tx_field_from,
+    tx_field_nonce,
+    tx_field_value,
+    tx_field_gaslimit,
+    tx_field_gasfeecap,
+    tx_field_gaspremium,
+    // method and params
+    tx_field_method,
+    tx_field_count
+} tx_field_e;
 
 parser_error_t _read(const parser_context_t *c, parser_tx_t *v);
 
+// _read split in steps, so that a message can also be read as it arrives (see parser_stream.h)
+parser_error_t _readStart(const parser_context_t *c, CborParser *parser, CborValue *it, CborValue *arrayContainer);
+
+parser_error_t _readField(const parser_context_t *c, parser_tx_t *v, uint8_t field, CborValue *arrayContainer);
+
+parser_error_t _readEnd(const parser_context_t *c, CborValue *it, CborValue *arrayContainer);
+
+// Reads the method and the header of the params byte string that follows it, the params themselves
+// do not have to be in the buffer (see parser_bounded.h). tx->params is left empty
+// paramsOffset receives the offset of the params payload, which may be past the end of the buffer
+parser_error_t _readMethodHeader(const parser_context_t *c, parser_tx_t *tx, CborValue *value,
+                                 parser_size_t *paramsOffset, uint64_t *paramsLen);
+
+parser_error_t _checkAddress(const parser_context_t *c, const address_t *address);
+
+parser_error_t _checkBigInt(const parser_context_t *c, const bigint_t *bigint);
+
+parser_error_t _readParams(const parser_context_t *c, parser_tx_t *tx);
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+// Decoder specialized for the message layout, see parser_schema.c
+// Returns false when the message is not accepted as is, it then has to be read with _read
+bool _readSchema(const parser_context_t *c, parser_tx_t *v);
+#endif
+
 parser_error_t _validateTx(const parser_context_t *c, const parser_tx_t *v);
 
-parser_error_t _printParam(const parser_tx_t *tx, uint8_t paramIdx,
+parser_error_t _printParam(const parser_context_t *c, uint8_t paramIdx,
                            char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount);
 
+// Checks that every param can be shown, without rendering them
+parser_error_t _checkParams(const parser_context_t *c);
+
 uint8_t _getNumItems(const parser_context_t *c, const parser_tx_t *v);
 
 parser_error_t checkMethod(uint64_t methodValue);
@@ -0,0 +1,183 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX)
+
+#include "parser_impl.h"
+#include "parser_txdef.h"
+#include "coin.h"
+#include <zxmacros.h>
+
+// Messages are always [version, to, from, nonce, value, gaslimit, gasfeecap, gaspremium, method, params],
+// so instead of going through the generic tinycbor iterator, headers are read straight from the buffer
+// and checked against the type each position must have.
+//
+// Only messages that tinycbor would accept are decoded here. Anything else (errors, indefinite lengths,
+// 9 item arrays, ...) makes _readSchema give up, and _read then reports the exact same error as before.
+// Params keep being read with tinycbor (_readParams), as their layout depends on the method.
+
+#define CBOR_MAJOR_UNSIGNED     0
+#define CBOR_MAJOR_NEGATIVE     1
+#define CBOR_MAJOR_BYTES        2
+#define CBOR_MAJOR_ARRAY        4
+
+#define CBOR_INFO_UINT8         24
+#define CBOR_INFO_UINT64        27
+
+#define TX_NUM_FIELDS           10
+
+typedef struct {
+    const uint8_t *buffer;
+    parser_size_t bufferLen;
+    parser_size_t offset;
+} schema_reader_t;
+
+// Reads the header of the next item. Indefinite lengths and reserved values are not supported
+__Z_INLINE bool schema_readHeader(schema_reader_t *r, uint8_t major, uint64_t *value) {
+    if (r->offset >= r->bufferLen) {
+        return false;
+    }
+
+    const uint8_t initial = r->buffer[r->offset];
+    const uint8_t info = initial & 0x1Fu;
+    if ((initial >> 5u) != major || info > CBOR_INFO_UINT64) {
+        return false;
+    }
+    r->offset++;
+
+    if (info < CBOR_INFO_UINT8) {
+        *value = info;
+        return true;
+    }
+
+    const uint8_t numBytes = (uint8_t) (1u << (info - CBOR_INFO_UINT8));
+    if (r->bufferLen - r->offset < numBytes) {
+        return false;
+    }
+
+    *value = 0;
+    for (uint8_t i = 0; i < numBytes; i++) {
+        *value = (*value << 8u) | r->buffer[r->offset++];
+    }
+    return true;
+}
+
+__Z_INLINE bool schema_readUnsigned(schema_reader_t *r, uint64_t *value) {
+    return schema_readHeader(r, CBOR_MAJOR_UNSIGNED, value);
+}
+
+__Z_INLINE bool schema_readInt64(schema_reader_t *r, int64_t *value) {
+    uint64_t tmp = 0;
+    if (schema_readHeader(r, CBOR_MAJOR_UNSIGNED, &tmp)) {
+        if (tmp > INT64_MAX) {
+            return false;
+        }
+        *value = (int64_t) tmp;
+        return true;
+    }
+
+    if (schema_readHeader(r, CBOR_MAJOR_NEGATIVE, &tmp)) {
+        if (tmp > INT64_MAX) {
+            return false;
+        }
+        *value = -1 - (int64_t) tmp;
+        return true;
+    }
+
+    return false;
+}
+
+// Same view readByteStringView would return for a string sent as a single chunk
+__Z_INLINE bool schema_readBytes(schema_reader_t *r, parser_size_t maxLen, buffer_view_t *view) {
+    uint64_t len = 0;
+    if (!schema_readHeader(r, CBOR_MAJOR_BYTES, &len)) {
+        return false;
+    }
+    if (len > maxLen || len > (uint64_t) (r->bufferLen - r->offset)) {
+        return false;
+    }
+
+    view->offset = len > 0 ? r->offset : 0;
+    view->len = (parser_size_t) len;
+    r->offset += (parser_size_t) len;
+    return true;
+}
+
+__Z_INLINE bool schema_readAddress(const parser_context_t *c, schema_reader_t *r, address_t *address) {
+    return schema_readBytes(r, MAX_ADDRESS_LEN, address) && _checkAddress(c, address) == parser_ok;
+}
+
+__Z_INLINE bool schema_readBigInt(const parser_context_t *c, schema_reader_t *r, bigint_t *bigint) {
+    return schema_readBytes(r, MAX_BIGINT_LEN, bigint) && _checkBigInt(c, bigint) == parser_ok;
+}
+
+__Z_INLINE bool schema_readMethod(const parser_context_t *c, schema_reader_t *r, parser_tx_t *tx) {
+    if (!schema_readUnsigned(r, &tx->method) || checkMethod(tx->method) != parser_ok) {
+        return false;
+    }
+
+    buffer_view_t params;
+    if (!schema_readBytes(r, MAX_PARAMS_BUFFER_SIZE, &params)) {
+        return false;
+    }
+
+    // method0 should have zero arguments
+    if (params.len == 0) {
+        return true;
+    }
+    if (tx->method == 0) {
+        return false;
+    }
+
+    tx->params = params;
+    return _readParams(c, tx) == parser_ok;
+}
+
+bool _readSchema(const parser_context_t *c, parser_tx_t *v) {
+    schema_reader_t r = {
+            .buffer = c->buffer,
+            .bufferLen = c->bufferLen,
+            .offset = c->offset,
+    };
+
+    // Nothing is written to v unless the whole message is accepted
+    parser_tx_t tx;
+    MEMZERO(&tx, sizeof(tx));
+
+    uint64_t numFields = 0;
+    uint64_t version = 0;
+    const bool ok = schema_readHeader(&r, CBOR_MAJOR_ARRAY, &numFields) && numFields == TX_NUM_FIELDS &&
+                    schema_readUnsigned(&r, &version) && version == COIN_SUPPORTED_TX_VERSION &&
+                    schema_readAddress(c, &r, &tx.to) &&
+                    schema_readAddress(c, &r, &tx.from) &&
+                    schema_readUnsigned(&r, &tx.nonce) &&
+                    schema_readBigInt(c, &r, &tx.value) &&
+                    schema_readInt64(&r, &tx.gaslimit) &&
+                    schema_readBigInt(c, &r, &tx.gasfeecap) &&
+                    schema_readBigInt(c, &r, &tx.gaspremium) &&
+                    schema_readMethod(c, &r, &tx) &&
+                    r.offset == c->bufferLen;
+
+    if (!ok) {
+        return false;
+    }
+
+    tx.version = (int64_t) version;
+    MEMCPY(v, &tx, sizeof(tx));
+    return true;
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "parser_stream.h"
+#include "parser_impl.h"
+#include <zxmacros.h>
+
+void parser_stream_init(parser_stream_t *stream, parser_tx_t *tx_obj) {
+    MEMZERO(stream, sizeof(parser_stream_t));
+    stream->tx_obj = tx_obj;
+    stream->step = PARSER_STREAM_STEP_START;
+    stream->error = parser_ok;
+}
+
+__Z_INLINE void stream_rebase(parser_stream_t *stream, const uint8_t *buffer, parser_size_t bufferLen) {
+    stream->parser.end = buffer + bufferLen;
+    stream->it.ptr = buffer + stream->itOffset;
+    stream->arrayContainer.ptr = buffer + stream->arrayContainerOffset;
+}
+
+static parser_error_t stream_readFields(parser_stream_t *stream, const parser_context_t *c) {
+    if (stream->step == PARSER_STREAM_STEP_START) {
+        CHECK_PARSER_ERR(_readStart(c, &stream->parser, &stream->it, &stream->arrayContainer))
+        stream->step = tx_field_version;
+    }
+
+    while (stream->step < tx_field_count) {
+        // A field that is not complete yet fails with EOF and is read again from the start on the next update
+        CborValue field = stream->arrayContainer;
+        CHECK_PARSER_ERR(_readField(c, stream->tx_obj, stream->step, &field))
+        stream->arrayContainer = field;
+        stream->step++;
+    }
+
+    return parser_ok;
+}
+
+static parser_error_t stream_read(parser_stream_t *stream, const parser_context_t *c) {
+    if (stream->step != PARSER_STREAM_STEP_START) {
+        stream_rebase(stream, c->buffer, c->bufferLen);
+    }
+
+    const parser_error_t err = stream_readFields(stream, c);
+
+    if (stream->step != PARSER_STREAM_STEP_START) {
+        stream->itOffset = (parser_size_t) (stream->it.ptr - c->buffer);
+        stream->arrayContainerOffset = (parser_size_t) (stream->arrayContainer.ptr - c->buffer);
+    }
+    return err;
+}
+
+parser_error_t parser_stream_update(parser_stream_t *stream, const uint8_t *buffer, parser_size_t bufferLen) {
+    if (stream->tx_obj == NULL) {
+        return parser_init_context_empty;
+    }
+    if (stream->error != parser_ok) {
+        return stream->error;
+    }
+
+    parser_context_t c;
+    if (parser_init(&c, buffer, bufferLen) != parser_ok) {
+        // nothing received yet
+        return parser_ok;
+    }
+    c.tx_obj = stream->tx_obj;
+
+    const parser_error_t err = stream_read(stream, &c);
+
+    // Running out of data only means the current field has not been fully received.
+    // Any other error does not depend on the bytes that are still missing, so it is final.
+    if (err == parser_cbor_unexpected_EOF) {
+        return parser_ok;
+    }
+
+    stream->error = err;
+    return err;
+}
+
+parser_error_t parser_stream_finish(parser_stream_t *stream, parser_context_t *ctx,
+                                    const uint8_t *buffer, parser_size_t bufferLen) {
+    if (stream->tx_obj == NULL) {
+        return parser_init_context_empty;
+    }
+
+    CHECK_PARSER_ERR(parser_init(ctx, buffer, bufferLen))
+    ctx->tx_obj = stream->tx_obj;
+
+    if (stream->error != parser_ok) {
+        return stream->error;
+    }
+
+    stream->error = stream_read(stream, ctx);
+    CHECK_PARSER_ERR(stream->error)
+
+    stream->error = _readEnd(ctx, &stream->it, &stream->arrayContainer);
+    return stream->error;
+}
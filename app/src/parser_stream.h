@@ -0,0 +1,64 @@
+/*******************************************************************************
+*  (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "parser_common.h"
+#include "cbor.h"
+
+#define PARSER_STREAM_STEP_START    0xFF
+
+// Reads a message while it is being received: every field is checked as soon as it is complete.
+// Positions are kept as offsets because the receive buffer may move between updates.
+// The struct must not be moved while in use, the iterators reference its parser.
+typedef struct {
+    parser_tx_t *tx_obj;
+
+    CborParser parser;
+    CborValue it;
+    CborValue arrayContainer;
+    parser_size_t itOffset;
+    parser_size_t arrayContainerOffset;
+
+    // next tx_field_e to read, PARSER_STREAM_STEP_START until the message header has been read
+    uint8_t step;
+    parser_error_t error;
+} parser_stream_t;
+
+/// Starts reading a new message
+/// \param stream stream state
+/// \param tx_obj caller-owned storage for the parsed transaction
+void parser_stream_init(parser_stream_t *stream, parser_tx_t *tx_obj);
+
+/// Reads the fields that are complete in the data received so far
+/// \param buffer every byte received since parser_stream_init, it may be at a different address on each call
+/// \param bufferLen number of bytes received so far
+/// \return parser_ok if no error was found yet, otherwise the error parser_parse_r would report for the message
+parser_error_t parser_stream_update(parser_stream_t *stream, const uint8_t *buffer, parser_size_t bufferLen);
+
+/// Reads what is left once the whole message has been received
+/// On return, ctx is in the same state parser_parse_r(ctx, buffer, bufferLen, tx_obj) would leave it
+parser_error_t parser_stream_finish(parser_stream_t *stream, parser_context_t *ctx,
+                                    const uint8_t *buffer, parser_size_t bufferLen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,24 +27,46 @@ extern "C" {
 #include <stdint.h>
 #include <stddef.h>
 
+// Lengths and offsets within the parsed buffer. Devices never hold more than FLASH_BUFFER_SIZE (tx.c) bytes,
+// the host library parses messages of any size
+#if defined(TARGET_NANOS) || defined(TARGET_NANOX)
+typedef uint16_t parser_size_t;
+#define PARSER_SIZE_MAX         UINT16_MAX
+#else
+typedef size_t parser_size_t;
+#define PARSER_SIZE_MAX         SIZE_MAX
+#endif
+
 #define MAX_SUPPORT_METHOD      50
-#define MAX_PARAMS_BUFFER_SIZE  200
+// Params are read in place, so they are only bounded by the size of the message buffer
+// (FLASH_BUFFER_SIZE in tx.c)
+#define MAX_PARAMS_BUFFER_SIZE  PARSER_SIZE_MAX
+// Display indexes are uint8_t and the first 8 items are the message fields
+#define MAX_PARAMS_COUNT        (UINT8_MAX - 8)
+// Longest param string (in characters) that can be shown. 255 pages of the smallest screen buffer (Nano S)
+#define MAX_PARAM_RENDERED_LEN  8192
+// Offsets of up to this many top-level params are kept after parsing. With more params,
+// one every ceil(numparams / MAX_PARAMS_INDEX) is kept and the few in between are skipped
+#define MAX_PARAMS_INDEX        32
+
 
+// Parsed fields are not copied: they reference a range of the parsed buffer (parser_context_t.buffer),
+// which must stay valid for as long as the parsed transaction is used
+typedef struct {
+    parser_size_t offset;
+    parser_size_t len;
+} buffer_view_t;
 
 // https://github.com/filecoin-project/lotus/blob/65c669b0f2dfd8c28b96755e198b9cdaf0880df8/chain/address/address.go#L36
 // https://github.com/filecoin-project/lotus/blob/65c669b0f2dfd8c28b96755e198b9cdaf0880df8/chain/address/address.go#L371-L373
 // Should not be more than 64 bytes
-typedef struct {
-    uint8_t buffer[64];
-    size_t len;
-} address_t;
+#define MAX_ADDRESS_LEN         64
+typedef buffer_view_t address_t;
 
 // https://github.com/filecoin-project/lotus/blob/3fda442bb3372c9055ec0e237c70dd30143b65d8/chain/types/bigint.go#L238-L240
-typedef struct {
-    // https://github.com/filecoin-project/lotus/blob/3fda442bb3372c9055ec0e237c70dd30143b65d8/chain/types/bigint.go#L17
-    uint8_t buffer[129];
-    size_t len;
-} bigint_t;
+// https://github.com/filecoin-project/lotus/blob/3fda442bb3372c9055ec0e237c70dd30143b65d8/chain/types/bigint.go#L17
+#define MAX_BIGINT_LEN          129
+typedef buffer_view_t bigint_t;
 
 // https://github.com/filecoin-project/lotus/blob/eb4f4675a5a765e4898ec6b005ba2e80da8e7e1a/chain/types/message.go#L24-L39
 typedef struct {
@@ -59,7 +81,8 @@ typedef struct {
     uint64_t method;
 
     uint8_t numparams;
-    uint8_t params[MAX_PARAMS_BUFFER_SIZE];
+    buffer_view_t params;
+    parser_size_t paramsIndex[MAX_PARAMS_INDEX];
 } parser_tx_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,99 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Base32 encoding of address payloads: the bit buffer encoder against the block backends
+// usage: bench-base32 [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "bench_common.h"
+#include "base32.h"
+
+namespace {
+    // The encoder base32_encode replaced, one character per iteration
+    uint32_t base32Bitwise(const uint8_t *data, uint32_t length, char *result, uint32_t resultLen) {
+        uint32_t count = 0;
+        if (length > 0) {
+            uint32_t buffer = data[0];
+            uint32_t next = 1;
+            uint32_t bitsLeft = 8;
+            while (count < resultLen && (bitsLeft > 0 || next < length)) {
+                if (bitsLeft < 5) {
+                    if (next < length) {
+                        buffer <<= 8;
+                        buffer |= data[next++] & 0xFF;
+                        bitsLeft += 8;
+                    } else {
+                        uint32_t pad = 5u - bitsLeft;
+                        buffer <<= pad;
+                        bitsLeft += pad;
+                    }
+                }
+                uint32_t index = 0x1Fu & (buffer >> (bitsLeft - 5u));
+                bitsLeft -= 5;
+                result[count++] = "abcdefghijklmnopqrstuvwxyz234567"[index];
+            }
+        }
+        if (count < resultLen) {
+            result[count] = '\000';
+        }
+        return count;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+    std::mt19937 rng(42);
+    printf("%8s %14s %14s %14s %14s\n", "bytes", "bitwise ns", "scalar ns", "ssse3 ns", "avx2 ns");
+
+    // 24: secp256k1 and actor payloads with checksum, 52: BLS, longer ones for throughput
+    for (uint32_t len : {24, 52, 256, 4096}) {
+        blob_t data(len);
+        for (auto &b : data) {
+            b = (uint8_t) rng();
+        }
+        const size_t rounds = iterations * 24 / len + 1;
+        std::vector<char> out(len * 2);
+        volatile size_t sink = 0;
+
+        const double bitwiseSeconds = measureSeconds([&]() {
+            for (size_t i = 0; i < rounds; i++) {
+                sink += base32Bitwise(data.data(), len, out.data(), out.size());
+            }
+        });
+
+        double backendSeconds[3];
+        const base32_backend_e backends[] = {base32_backend_scalar, base32_backend_ssse3, base32_backend_avx2};
+        for (int b = 0; b < 3; b++) {
+            backendSeconds[b] = measureSeconds([&]() {
+                for (size_t i = 0; i < rounds; i++) {
+                    sink += base32_encode_backend(backends[b], data.data(), len, out.data(), out.size());
+                }
+            });
+        }
+
+        printf("%8u %14.1f %14.1f %14.1f %14.1f\n", len,
+               bitwiseSeconds * 1e9 / rounds,
+               backendSeconds[0] * 1e9 / rounds,
+               backendSeconds[1] * 1e9 / rounds,
+               backendSeconds[2] * 1e9 / rounds);
+    }
+
+    return 0;
+}
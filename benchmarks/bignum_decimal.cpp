@@ -0,0 +1,67 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Decimal conversion of bigints: double-dabble (bignumBigEndian_to_bcd + bcdprint) against bignumBigEndian_to_decimal
+// usage: bench-bignum_decimal [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "bench_common.h"
+#include "bignum.h"
+#include "bignum_decimal.h"
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+
+    std::mt19937 rng(42);
+    printf("%8s %14s %14s %9s\n", "bytes", "bcd ns/value", "dec ns/value", "speedup");
+
+    // Typical token amounts are 8 to 12 bytes, 63 is the longest value a message can show
+    for (size_t len : {4, 8, 12, 16, 24, 32, 48, 63}) {
+        blob_t value(len);
+        for (auto &b : value) {
+            b = (uint8_t) rng();
+        }
+
+        // same buffer sizes as parser_printBigIntFixedPoint used
+        uint8_t bcd[80];
+        char out[160];
+        volatile size_t sink = 0;
+
+        const double bcdSeconds = measureSeconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                bignumBigEndian_to_bcd(bcd, sizeof(bcd), value.data(), value.size());
+                bignumBigEndian_bcdprint(out, sizeof(out), bcd, sizeof(bcd));
+                sink += out[0];
+            }
+        });
+
+        const double decimalSeconds = measureSeconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                bignumBigEndian_to_decimal(out, sizeof(out), value.data(), value.size());
+                sink += out[0];
+            }
+        });
+
+        printf("%8zu %14.1f %14.1f %9.1f\n", len,
+               bcdSeconds * 1e9 / iterations,
+               decimalSeconds * 1e9 / iterations,
+               bcdSeconds / decimalSeconds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// BLAKE2b-256 of address, CID and message sized inputs with each compression backend,
+// then short digests of many independent inputs, one by one against blake2b_many
+// usage: bench-blake2b [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "bench_common.h"
+#include "blake2b_dispatch.h"
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+    const struct {
+        blake2b_backend_e backend;
+        const char *name;
+    } backends[] = {
+            {blake2b_backend_portable, "portable"},
+            {blake2b_backend_sse41,    "sse4.1"},
+            {blake2b_backend_avx2,     "avx2"},
+    };
+
+    printf("auto selects backend %d\n", blake2b_selected_backend());
+    printf("%8s %10s %14s %12s %9s\n", "bytes", "backend", "ns/hash", "MB/s", "speedup");
+
+    for (size_t len : {32, 65, 4096}) {
+        std::vector<uint8_t> data(len);
+        for (size_t i = 0; i < len; i++) {
+            data[i] = (uint8_t) (i * 31);
+        }
+        // keep the total amount of data hashed about the same for every size
+        const size_t rounds = len > 1024 ? iterations / 32 : iterations;
+
+        double portableSeconds = 0;
+        for (const auto &b : backends) {
+            volatile uint8_t sink = 0;
+            const double seconds = measureSeconds([&]() {
+                uint8_t out[32];
+                for (size_t i = 0; i < rounds; i++) {
+                    blake2b_with_backend(b.backend, out, sizeof(out), data.data(), data.size());
+                    sink ^= out[0];
+                }
+            });
+            if (b.backend == blake2b_backend_portable) {
+                portableSeconds = seconds;
+            }
+
+            printf("%8zu %10s %14.1f %12.1f %9.2f\n", len, b.name,
+                   seconds * 1e9 / rounds,
+                   (double) (len * rounds) / seconds / 1e6,
+                   portableSeconds / seconds);
+        }
+    }
+
+    // address checksums of protocol 1 and 3 payloads, and public key hashes
+    const struct {
+        size_t inputLen;
+        size_t outLen;
+        const char *name;
+    } shortInputs[] = {
+            {21, 4,  "checksum f1"},
+            {49, 4,  "checksum f3"},
+            {65, 20, "pubkey hash"},
+    };
+    const size_t numItems = 64;
+
+    printf("\n%12s %14s %14s %9s\n", "input", "single ns", "many ns", "speedup");
+    for (const auto &input : shortInputs) {
+        std::vector<uint8_t> data(numItems * input.inputLen);
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = (uint8_t) (i * 7);
+        }
+        std::vector<uint8_t> outs(numItems * input.outLen);
+        std::vector<blake2b_many_item_t> items(numItems);
+        for (size_t i = 0; i < numItems; i++) {
+            items[i] = {&data[i * input.inputLen], input.inputLen, &outs[i * input.outLen]};
+        }
+        const size_t rounds = iterations / numItems;
+
+        const double singleSeconds = measureSeconds([&]() {
+            for (size_t r = 0; r < rounds; r++) {
+                for (const auto &item : items) {
+                    blake2b(item.out, input.outLen, item.in, item.inlen, nullptr, 0);
+                }
+            }
+        });
+        const double manySeconds = measureSeconds([&]() {
+            for (size_t r = 0; r < rounds; r++) {
+                blake2b_many(items.data(), items.size(), input.outLen);
+            }
+        });
+
+        printf("%12s %14.1f %14.1f %9.2f\n", input.name,
+               singleSeconds * 1e9 / (rounds * numItems),
+               manySeconds * 1e9 / (rounds * numItems),
+               singleSeconds / manySeconds);
+    }
+
+    return 0;
+}
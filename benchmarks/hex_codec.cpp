@@ -0,0 +1,102 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Hex encoding of byte string params and decoding of message hex: zxlib against each hex_codec backend
+// usage: bench-hex_codec [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <zxformat.h>
+#include <hexutils.h>
+#include "bench_common.h"
+#include "hex_codec.h"
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+    const struct {
+        hex_backend_e backend;
+        const char *name;
+    } backends[] = {
+            {hex_backend_scalar, "scalar"},
+            {hex_backend_ssse3,  "ssse3"},
+            {hex_backend_avx2,   "avx2"},
+    };
+
+    std::mt19937 rng(22);
+    printf("%8s %8s %10s %14s %9s\n", "op", "bytes", "impl", "ns/call", "speedup");
+
+    // the largest byte string param printValue shows, and a whole message
+    for (size_t len : {32, 200, 8192}) {
+        std::vector<uint8_t> data(len);
+        for (auto &b : data) {
+            b = (uint8_t) rng();
+        }
+        std::vector<char> text(2 * len + 1);
+        const size_t rounds = len > 1024 ? iterations / 32 : iterations;
+        volatile char sink = 0;
+
+        // array_to_hexstr counts up to 255 bytes
+        double zxlibSeconds = 0;
+        if (len <= 255) {
+            zxlibSeconds = measureSeconds([&]() {
+                for (size_t i = 0; i < rounds; i++) {
+                    array_to_hexstr(text.data(), text.size(), data.data(), (uint8_t) len);
+                    sink ^= text[i % len];
+                }
+            });
+            printf("%8s %8zu %10s %14.1f %9.2f\n", "encode", len, "zxlib", zxlibSeconds * 1e9 / rounds, 1.0);
+        }
+        for (const auto &b : backends) {
+            const double seconds = measureSeconds([&]() {
+                for (size_t i = 0; i < rounds; i++) {
+                    hex_encode_backend(b.backend, text.data(), text.size(), data.data(), len);
+                    sink ^= text[i % len];
+                }
+            });
+            if (zxlibSeconds > 0) {
+                printf("%8s %8zu %10s %14.1f %9.2f\n", "encode", len, b.name, seconds * 1e9 / rounds,
+                       zxlibSeconds / seconds);
+            } else {
+                printf("%8s %8zu %10s %14.1f %9s\n", "encode", len, b.name, seconds * 1e9 / rounds, "-");
+            }
+        }
+
+        std::vector<uint8_t> decoded(len);
+        zxlibSeconds = measureSeconds([&]() {
+            for (size_t i = 0; i < rounds; i++) {
+                parseHexString(decoded.data(), decoded.size(), text.data());
+                sink ^= decoded[i % len];
+            }
+        });
+        printf("%8s %8zu %10s %14.1f %9.2f\n", "decode", len, "zxlib", zxlibSeconds * 1e9 / rounds, 1.0);
+        for (const auto &b : backends) {
+            const double seconds = measureSeconds([&]() {
+                for (size_t i = 0; i < rounds; i++) {
+                    hex_decode_backend(b.backend, decoded.data(), decoded.size(), text.data());
+                    sink ^= decoded[i % len];
+                }
+            });
+            printf("%8s %8zu %10s %14.1f %9.2f\n", "decode", len, b.name, seconds * 1e9 / rounds,
+                   zxlibSeconds / seconds);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// 64-bit integer to decimal: zxlib's digit per step uint64_to_str against uint64_to_decimal
+// usage: bench-int_decimal [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <zxformat.h>
+#include "bench_common.h"
+#include "int_decimal.h"
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+
+    std::mt19937_64 rng(21);
+    printf("%8s %14s %14s %9s\n", "digits", "zxlib ns", "decimal ns", "speedup");
+
+    // method numbers and nonces are short, IDs and gas limits mid sized
+    for (int digits : {1, 2, 4, 7, 10, 14, 20}) {
+        std::vector<uint64_t> values;
+        uint64_t low = 1;
+        for (int i = 1; i < digits; i++) {
+            low *= 10;
+        }
+        for (int i = 0; i < 16; i++) {
+            values.push_back(digits == 20 ? low + rng() % (UINT64_MAX - low) : low + rng() % (low * 9));
+        }
+
+        volatile char sink = 0;
+        char buffer[30];
+        const double zxlibSeconds = measureSeconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                uint64_to_str(buffer, sizeof(buffer), values[i % 16]);
+                sink ^= buffer[0];
+            }
+        });
+        const double decimalSeconds = measureSeconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                uint64_to_decimal(buffer, sizeof(buffer), values[i % 16]);
+                sink ^= buffer[0];
+            }
+        });
+
+        printf("%8d %14.2f %14.2f %9.1f\n", digits,
+               zxlibSeconds * 1e9 / iterations,
+               decimalSeconds * 1e9 / iterations,
+               zxlibSeconds / decimalSeconds);
+    }
+
+    return 0;
+}
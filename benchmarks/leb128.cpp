@@ -0,0 +1,87 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// LEB128 decoding of ID address payloads: the byte per iteration loop against decompressLEB128
+// usage: bench-leb128 [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "bench_common.h"
+#include "crypto.h"
+
+namespace {
+    // The decoder decompressLEB128 replaced on hosts, not inlined so that both pay for a call
+    __attribute__((noinline)) uint8_t decompressLEB128Bytewise(const uint8_t *input, uint16_t inputSize, uint64_t *v) {
+        *v = 0;
+        uint16_t shift = 0;
+        for (unsigned int i = 0; i < 10u && i < inputSize; i++, shift += 7) {
+            const uint64_t b = input[i] & 0x7fu;
+            if (shift >= 63 && b > 1) {
+                break;
+            }
+            *v |= b << shift;
+            if (!(input[i] & 0x80u)) {
+                return 1;
+            }
+        }
+        *v = 0;
+        return 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+
+    std::mt19937_64 rng(42);
+    printf("%8s %14s %14s %9s\n", "bytes", "bytewise ns", "decode ns", "speedup");
+
+    // Actor IDs are mostly 2 to 4 bytes
+    for (uint8_t len : {1, 2, 3, 4, 6, 8, 10}) {
+        // a few different values of the same length, padded as the address buffer would be
+        std::vector<std::vector<uint8_t>> values;
+        for (int i = 0; i < 16; i++) {
+            const uint64_t v = len == 10 ? (rng() | (1ull << 63u)) : (rng() >> (64 - 7 * len)) | (1ull << (7 * len - 1));
+            std::vector<uint8_t> encoded(16);
+            compressLEB128(v, encoded.data(), encoded.size());
+            values.push_back(encoded);
+        }
+
+        volatile uint64_t sink = 0;
+        const double bytewiseSeconds = measureSeconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                uint64_t v;
+                decompressLEB128Bytewise(values[i % 16].data(), 16, &v);
+                sink += v;
+            }
+        });
+        const double decodeSeconds = measureSeconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                uint64_t v;
+                decompressLEB128(values[i % 16].data(), 16, &v);
+                sink += v;
+            }
+        });
+
+        printf("%8u %14.2f %14.2f %9.1f\n", len,
+               bytewiseSeconds * 1e9 / iterations,
+               decodeSeconds * 1e9 / iterations,
+               bytewiseSeconds / decodeSeconds);
+    }
+
+    return 0;
+}
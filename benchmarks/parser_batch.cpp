@@ -0,0 +1,80 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Scaling curve of parser_batch_validate over the test vectors and the parser fuzzing corpus
+// usage: bench-parser_batch [total messages] [max threads]
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "bench_common.h"
+#include "parser_batch.h"
+#include "crypto.h"
+
+int main(int argc, char **argv) {
+    size_t totalMessages = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    uint32_t maxThreads = argc > 2 ? (uint32_t) strtoul(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+    if (maxThreads == 0) {
+        maxThreads = 1;
+    }
+
+    hdPath[0] = HDPATH_0_DEFAULT;
+    hdPath[1] = HDPATH_1_DEFAULT;
+
+    auto blobs = loadTestVectorBlobs();
+    const auto corpus = loadCorpusBlobs("parser_parse");
+    blobs.insert(blobs.end(), corpus.begin(), corpus.end());
+    if (blobs.empty()) {
+        fprintf(stderr, "no input messages found\n");
+        return 1;
+    }
+
+    std::vector<parser_batch_item_t> items(totalMessages);
+    for (size_t i = 0; i < totalMessages; i++) {
+        const auto &blob = blobs[i % blobs.size()];
+        items[i] = {blob.data(), blob.size()};
+    }
+    std::vector<parser_error_t> results(totalMessages);
+
+    printf("%zu distinct inputs, %zu messages per run\n", blobs.size(), totalMessages);
+    printf("%8s %12s %14s %9s\n", "threads", "seconds", "messages/s", "speedup");
+
+    // 1, 2, 4, ... up to maxThreads
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double baseline = 0;
+    for (auto threads : threadCounts) {
+        const double seconds = measureSeconds([&]() {
+            parser_batch_validate(items.data(), items.size(), results.data(), threads);
+        });
+        if (threads == 1) {
+            baseline = seconds;
+        }
+        printf("%8u %12.4f %14.0f %9.2f\n", threads, seconds, totalMessages / seconds, baseline / seconds);
+    }
+
+    size_t accepted = 0;
+    for (auto r : results) {
+        accepted += r == parser_ok;
+    }
+    printf("%zu of %zu messages accepted\n", accepted, totalMessages);
+
+    return 0;
+}
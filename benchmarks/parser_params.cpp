@@ -0,0 +1,96 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Parse + validate cost of messages carrying a growing number of array params
+// usage: bench-parser_params [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <hexutils.h>
+#include "bench_common.h"
+#include "parser.h"
+#include "crypto.h"
+
+namespace {
+    // Message up to and including method 0, buildMessage replaces the method and appends the params
+    const char *TX_PREFIX = "8a005501fd1d0f4dfcd7e99afcb99a8326b7dc459d32c6285501b882619d46558f3d9e316d11b48dcf211327025a0144000186a01961a8420000430009c400";
+
+    void appendHeader(blob_t &blob, uint8_t majorType, size_t len) {
+        if (len < 24) {
+            blob.push_back((majorType << 5) | len);
+        } else if (len <= 0xFF) {
+            blob.push_back((majorType << 5) | 24);
+            blob.push_back(len);
+        } else {
+            blob.push_back((majorType << 5) | 25);
+            blob.push_back(len >> 8);
+            blob.push_back(len & 0xFF);
+        }
+    }
+
+    /// Method 2 message whose params are an array of numParams small integers
+    blob_t buildMessage(size_t numParams) {
+        blob_t params;
+        appendHeader(params, 4, numParams);
+        for (size_t i = 0; i < numParams; i++) {
+            appendHeader(params, 0, i % 24);
+        }
+
+        const std::string prefix = TX_PREFIX;
+        blob_t blob(prefix.size() / 2);
+        blob.resize(parseHexString(blob.data(), blob.size(), prefix.c_str()));
+        // drop method 0, which is the last byte of the prefix
+        blob.pop_back();
+        blob.push_back(0x02);
+        appendHeader(blob, 2, params.size());
+        blob.insert(blob.end(), params.begin(), params.end());
+        return blob;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+
+    hdPath[0] = HDPATH_0_DEFAULT;
+    hdPath[1] = HDPATH_1_DEFAULT;
+
+    printf("%8s %14s %14s\n", "params", "us/message", "ns/param");
+
+    for (size_t numParams : {8, 32, 64, 100, 128, 160, 192}) {
+        const auto blob = buildMessage(numParams);
+
+        parser_tx_t tx;
+        parser_context_t ctx;
+        if (parser_parse_r(&ctx, blob.data(), blob.size(), &tx) != parser_ok || parser_validate_r(&ctx) != parser_ok) {
+            fprintf(stderr, "message with %zu params was rejected\n", numParams);
+            return 1;
+        }
+
+        const double seconds = measureSeconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                parser_parse_r(&ctx, blob.data(), blob.size(), &tx);
+                parser_validate_r(&ctx);
+            }
+        });
+
+        printf("%8zu %14.3f %14.1f\n", numParams,
+               seconds * 1e6 / iterations,
+               seconds * 1e9 / (iterations * numParams));
+    }
+
+    return 0;
+}
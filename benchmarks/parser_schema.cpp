@@ -0,0 +1,68 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Parse throughput of the specialized decoder compared to the generic tinycbor path
+// usage: bench-parser_schema [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include "bench_common.h"
+#include "parser.h"
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+    // Only messages that parse, rejected ones always end up in tinycbor
+    std::vector<blob_t> blobs;
+    for (const auto &blob : loadTestVectorBlobs()) {
+        parser_context_t ctx;
+        parser_tx_t tx;
+        if (parser_parse_r(&ctx, blob.data(), blob.size(), &tx) == parser_ok) {
+            blobs.push_back(blob);
+        }
+    }
+    if (blobs.empty()) {
+        fprintf(stderr, "no input messages found\n");
+        return 1;
+    }
+
+    parser_context_t ctx;
+    parser_tx_t tx;
+
+    const double genericSeconds = measureSeconds([&]() {
+        for (size_t i = 0; i < iterations; i++) {
+            const auto &blob = blobs[i % blobs.size()];
+            parser_init(&ctx, blob.data(), blob.size());
+            ctx.tx_obj = &tx;
+            _read(&ctx, &tx);
+        }
+    });
+
+    const double schemaSeconds = measureSeconds([&]() {
+        for (size_t i = 0; i < iterations; i++) {
+            const auto &blob = blobs[i % blobs.size()];
+            parser_parse_r(&ctx, blob.data(), blob.size(), &tx);
+        }
+    });
+
+    printf("%zu distinct messages, %zu parses per run\n", blobs.size(), iterations);
+    printf("%10s %14s %12s\n", "decoder", "messages/s", "ns/message");
+    printf("%10s %14.0f %12.1f\n", "tinycbor", iterations / genericSeconds, genericSeconds * 1e9 / iterations);
+    printf("%10s %14.0f %12.1f\n", "schema", iterations / schemaSeconds, schemaSeconds * 1e9 / iterations);
+    printf("speedup %.2f\n", genericSeconds / schemaSeconds);
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "base32.h"
+
+
+#ifdef NDEBUG
+#error "This fuzz target won't work correctly with NDEBUG defined, which will cause asserts to be eliminated"
+#endif
+
+
+using std::size_t;
+
+static char ENCODED[1024];
+static uint8_t DECODED[1024];
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    // bytes -> text -> the same bytes
+    if (size <= 600) {
+        const uint32_t encodedLen = base32_encode(data, size, ENCODED, sizeof(ENCODED));
+        assert(encodedLen == base32_encoded_len(size));
+        const uint32_t decodedLen = base32_decode(ENCODED, encodedLen, DECODED, sizeof(DECODED));
+        assert(decodedLen == size);
+        assert(memcmp(DECODED, data, size) == 0);
+    }
+
+    // any text that decodes is the encoding of what it decodes to
+    const uint32_t decodedLen = base32_decode((const char *) data, size, DECODED, sizeof(DECODED));
+    if (decodedLen != (uint32_t) -1) {
+        const uint32_t encodedLen = base32_encode(DECODED, decodedLen, ENCODED, sizeof(ENCODED));
+        assert(encodedLen == size);
+        assert(memcmp(ENCODED, data, size) == 0);
+    }
+
+    return 0;
+}
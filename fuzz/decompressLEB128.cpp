@@ -12,12 +12,45 @@
 
 using std::size_t;
 
+// The byte per iteration decoder decompressLEB128 was written as
+static uint8_t decompressLEB128Bytewise(const uint8_t *input, uint16_t inputSize, uint64_t *v)
+{
+    *v = 0;
+    uint16_t shift = 0;
+    for (unsigned int i = 0; i < 10u && i < inputSize; i++, shift += 7) {
+        const uint64_t b = input[i] & 0x7fu;
+        if (shift >= 63 && b > 1) {
+            break;
+        }
+        *v |= b << shift;
+        if (!(input[i] & 0x80u)) {
+            return 1;
+        }
+    }
+    *v = 0;
+    return 0;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 {
+    if (size > UINT16_MAX) return 0;
+
     uint64_t output;
-    if (decompressLEB128(data, size, &output) != 0) {
-        return 1;
+    uint64_t expected;
+    const uint8_t ret = decompressLEB128(data, size, &output);
+    assert(ret == decompressLEB128Bytewise(data, size, &expected));
+    assert(output == expected);
+    if (ret == 0) {
+        return 0;
     }
 
+    // minimal re-encoding decodes to the same value, and is never longer than the input
+    uint8_t encoded[10];
+    const uint8_t encodedLen = compressLEB128(output, encoded, sizeof(encoded));
+    assert(encodedLen > 0 && encodedLen <= size);
+    uint64_t decoded;
+    assert(decompressLEB128(encoded, encodedLen, &decoded) == 1);
+    assert(decoded == output);
+
     return 0;
 }
@@ -1,9 +1,11 @@
 #include <cassert>
+#include <cctype>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 
 #include "hexutils.h"
+#include "hex_codec.h"
 
 
 #ifdef NDEBUG
@@ -16,6 +18,8 @@ using std::size_t;
 static constexpr size_t SIZE = 512;
 static char INPUT[SIZE];
 static uint8_t OUTPUT[SIZE];
+static uint8_t DECODED[SIZE];
+static uint8_t EXPECTED[SIZE];
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 {
@@ -28,5 +32,24 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
     size_t out_size = parseHexString(OUTPUT, (uint16_t)sizeof(OUTPUT), INPUT);
     assert (out_size <= sizeof(OUTPUT));
 
+    // every backend returns the same and leaves the same bytes, also for invalid input
+    const hex_backend_e backends[] = {hex_backend_scalar, hex_backend_ssse3, hex_backend_avx2};
+    for (hex_backend_e backend : backends) {
+        memset(DECODED, 0, sizeof(DECODED));
+        memset(EXPECTED, 0, sizeof(EXPECTED));
+        const size_t expected_size = parseHexString(EXPECTED, (uint16_t)sizeof(EXPECTED), INPUT);
+        assert(hex_decode_backend(backend, DECODED, (uint16_t)sizeof(DECODED), INPUT) == expected_size);
+        assert(memcmp(DECODED, EXPECTED, sizeof(DECODED)) == 0);
+    }
+
+    // and encoding the decoded bytes gives the input back, in lower case
+    if (out_size > 0) {
+        static char ENCODED[2 * SIZE + 1];
+        assert(hex_encode(ENCODED, sizeof(ENCODED), OUTPUT, out_size) == 2 * out_size);
+        for (size_t i = 0; i < 2 * out_size; i++) {
+            assert(ENCODED[i] == (char) tolower(INPUT[i]));
+        }
+    }
+
     return 0;
 }
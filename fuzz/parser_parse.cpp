@@ -3,6 +3,7 @@
 #include <cstdio>
 
 #include "parser.h"
+#include "hex_codec.h"
 
 
 #ifdef NDEBUG
@@ -21,7 +22,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
     parser_error_t rc;
 
     char buffer[10000];
-    array_to_hexstr(buffer, sizeof(buffer), data, size);
+    hex_encode(buffer, sizeof(buffer), data, size);
     //fprintf(stderr, "input blob: %s\n", buffer);
 
     rc = parser_parse(&ctx, data, size);
@@ -0,0 +1,164 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#include "gmock/gmock.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "app_main.h"
+#include "addr_batch.h"
+#include "crypto.h"
+
+namespace {
+    // Mocked device buffer: 5 bytes of header and up to 255 bytes of data
+    const uint16_t IO_APDU_BUFFER_SIZE = 5 + 255;
+    uint8_t G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+    struct reply_t {
+        uint16_t sw;
+        std::vector<uint8_t> data;
+    };
+
+    /// One exchange with the device: the command is written to G_io_apdu_buffer, the reply read back from it
+    reply_t exchange(addr_batch_t *batch, uint8_t p1, const std::vector<uint8_t> &data, uint8_t p2 = 0) {
+        MEMZERO(G_io_apdu_buffer, sizeof(G_io_apdu_buffer));
+        G_io_apdu_buffer[OFFSET_CLA] = 0x06;
+        G_io_apdu_buffer[OFFSET_INS] = INS_GET_ADDR_BATCH_SECP256K1;
+        G_io_apdu_buffer[OFFSET_P1] = p1;
+        G_io_apdu_buffer[OFFSET_P2] = p2;
+        G_io_apdu_buffer[OFFSET_DATA_LEN] = data.size();
+        memcpy(G_io_apdu_buffer + OFFSET_DATA, data.data(), data.size());
+
+        uint16_t replyLen = 0;
+        reply_t reply;
+        // as handleGetAddrBatch does, room is left for the status word
+        reply.sw = addr_batch_process(batch, G_io_apdu_buffer, sizeof(G_io_apdu_buffer) - 2,
+                                      OFFSET_DATA + data.size(), &replyLen);
+        reply.data.assign(G_io_apdu_buffer, G_io_apdu_buffer + replyLen);
+        return reply;
+    }
+
+    std::vector<uint8_t> request(uint32_t path0, uint32_t path1, uint32_t firstIndex, uint32_t count) {
+        const uint32_t words[HDPATH_LEN_DEFAULT + 1] = {path0, path1, HDPATH_2_DEFAULT, HDPATH_3_DEFAULT, firstIndex, count};
+        std::vector<uint8_t> data(sizeof(words));
+        memcpy(data.data(), words, sizeof(words));
+        return data;
+    }
+
+    std::vector<uint8_t> request(uint32_t firstIndex, uint32_t count) {
+        return request(HDPATH_0_DEFAULT, HDPATH_1_DEFAULT, firstIndex, count);
+    }
+
+    /// Address bytes INS_GET_ADDR_SECP256K1 returns for the path ending in index
+    std::vector<uint8_t> singleAddress(uint32_t index) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+        hdPath[2] = HDPATH_2_DEFAULT;
+        hdPath[3] = HDPATH_3_DEFAULT;
+        hdPath[4] = index;
+
+        uint8_t buffer[200];
+        uint16_t addrLen = 0;
+        EXPECT_EQ(crypto_fillAddress(buffer, sizeof(buffer), &addrLen), zxerr_ok);
+        // public key, then the length of the address bytes and the address bytes
+        EXPECT_EQ(buffer[SECP256K1_PK_LEN], ADDRESS_SECP256K1_BYTES_LEN);
+        const uint8_t *addrBytes = buffer + SECP256K1_PK_LEN + 1;
+        return std::vector<uint8_t>(addrBytes, addrBytes + ADDRESS_SECP256K1_BYTES_LEN);
+    }
+
+    TEST(AddrBatch, SameAddressesAsSingleRequests) {
+        const uint32_t firstIndex = 5;
+        const uint32_t count = 30;
+
+        addr_batch_t batch;
+        addr_batch_reset(&batch);
+
+        std::vector<uint8_t> received;
+        auto reply = exchange(&batch, ADDR_BATCH_P1_START, request(firstIndex, count));
+        while (true) {
+            ASSERT_EQ(reply.sw, APDU_CODE_OK);
+            ASSERT_FALSE(reply.data.empty());
+            ASSERT_EQ(reply.data.size() % ADDRESS_SECP256K1_BYTES_LEN, 0u);
+            received.insert(received.end(), reply.data.begin(), reply.data.end());
+            if (received.size() == count * ADDRESS_SECP256K1_BYTES_LEN) {
+                break;
+            }
+            reply = exchange(&batch, ADDR_BATCH_P1_NEXT, {});
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            const auto first = received.begin() + i * ADDRESS_SECP256K1_BYTES_LEN;
+            EXPECT_EQ(std::vector<uint8_t>(first, first + ADDRESS_SECP256K1_BYTES_LEN), singleAddress(firstIndex + i))
+                                << "index " << firstIndex + i;
+        }
+
+        // everything was sent
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_NEXT, {}).sw, APDU_CODE_CONDITIONS_NOT_SATISFIED);
+    }
+
+    TEST(AddrBatch, ExchangesSaved) {
+        // addresses per reply: 258 bytes of room, 21 bytes each
+        const uint32_t perReply = (IO_APDU_BUFFER_SIZE - 2) / ADDRESS_SECP256K1_BYTES_LEN;
+        EXPECT_EQ(perReply, 12u);
+
+        for (uint32_t count : {1, 12, 13, 20, 100, 1000}) {
+            addr_batch_t batch;
+            addr_batch_reset(&batch);
+
+            uint32_t exchanges = 1;
+            size_t received = exchange(&batch, ADDR_BATCH_P1_START, request(0, count)).data.size();
+            while (received < count * ADDRESS_SECP256K1_BYTES_LEN) {
+                const auto reply = exchange(&batch, ADDR_BATCH_P1_NEXT, {});
+                ASSERT_EQ(reply.sw, APDU_CODE_OK);
+                received += reply.data.size();
+                exchanges++;
+            }
+
+            // INS_GET_ADDR_SECP256K1 needs one exchange per address
+            EXPECT_EQ(exchanges, (count + perReply - 1) / perReply);
+            std::cout << count << " addresses: " << exchanges << " exchanges instead of " << count << std::endl;
+        }
+    }
+
+    TEST(AddrBatch, Errors) {
+        addr_batch_t batch;
+        addr_batch_reset(&batch);
+
+        // nothing was requested
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_NEXT, {}).sw, APDU_CODE_CONDITIONS_NOT_SATISFIED);
+
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, request(0, 0)).sw, APDU_CODE_DATA_INVALID);
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, request(0x80000000u | 44u, 0x1u, 0, 1)).sw,
+                  APDU_CODE_DATA_INVALID);
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, request(HDPATH_0_TESTNET, HDPATH_1_TESTNET, 0, 1)).sw,
+                  APDU_CODE_OK);
+
+        // indexes can not cross into the hardened range or wrap around
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, request(0x7FFFFFF0u, 16)).sw, APDU_CODE_OK);
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, request(0x7FFFFFF0u, 17)).sw, APDU_CODE_DATA_INVALID);
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, request(0xFFFFFFF0u, 16)).sw, APDU_CODE_OK);
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, request(0xFFFFFFF0u, 17)).sw, APDU_CODE_DATA_INVALID);
+
+        // a failed request ends the previous one
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_NEXT, {}).sw, APDU_CODE_CONDITIONS_NOT_SATISFIED);
+
+        auto shortRequest = request(0, 1);
+        shortRequest.pop_back();
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, shortRequest).sw, APDU_CODE_WRONG_LENGTH);
+        EXPECT_EQ(exchange(&batch, ADDR_BATCH_P1_START, request(0, 1), 1).sw, APDU_CODE_INVALIDP1P2);
+        EXPECT_EQ(exchange(&batch, 2, request(0, 1)).sw, APDU_CODE_INVALIDP1P2);
+    }
+}
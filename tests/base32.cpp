@@ -0,0 +1,165 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "base32.h"
+
+namespace {
+    // Reference: the bit buffer encoder base32_encode was written as (one character per iteration)
+    uint32_t base32Bitwise(const uint8_t *data, uint32_t length, char *result, uint32_t resultLen) {
+        uint32_t count = 0;
+        if (length > 0) {
+            uint32_t buffer = data[0];
+            uint32_t next = 1;
+            uint32_t bitsLeft = 8;
+            while (count < resultLen && (bitsLeft > 0 || next < length)) {
+                if (bitsLeft < 5) {
+                    if (next < length) {
+                        buffer <<= 8;
+                        buffer |= data[next++] & 0xFF;
+                        bitsLeft += 8;
+                    } else {
+                        uint32_t pad = 5u - bitsLeft;
+                        buffer <<= pad;
+                        bitsLeft += pad;
+                    }
+                }
+                uint32_t index = 0x1Fu & (buffer >> (bitsLeft - 5u));
+                bitsLeft -= 5;
+                result[count++] = "abcdefghijklmnopqrstuvwxyz234567"[index];
+            }
+        }
+        if (count < resultLen) {
+            result[count] = '\000';
+        }
+        return count;
+    }
+
+    const base32_backend_e BACKENDS[] = {
+            base32_backend_auto, base32_backend_scalar, base32_backend_ssse3, base32_backend_avx2,
+    };
+
+    TEST(Base32, BackendsSameAsBitwise) {
+        std::mt19937 rng(15);
+        for (uint32_t len = 0; len <= 200; len++) {
+            std::vector<uint8_t> data(len);
+            for (auto &b : data) {
+                b = (uint8_t) rng();
+            }
+
+            char expected[400];
+            memset(expected, 'x', sizeof(expected));
+            const uint32_t expectedCount = base32Bitwise(data.data(), len, expected, sizeof(expected));
+
+            for (auto backend : BACKENDS) {
+                char out[400];
+                memset(out, 'x', sizeof(out));
+                ASSERT_EQ(base32_encode_backend(backend, data.data(), len, out, sizeof(out)), expectedCount);
+                ASSERT_EQ(std::string(out, sizeof(out)), std::string(expected, sizeof(expected)))
+                                            << len << " backend " << backend;
+            }
+        }
+    }
+
+    // Output shorter than the encoding is truncated, NUL terminated only if there is room left
+    TEST(Base32, TruncatedOutput) {
+        std::mt19937 rng(16);
+        for (uint32_t len : {1, 5, 24, 52, 100}) {
+            std::vector<uint8_t> data(len);
+            for (auto &b : data) {
+                b = (uint8_t) rng();
+            }
+
+            for (uint32_t resultLen = 0; resultLen <= base32_encoded_len(len) + 2; resultLen++) {
+                char expected[200];
+                memset(expected, 'x', sizeof(expected));
+                const uint32_t expectedCount = base32Bitwise(data.data(), len, expected, resultLen);
+
+                for (auto backend : BACKENDS) {
+                    char out[200];
+                    memset(out, 'x', sizeof(out));
+                    ASSERT_EQ(base32_encode_backend(backend, data.data(), len, out, resultLen), expectedCount);
+                    ASSERT_EQ(std::string(out, sizeof(out)), std::string(expected, sizeof(expected)))
+                                                << len << " " << resultLen << " backend " << backend;
+                }
+            }
+        }
+    }
+
+    // The vector backends must not read past the end of the data
+    TEST(Base32, NoOverread) {
+        for (uint32_t len = 0; len <= 64; len++) {
+            // exactly len bytes on the heap, so sanitizer builds catch reads past the end
+            std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
+            for (uint32_t i = 0; i < len; i++) {
+                data[i] = (uint8_t) (i * 37);
+            }
+            char expected[120];
+            base32Bitwise(data.get(), len, expected, sizeof(expected));
+
+            for (auto backend : BACKENDS) {
+                char out[120];
+                base32_encode_backend(backend, data.get(), len, out, sizeof(out));
+                ASSERT_STREQ(out, expected) << len;
+            }
+        }
+    }
+
+    TEST(Base32, DecodeRoundTrip) {
+        std::mt19937 rng(17);
+        for (uint32_t len = 0; len <= 100; len++) {
+            std::vector<uint8_t> data(len);
+            for (auto &b : data) {
+                b = (uint8_t) rng();
+            }
+            char encoded[200];
+            const uint32_t encodedLen = base32_encode(data.data(), len, encoded, sizeof(encoded));
+
+            std::vector<uint8_t> decoded(len + 1);
+            ASSERT_EQ(base32_decode(encoded, encodedLen, decoded.data(), decoded.size()), len);
+            decoded.resize(len);
+            ASSERT_EQ(decoded, data) << len;
+
+            // too small
+            if (len > 0) {
+                EXPECT_EQ(base32_decode(encoded, encodedLen, decoded.data(), len - 1), (uint32_t) -1);
+            }
+        }
+    }
+
+    TEST(Base32, DecodeRejectsNonCanonical) {
+        uint8_t out[16];
+        // the 2 low bits of 'b' are not part of the byte and must be zero
+        EXPECT_EQ(base32_decode("ab", 2, out, sizeof(out)), (uint32_t) -1);
+        EXPECT_EQ(base32_decode("ae", 2, out, sizeof(out)), 1u);
+        EXPECT_EQ(base32_decode("aa", 2, out, sizeof(out)), 1u);
+        // lengths base32_encode never produces
+        EXPECT_EQ(base32_decode("a", 1, out, sizeof(out)), (uint32_t) -1);
+        EXPECT_EQ(base32_decode("aaa", 3, out, sizeof(out)), (uint32_t) -1);
+        EXPECT_EQ(base32_decode("aaaaaa", 6, out, sizeof(out)), (uint32_t) -1);
+        // outside the alphabet
+        EXPECT_EQ(base32_decode("aaaaaaaA", 8, out, sizeof(out)), (uint32_t) -1);
+        EXPECT_EQ(base32_decode("aaaaaaa1", 8, out, sizeof(out)), (uint32_t) -1);
+        EXPECT_EQ(base32_decode("aaaaaaa=", 8, out, sizeof(out)), (uint32_t) -1);
+        EXPECT_EQ(base32_decode("a8", 2, out, sizeof(out)), (uint32_t) -1);
+        EXPECT_EQ(base32_decode("", 0, out, sizeof(out)), 0u);
+    }
+}
@@ -0,0 +1,158 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include "bignum.h"
+#include "bignum_decimal.h"
+#include "zxformat.h"
+
+namespace {
+    // Reference: double-dabble to BCD, then print the nibbles
+    std::string decimalBCD(const std::vector<uint8_t> &value) {
+        uint8_t bcd[160];
+        char out[330];
+        bignumBigEndian_to_bcd(bcd, sizeof(bcd), value.data(), value.size());
+        EXPECT_TRUE(bignumBigEndian_bcdprint(out, sizeof(out), bcd, sizeof(bcd)));
+        return out;
+    }
+
+    std::string decimal(const std::vector<uint8_t> &value) {
+        char out[330];
+        EXPECT_TRUE(bignumBigEndian_to_decimal(out, sizeof(out), value.data(), value.size()));
+        return out;
+    }
+
+    TEST(BignumDecimal, SameAsBCD) {
+        std::mt19937 rng(1234);
+        for (size_t len = 0; len <= BIGNUM_DECIMAL_MAX_LEN; len++) {
+            for (int i = 0; i < 8; i++) {
+                std::vector<uint8_t> value(len);
+                for (auto &b : value) {
+                    b = (uint8_t) rng();
+                }
+                // also values with leading zero bytes
+                if (i % 4 == 1 && len > 0) {
+                    value[0] = 0;
+                }
+                ASSERT_EQ(decimal(value), decimalBCD(value)) << len;
+            }
+        }
+    }
+
+    TEST(BignumDecimal, LimbBoundaries) {
+        EXPECT_EQ(decimal({}), "0");
+        EXPECT_EQ(decimal({0, 0, 0}), "0");
+        EXPECT_EQ(decimal({0x3b, 0x9a, 0xca, 0x00}), "1000000000");
+        EXPECT_EQ(decimal({0x3b, 0x9a, 0xc9, 0xff}), "999999999");
+        EXPECT_EQ(decimal(std::vector<uint8_t>(8, 0xff)), "18446744073709551615");
+        EXPECT_EQ(decimal({0x01, 0, 0, 0, 0, 0, 0, 0, 0}), "18446744073709551616");
+        // 10^19 - 1 and 10^19
+        EXPECT_EQ(decimal({0x8a, 0xc7, 0x23, 0x04, 0x89, 0xe7, 0xff, 0xff}), "9999999999999999999");
+        EXPECT_EQ(decimal({0x8a, 0xc7, 0x23, 0x04, 0x89, 0xe8, 0x00, 0x00}), "10000000000000000000");
+        EXPECT_EQ(decimal(std::vector<uint8_t>(16, 0xff)), "340282366920938463463374607431768211455");
+        EXPECT_EQ(decimal(std::vector<uint8_t>(17, 0xff)), decimalBCD(std::vector<uint8_t>(17, 0xff)));
+    }
+
+    TEST(BignumDecimal, OutputTooSmall) {
+        const std::vector<uint8_t> value = {0x3b, 0x9a, 0xca, 0x00};
+        char out[11];
+        EXPECT_TRUE(bignumBigEndian_to_decimal(out, sizeof(out), value.data(), value.size()));
+        EXPECT_STREQ(out, "1000000000");
+        EXPECT_FALSE(bignumBigEndian_to_decimal(out, sizeof(out) - 1, value.data(), value.size()));
+
+        const std::vector<uint8_t> tooLong(BIGNUM_DECIMAL_MAX_LEN + 1, 0xff);
+        char large[400];
+        EXPECT_FALSE(bignumBigEndian_to_decimal(large, sizeof(large), tooLong.data(), tooLong.size()));
+    }
+}
+
+namespace {
+    // Reference: digits, fpstr_to_str and pageString, as the parser used to do it
+    std::string fixedPointPageReference(const std::vector<uint8_t> &value, uint8_t decimals,
+                                        uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+        char text[400];
+        char page[400];
+        fpstr_to_str(text, sizeof(text), decimal(value).c_str(), decimals);
+        pageString(page, outValLen, text, pageIdx, pageCount);
+        return page;
+    }
+
+    std::string fixedPointPage(const std::vector<uint8_t> &value, uint8_t decimals,
+                               uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+        char page[400];
+        memset(page, 'x', sizeof(page));
+        EXPECT_TRUE(bignumBigEndian_to_fpstr_page(page, outValLen, value.data(), value.size(),
+                                                  decimals, pageIdx, pageCount));
+        return std::string(page, strnlen(page, outValLen));
+    }
+
+    TEST(BignumDecimal, FixedPointPagesSameAsReference) {
+        std::mt19937 rng(4321);
+        for (size_t len = 0; len <= 40; len++) {
+            for (int i = 0; i < 4; i++) {
+                std::vector<uint8_t> value(len);
+                for (auto &b : value) {
+                    b = (uint8_t) rng();
+                }
+                for (uint8_t decimals : {0, 9, 18}) {
+                    for (uint16_t outValLen : {2, 17, 35, 41, 200}) {
+                        uint8_t expectedCount = 0;
+                        uint8_t pageCount = 0;
+                        fixedPointPageReference(value, decimals, outValLen, 0, &expectedCount);
+                        fixedPointPage(value, decimals, outValLen, 0, &pageCount);
+                        ASSERT_EQ(pageCount, expectedCount) << len << " " << outValLen;
+
+                        // one past the last page is empty in both
+                        for (uint8_t pageIdx = 0; pageIdx <= expectedCount; pageIdx++) {
+                            const auto expected = fixedPointPageReference(value, decimals, outValLen, pageIdx,
+                                                                          &expectedCount);
+                            ASSERT_EQ(fixedPointPage(value, decimals, outValLen, pageIdx, &pageCount), expected)
+                                                        << len << " " << outValLen << " " << (int) pageIdx;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    TEST(BignumDecimal, FixedPointPageEdgeCases) {
+        uint8_t pageCount = 0;
+        EXPECT_EQ(fixedPointPage({}, 18, 35, 0, &pageCount), "0.000000000000000000");
+        EXPECT_EQ(pageCount, 1);
+        EXPECT_EQ(fixedPointPage({0x01}, 18, 35, 0, &pageCount), "0.000000000000000001");
+        // 10^18 is one whole unit
+        EXPECT_EQ(fixedPointPage({0x0d, 0xe0, 0xb6, 0xb3, 0xa7, 0x64, 0x00, 0x00}, 18, 35, 0, &pageCount),
+                  "1.000000000000000000");
+        EXPECT_EQ(fixedPointPage({0x0d, 0xe0, 0xb6, 0xb3, 0xa7, 0x64, 0x00, 0x00}, 18, 5, 0, &pageCount), "1.00");
+        EXPECT_EQ(pageCount, 5);
+
+        // no room for a page
+        char page[1] = {'x'};
+        const uint8_t value[] = {0x01};
+        EXPECT_TRUE(bignumBigEndian_to_fpstr_page(page, sizeof(page), value, sizeof(value), 18, 0, &pageCount));
+        EXPECT_EQ(pageCount, 0);
+        EXPECT_EQ(page[0], 0);
+
+        const std::vector<uint8_t> tooLong(BIGNUM_DECIMAL_MAX_LEN + 1, 0xff);
+        char large[40];
+        EXPECT_FALSE(bignumBigEndian_to_fpstr_page(large, sizeof(large), tooLong.data(), tooLong.size(),
+                                                   18, 0, &pageCount));
+    }
+}
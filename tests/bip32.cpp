@@ -0,0 +1,114 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#include "gmock/gmock.h"
+
+#include <string>
+#include <vector>
+#include <hexutils.h>
+#include "bip32.h"
+
+namespace {
+    std::vector<uint8_t> fromHex(const char *hex) {
+        std::vector<uint8_t> bytes(strlen(hex) / 2);
+        bytes.resize(parseHexString(bytes.data(), bytes.size(), hex));
+        return bytes;
+    }
+
+    std::string toHex(const uint8_t *bytes, size_t len) {
+        std::string hex;
+        char digits[3];
+        for (size_t i = 0; i < len; i++) {
+            snprintf(digits, sizeof(digits), "%02x", bytes[i]);
+            hex += digits;
+        }
+        return hex;
+    }
+
+    struct node_t {
+        uint32_t index;
+        const char *chainCode;
+        const char *key;
+        // compressed public key of this node, read when deriving a non-hardened child
+        const char *publicKey;
+    };
+
+    // BIP32 test vector 1: seed 000102030405060708090a0b0c0d0e0f, chain m/0H/1/2H/2/1000000000
+    const node_t VECTOR_1[] = {
+            {0, "873dff81c02f525623fd1fe5167eac3a55a049de3d314bb42ee227ffed37d508",
+                    "e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35",
+                    "0339a36013301597daef41fbe593a02cc513d0b55527ec2df1050e2e8ff49c85c2"},
+            {BIP32_HARDENED | 0, "47fdacbd0f1097043b78c63c20c34ef4ed9a111d980047ad16282c7ae6236141",
+                    "edb2e14f9ee77d26dd93b4ecede8d16ed408ce149b6cd80b0715a2d911a0afea",
+                    "035a784662a4a20a65bf6aab9ae98a6c068a81c52e4b032c0fb5400c706cfccc56"},
+            {1, "2a7857631386ba23dacac34180dd1983734e444fdbf774041578e9b6adb37c19",
+                    "3c6cb8d0f6a264c91ea8b5030fadaa8e538b020f0a387421a12de9319dc93368",
+                    "03501e454bf00751f24b1b489aa925215d66af2234e3891c3b21a52bedb3cd711c"},
+            {BIP32_HARDENED | 2, "04466b9cc8e161e966409ca52986c584f07e9dc81f735db683c3ff6ec7b1503f",
+                    "cbce0d719ecf7431d88e6a89fa1483e02e35092af60c042b1df2ff59fa424dca",
+                    "0357bfe1e341d01c69fe5654309956cbea516822fba8a601743a012a7896ee8dc2"},
+            {2, "cfb71883f01676f587d023cc53a35bc7f88f724b1f8c2892ac1275ac822a3edd",
+                    "0f479245fb19a38a1954c5c7c0ebab2f9bdfd96a17563ef28a6a4b1a2a764ef4",
+                    "02e8445082a72f29b75ca48748a914df60622a609cacfce8ed0e35804560741d29"},
+            {1000000000, "c783e67b921d2beb8f6b389cc646d7263b4145701dadd2161548a8b078e65e9e",
+                    "471b76e389e528d6de6d816857e012c5455051cad6660850e58372a6c3e6e7c8",
+                    "022a471424da5e657499d1ff51cb43c47481a03b1e77f951fe64cec9f5a48f7011"},
+    };
+
+    TEST(BIP32, TestVector1) {
+        // each node from its parent: hardened steps hash the parent key, the others the parent public key
+        for (size_t i = 1; i < sizeof(VECTOR_1) / sizeof(VECTOR_1[0]); i++) {
+            const node_t &parent = VECTOR_1[i - 1];
+            const node_t &child = VECTOR_1[i];
+            const auto parentKey = fromHex(parent.key);
+            const auto parentChainCode = fromHex(parent.chainCode);
+            const auto parentPublicKey = fromHex(parent.publicKey);
+
+            uint8_t childKey[BIP32_KEY_LEN];
+            uint8_t childChainCode[BIP32_CHAIN_CODE_LEN];
+            ASSERT_TRUE(bip32_deriveChildKey(parentKey.data(), parentChainCode.data(), parentPublicKey.data(),
+                                             child.index, childKey, childChainCode)) << i;
+            EXPECT_EQ(toHex(childKey, sizeof(childKey)), child.key) << i;
+            EXPECT_EQ(toHex(childChainCode, sizeof(childChainCode)), child.chainCode) << i;
+
+            // the chain code is optional
+            uint8_t keyOnly[BIP32_KEY_LEN];
+            ASSERT_TRUE(bip32_deriveChildKey(parentKey.data(), parentChainCode.data(), parentPublicKey.data(),
+                                             child.index, keyOnly, nullptr));
+            EXPECT_EQ(toHex(keyOnly, sizeof(keyOnly)), child.key) << i;
+        }
+    }
+
+    TEST(BIP32, ReductionModOrder) {
+        // IL of this chain code and public key at index 0 is f21edf37...e40e25fa. With these parent keys
+        // IL + key is n + 5, which is reduced to 5, and n, which is not a valid key
+        const auto chainCode = fromHex("0101010101010101010101010101010101010101010101010101010101010101");
+        const auto publicKey = fromHex("021111111111111111111111111111111111111111111111111111111111111111");
+        const auto keyReduced = fromHex("0de120c8443202857cc4e4e299145d1a8e123b59b5ac96b912c50aacec281b4c");
+        const auto keyZero = fromHex("0de120c8443202857cc4e4e299145d1a8e123b59b5ac96b912c50aacec281b47");
+
+        uint8_t childKey[BIP32_KEY_LEN];
+        uint8_t childChainCode[BIP32_CHAIN_CODE_LEN];
+        ASSERT_TRUE(bip32_deriveChildKey(keyReduced.data(), chainCode.data(), publicKey.data(), 0,
+                                         childKey, childChainCode));
+        EXPECT_EQ(toHex(childKey, sizeof(childKey)),
+                  "0000000000000000000000000000000000000000000000000000000000000005");
+        EXPECT_EQ(toHex(childChainCode, sizeof(childChainCode)),
+                  "7afcd6e1cbb3cd8fff0f165b03aaf0b2280683fb4f3cee72f8305ad933ea83c9");
+
+        EXPECT_FALSE(bip32_deriveChildKey(keyZero.data(), chainCode.data(), publicKey.data(), 0,
+                                          childKey, childChainCode));
+    }
+}
@@ -0,0 +1,189 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "blake2b_dispatch.h"
+
+namespace {
+    const blake2b_backend_e BACKENDS[] = {
+            blake2b_backend_auto, blake2b_backend_portable, blake2b_backend_sse41, blake2b_backend_avx2,
+    };
+
+    std::string toHex(const uint8_t *data, size_t len) {
+        std::string s;
+        for (size_t i = 0; i < len; i++) {
+            char buf[3];
+            snprintf(buf, sizeof(buf), "%02x", data[i]);
+            s += buf;
+        }
+        return s;
+    }
+
+    // bytes 0, 1, ..., 255, 0, 1, ...
+    std::vector<uint8_t> counting(size_t len) {
+        std::vector<uint8_t> data(len);
+        for (size_t i = 0; i < len; i++) {
+            data[i] = (uint8_t) i;
+        }
+        return data;
+    }
+
+    struct blake2b_vector_t {
+        size_t inputLen;
+        size_t outLen;
+        const char *expected;
+    };
+
+    TEST(Blake2b, KnownVectors) {
+        const blake2b_vector_t vectors[] = {
+                {0,    32, "0e5751c026e543b2e8ab2eb06099daa1d1e5df47778f7787faab45cdf12fe3a8"},
+                {65,   32, "84c04ab082c8ae24206561f77397704b627892089a05887a2a1996472bcfe15d"},
+                {128,  32, "c3582f71ebb2be66fa5dd750f80baae97554f3b015663c8be377cfcb2488c1d1"},
+                {129,  4,  "b382d211"},
+                {4096, 32, "81baab4ea5d75a0aa53b8780ae5dbd7c8dac7f07e7c103644399492bb9ea6f87"},
+        };
+
+        for (const auto &v : vectors) {
+            const auto data = counting(v.inputLen);
+            for (auto backend : BACKENDS) {
+                uint8_t out[BLAKE2B_OUTBYTES];
+                ASSERT_EQ(blake2b_with_backend(backend, out, v.outLen, data.data(), data.size()), 0);
+                EXPECT_EQ(toHex(out, v.outLen), v.expected) << v.inputLen << " backend " << backend;
+            }
+
+            uint8_t out[BLAKE2B_OUTBYTES];
+            ASSERT_EQ(blake2b(out, v.outLen, data.data(), data.size(), nullptr, 0), 0);
+            EXPECT_EQ(toHex(out, v.outLen), v.expected) << v.inputLen;
+        }
+
+        uint8_t out[BLAKE2B_OUTBYTES];
+        ASSERT_EQ(blake2b(out, sizeof(out), "abc", 3, nullptr, 0), 0);
+        EXPECT_EQ(toHex(out, sizeof(out)),
+                  "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+                  "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923");
+    }
+
+    TEST(Blake2b, Keyed) {
+        const auto data = counting(100);
+        const auto key = counting(BLAKE2B_KEYBYTES);
+        uint8_t out[32];
+        ASSERT_EQ(blake2b(out, sizeof(out), data.data(), data.size(), key.data(), key.size()), 0);
+        EXPECT_EQ(toHex(out, sizeof(out)), "4256df58e3bb0047811a87e6a905b5c2a3a901b74dd8120cdda8143d459adb5f");
+    }
+
+    TEST(Blake2b, BackendsAgree) {
+        std::mt19937 rng(18);
+        for (size_t len = 0; len <= 600; len++) {
+            std::vector<uint8_t> data(len);
+            for (auto &b : data) {
+                b = (uint8_t) rng();
+            }
+            const size_t outLen = 1 + rng() % BLAKE2B_OUTBYTES;
+
+            uint8_t expected[BLAKE2B_OUTBYTES];
+            ASSERT_EQ(blake2b_with_backend(blake2b_backend_portable, expected, outLen, data.data(), len), 0);
+            for (auto backend : BACKENDS) {
+                uint8_t out[BLAKE2B_OUTBYTES];
+                ASSERT_EQ(blake2b_with_backend(backend, out, outLen, data.data(), len), 0);
+                ASSERT_EQ(toHex(out, outLen), toHex(expected, outLen)) << len << " backend " << backend;
+            }
+        }
+    }
+
+    TEST(Blake2b, IncrementalSameAsOneShot) {
+        std::mt19937 rng(180);
+        const auto data = counting(1000);
+        for (int round = 0; round < 200; round++) {
+            const size_t len = rng() % data.size();
+
+            uint8_t expected[32];
+            ASSERT_EQ(blake2b(expected, sizeof(expected), data.data(), len, nullptr, 0), 0);
+
+            blake2b_state s;
+            ASSERT_EQ(blake2b_init(&s, sizeof(expected)), 0);
+            size_t offset = 0;
+            while (offset < len) {
+                const size_t chunk = std::min<size_t>(len - offset, rng() % 300);
+                ASSERT_EQ(blake2b_update(&s, data.data() + offset, chunk), 0);
+                offset += chunk;
+            }
+            uint8_t out[32];
+            ASSERT_EQ(blake2b_final(&s, out, sizeof(out)), 0);
+            ASSERT_EQ(toHex(out, sizeof(out)), toHex(expected, sizeof(expected))) << len;
+        }
+    }
+
+    TEST(Blake2b, InvalidParameters) {
+        blake2b_state s;
+        uint8_t out[BLAKE2B_OUTBYTES];
+        EXPECT_EQ(blake2b_init(&s, 0), -1);
+        EXPECT_EQ(blake2b_init(&s, BLAKE2B_OUTBYTES + 1), -1);
+        EXPECT_EQ(blake2b(out, sizeof(out), nullptr, 1, nullptr, 0), -1);
+
+        // output shorter than the digest, and a second final
+        ASSERT_EQ(blake2b_init(&s, 32), 0);
+        EXPECT_EQ(blake2b_final(&s, out, 16), -1);
+        EXPECT_EQ(blake2b_final(&s, out, 32), 0);
+        EXPECT_EQ(blake2b_final(&s, out, 32), -1);
+    }
+
+    TEST(Blake2b, ManySameAsSingle) {
+        std::mt19937 rng(19);
+        for (size_t numItems : {0, 1, 3, 4, 5, 9, 64}) {
+            for (size_t outLen : {4, 20, 32, 64}) {
+                // lengths differ within a group of four, some messages span several blocks
+                std::vector<std::vector<uint8_t>> inputs(numItems);
+                for (auto &input : inputs) {
+                    input.resize(rng() % 3 == 0 ? rng() % 400 : rng() % 80);
+                    for (auto &b : input) {
+                        b = (uint8_t) rng();
+                    }
+                }
+
+                for (auto backend : BACKENDS) {
+                    std::vector<uint8_t> outs(numItems * outLen);
+                    std::vector<blake2b_many_item_t> items(numItems);
+                    for (size_t i = 0; i < numItems; i++) {
+                        items[i].in = inputs[i].data();
+                        items[i].inlen = inputs[i].size();
+                        items[i].out = &outs[i * outLen];
+                    }
+                    ASSERT_EQ(blake2b_many_with_backend(backend, items.data(), numItems, outLen), 0);
+
+                    for (size_t i = 0; i < numItems; i++) {
+                        uint8_t expected[BLAKE2B_OUTBYTES];
+                        blake2b(expected, outLen, inputs[i].data(), inputs[i].size(), nullptr, 0);
+                        ASSERT_EQ(toHex(&outs[i * outLen], outLen), toHex(expected, outLen))
+                                                    << "item " << i << " of " << numItems << " backend " << backend;
+                    }
+                }
+            }
+        }
+
+        uint8_t out[4];
+        blake2b_many_item_t item = {nullptr, 0, out};
+        EXPECT_EQ(blake2b_many(&item, 1, 0), -1);
+        EXPECT_EQ(blake2b_many(&item, 1, BLAKE2B_OUTBYTES + 1), -1);
+        item.inlen = 1;
+        EXPECT_EQ(blake2b_many(&item, 1, sizeof(out)), -1);
+    }
+}
@@ -14,9 +14,14 @@
 *  limitations under the License.
 ********************************************************************************/
 #include <parser.h>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
 #include <sstream>
 #include <string>
 #include <fmt/core.h>
+#include <json/json.h>
+#include <hexutils.h>
 #include "common.h"
 
 std::vector<std::string> dumpUI(parser_context_t *ctx,
@@ -72,3 +77,43 @@ std::vector<std::string> dumpUI(parser_context_t *ctx,
 
     return answer;
 }
+
+std::vector<std::vector<uint8_t>> loadTestVectorBlobs() {
+    auto answer = std::vector<std::vector<uint8_t>>();
+
+    std::ifstream inFile(std::string(TESTVECTORS_DIR) + "testvectors/manual.json");
+    Json::CharReaderBuilder builder;
+    Json::Value obj;
+    JSONCPP_STRING errs;
+    Json::parseFromStream(builder, inFile, &obj, &errs);
+
+    for (auto &i : obj) {
+        const auto hex = i["encoded_tx_hex"].asString();
+        std::vector<uint8_t> blob(hex.size() / 2);
+        blob.resize(parseHexString(blob.data(), blob.size(), hex.c_str()));
+        answer.push_back(blob);
+    }
+    return answer;
+}
+
+std::vector<std::vector<uint8_t>> loadCorpusBlobs(const std::string &name) {
+    auto answer = std::vector<std::vector<uint8_t>>();
+
+    const auto path = std::string(CORPORA_DIR) + name;
+    DIR *dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return answer;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::ifstream inFile(path + "/" + entry->d_name, std::ios::binary);
+        answer.emplace_back(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
+    }
+    closedir(dir);
+
+    return answer;
+}
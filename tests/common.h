@@ -15,6 +15,7 @@
 ********************************************************************************/
 #pragma once
 
+#include <string>
 #include <vector>
 #include <parser.h>
 
@@ -23,3 +24,9 @@ EXPECT_TRUE(!strcmp(_STR1, _STR2)) << _errorMessage << ", expected: " << _STR2 <
 else FAIL() << "One of the strings is null"; }
 
 std::vector<std::string> dumpUI(parser_context_t *ctx, uint16_t maxKeyLen, uint16_t maxValueLen);
+
+// Encoded messages of testvectors/manual.json, in file order
+std::vector<std::vector<uint8_t>> loadTestVectorBlobs();
+
+// Every file of the fuzzing corpus fuzz/corpora/<name>, in directory order
+std::vector<std::vector<uint8_t>> loadCorpusBlobs(const std::string &name);
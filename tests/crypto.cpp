@@ -21,6 +21,11 @@
 #include <crypto.h>
 #include <bignum.h>
 #include <zxformat.h>
+#include <random>
+#include <vector>
+#include "base32.h"
+#include "blake2.h"
+#include "common.h"
 
 extern const char *crypto_testPubKey;
 #define ADDRESS_BYTE_TO_STRING_LEN    (42 + 1)
@@ -179,3 +184,443 @@ TEST(CRYPTO, prepareMessageDigest) {
     EXPECT_THAT(err, ::testing::Eq(0));
 
 }
+
+TEST(CRYPTO, messageCid) {
+    uint8_t input[61];
+    auto inputLen = parseHexString(input, sizeof(input), "885501FD1D0F4DFCD7E99AFCB99A8326B7DC459D32C6285501B882619D46558F3D9E316D11B48DCF211327025A0144000186A0430009C4430061A80040");
+
+    uint8_t cid[MESSAGE_CID_LEN];
+    char cidText[MESSAGE_CID_TEXT_LEN + 1];
+    ASSERT_EQ(message_cid(input, inputLen, cid, sizeof(cid), cidText, sizeof(cidText)), zxerr_ok);
+
+    char cidHex[2 * MESSAGE_CID_LEN + 1];
+    array_to_hexstr(cidHex, sizeof(cidHex), cid, sizeof(cid));
+    EXPECT_EQ(std::string(cidHex), "0171a0e402205172cb7923687da0adb30d0ed180e8cfcb5f1dedd4dd37c546a26d1b9e9a754f");
+    EXPECT_EQ(std::string(cidText), "bafy2bzacebixfs3zenuh3ifnwmgq5uma5dh4wxy55xkn2n6fi2rg2g46tj2u6");
+
+    // the digest that gets signed is the blake2b-256 of the binary CID
+    uint8_t digest[32];
+    uint8_t cidDigest[32];
+    prepareDigestToSign(input, inputLen, digest, sizeof(digest));
+    blake2b(cidDigest, sizeof(cidDigest), cid, sizeof(cid), nullptr, 0);
+    EXPECT_EQ(memcmp(digest, cidDigest, sizeof(digest)), 0);
+
+    ASSERT_EQ(message_cid(input, 0, cid, sizeof(cid), cidText, sizeof(cidText)), zxerr_ok);
+    EXPECT_EQ(std::string(cidText), "bafy2bzaceahfouoae3suhmxivmxlayez3kq5dzo7i53y654h7kvultprf7r2q");
+
+    EXPECT_EQ(message_cid(input, inputLen, cid, sizeof(cid) - 1, cidText, sizeof(cidText)), zxerr_buffer_too_small);
+    EXPECT_EQ(message_cid(input, inputLen, cid, sizeof(cid), cidText, MESSAGE_CID_TEXT_LEN), zxerr_buffer_too_small);
+}
+
+namespace {
+    std::vector<uint8_t> streamedDigest(const std::vector<uint8_t> &blob, const std::vector<size_t> &splits) {
+        crypto_digest_t digest;
+        crypto_digestInit(&digest);
+
+        size_t start = 0;
+        for (size_t split : splits) {
+            crypto_digestUpdate(&digest, blob.data() + start, split - start);
+            start = split;
+        }
+        crypto_digestUpdate(&digest, blob.data() + start, blob.size() - start);
+
+        std::vector<uint8_t> out(BLAKE2B_256_SIZE);
+        EXPECT_EQ(crypto_digestFinal(&digest, out.data(), out.size()), zxerr_ok);
+        return out;
+    }
+
+    std::vector<uint8_t> digestAtOnce(const std::vector<uint8_t> &blob) {
+        std::vector<uint8_t> out(BLAKE2B_256_SIZE);
+        prepareDigestToSign(blob.data(), blob.size(), out.data(), out.size());
+        return out;
+    }
+}
+
+TEST(CRYPTO, streamedDigestEverySplitPoint) {
+    auto blobs = loadTestVectorBlobs();
+    ASSERT_FALSE(blobs.empty());
+
+    // Messages with large params span several blake2b blocks
+    std::mt19937 rng(23);
+    for (size_t len : {127, 128, 129, 300, 1000}) {
+        std::vector<uint8_t> blob(len);
+        for (auto &b : blob) {
+            b = rng() & 0xFF;
+        }
+        blobs.push_back(blob);
+    }
+
+    for (size_t b = 0; b < blobs.size(); b++) {
+        const auto &blob = blobs[b];
+        const auto expected = digestAtOnce(blob);
+
+        for (size_t split = 0; split <= blob.size(); split++) {
+            SCOPED_TRACE(testing::Message() << "vector " << b << " split " << split);
+            EXPECT_EQ(streamedDigest(blob, {split}), expected);
+        }
+    }
+}
+
+TEST(CRYPTO, streamedDigestApduChunks) {
+    const auto blobs = loadTestVectorBlobs();
+    ASSERT_FALSE(blobs.empty());
+
+    for (const auto &blob : blobs) {
+        const auto expected = digestAtOnce(blob);
+
+        for (size_t chunkSize = 1; chunkSize <= blob.size(); chunkSize++) {
+            SCOPED_TRACE(testing::Message() << "chunk size " << chunkSize);
+            std::vector<size_t> splits;
+            for (size_t split = chunkSize; split < blob.size(); split += chunkSize) {
+                splits.push_back(split);
+            }
+            EXPECT_EQ(streamedDigest(blob, splits), expected);
+        }
+    }
+
+    crypto_digest_t digest;
+    crypto_digestInit(&digest);
+    uint8_t out[BLAKE2B_256_SIZE];
+    EXPECT_EQ(crypto_digestFinal(&digest, out, sizeof(out) - 1), zxerr_buffer_too_small);
+}
+
+TEST(CRYPTO, base32EncodeRange) {
+    std::mt19937 rng(77);
+    for (uint32_t len = 1; len <= 52; len++) {
+        std::vector<uint8_t> data(len);
+        for (auto &b : data) {
+            b = (uint8_t) rng();
+        }
+        char full[100];
+        const uint32_t fullLen = base32_encode(data.data(), len, full, sizeof(full));
+        ASSERT_EQ(fullLen, base32_encoded_len(len));
+
+        for (uint32_t first = 0; first <= fullLen; first++) {
+            char part[100];
+            const uint32_t count = base32_encode_range(data.data(), len, first, part, 7);
+            ASSERT_EQ(count, std::min<uint32_t>(7, fullLen - first));
+            ASSERT_EQ(std::string(part, count), std::string(full + first, count)) << len << " " << first;
+        }
+    }
+}
+
+/// Pages of formatProtocolPage are those of formatProtocol + pageString
+TEST(CRYPTO, formatProtocolPage) {
+    std::mt19937 rng(78);
+    std::vector<std::vector<uint8_t>> addresses = {
+            {0x00, 0x81, 0x01},
+            {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01},
+    };
+    for (uint8_t protocol : {1, 2, 3}) {
+        const size_t payloadLen = protocol == 3 ? ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN : ADDRESS_PROTOCOL_SECP256K1_PAYLOAD_LEN;
+        std::vector<uint8_t> address(1 + payloadLen);
+        address[0] = protocol;
+        for (size_t i = 1; i < address.size(); i++) {
+            address[i] = (uint8_t) rng();
+        }
+        addresses.push_back(address);
+    }
+
+    for (const auto &address : addresses) {
+        char full[100] = {};
+        ASSERT_GT(formatProtocol(address.data(), address.size(), (uint8_t *) full, sizeof(full)), 0);
+
+        for (uint16_t outValLen : {2, 17, 35, 41, 100}) {
+            uint8_t expectedCount = 0;
+            char expected[100];
+            pageString(expected, outValLen, full, 0, &expectedCount);
+
+            for (uint8_t pageIdx = 0; pageIdx <= expectedCount; pageIdx++) {
+                uint8_t pageCount = 0;
+                char page[100];
+                memset(page, 'x', sizeof(page));
+                pageString(expected, outValLen, full, pageIdx, &expectedCount);
+                ASSERT_TRUE(formatProtocolPage(address.data(), address.size(), nullptr, page, outValLen, pageIdx, &pageCount));
+                ASSERT_EQ(pageCount, expectedCount);
+                ASSERT_EQ(std::string(page), std::string(expected)) << full << " " << outValLen << " " << (int) pageIdx;
+            }
+        }
+    }
+
+    // invalid addresses
+    uint8_t pageCount = 0;
+    char page[40];
+    const uint8_t shortSecp[] = {0x01, 0x02, 0x03};
+    EXPECT_FALSE(formatProtocolPage(shortSecp, sizeof(shortSecp), nullptr, page, sizeof(page), 0, &pageCount));
+    const uint8_t unknown[] = {0x07, 0x01};
+    EXPECT_FALSE(formatProtocolPage(unknown, sizeof(unknown), nullptr, page, sizeof(page), 0, &pageCount));
+}
+
+TEST(CRYPTO, addressParseRoundTrip) {
+    std::mt19937 rng(79);
+    std::vector<std::vector<uint8_t>> addresses = {
+            {0x00, 0x00},
+            {0x00, 0x81, 0x01},
+            {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01},
+    };
+    for (int i = 0; i < 20; i++) {
+        const uint8_t protocol = 1 + i % 3;
+        std::vector<uint8_t> address(1 + (protocol == 3 ? ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN : 20));
+        address[0] = protocol;
+        for (size_t j = 1; j < address.size(); j++) {
+            address[j] = (uint8_t) rng();
+        }
+        addresses.push_back(address);
+    }
+
+    for (bool testnet : {false, true}) {
+        hdPath[0] = testnet ? HDPATH_0_TESTNET : HDPATH_0_DEFAULT;
+        hdPath[1] = testnet ? HDPATH_1_TESTNET : HDPATH_1_DEFAULT;
+
+        for (const auto &address : addresses) {
+            char text[100] = {};
+            const uint16_t textLen = formatProtocol(address.data(), address.size(), (uint8_t *) text, sizeof(text));
+            ASSERT_GT(textLen, 0);
+
+            uint8_t parsed[64];
+            bool parsedTestnet = !testnet;
+            ASSERT_EQ(address_parse(text, textLen, &parsedTestnet, parsed, sizeof(parsed)), address.size()) << text;
+            EXPECT_EQ(std::vector<uint8_t>(parsed, parsed + address.size()), address) << text;
+            EXPECT_EQ(parsedTestnet, testnet);
+        }
+    }
+
+    hdPath[0] = HDPATH_0_DEFAULT;
+    hdPath[1] = HDPATH_1_DEFAULT;
+}
+
+TEST(CRYPTO, addressParseRejects) {
+    const std::string valid = "f137sjdbgunloi7couiy4l5nc7pd6k2jmq32vizpy";
+    uint8_t parsed[64];
+    bool testnet = false;
+    ASSERT_EQ(address_parse(valid.c_str(), valid.size(), &testnet, parsed, sizeof(parsed)), 21);
+
+    std::vector<std::string> invalid = {
+            "",
+            "f1",
+            "x137sjdbgunloi7couiy4l5nc7pd6k2jmq32vizpy",        // network
+            "f437sjdbgunloi7couiy4l5nc7pd6k2jmq32vizpy",        // protocol
+            "f137sjdbgunloi7couiy4l5nc7pd6k2jmq32vizpa",        // checksum
+            "f137sjdbgunloi7couiy4l5nc7pd6k2jmq32vizp",         // length
+            "f137sjdbgunloi7couiy4l5nc7pd6k2jmq32vizpY",        // alphabet
+            "f237sjdbgunloi7couiy4l5nc7pd6k2jmq32vizpy",        // checksum covers the protocol
+            "f0",
+            "f001",                                             // leading zero
+            "f0-1",
+            "f018446744073709551616",                           // UINT64_MAX + 1
+    };
+    for (const auto &text : invalid) {
+        EXPECT_EQ(address_parse(text.c_str(), text.size(), &testnet, parsed, sizeof(parsed)), 0) << text;
+    }
+
+    const std::string maxId = "f018446744073709551615";
+    EXPECT_EQ(address_parse(maxId.c_str(), maxId.size(), &testnet, parsed, sizeof(parsed)), 11);
+    // output too small
+    EXPECT_EQ(address_parse(valid.c_str(), valid.size(), &testnet, parsed, 20), 0);
+}
+
+TEST(CRYPTO, addressParseBatch) {
+    std::mt19937 rng(80);
+    std::vector<std::string> texts;
+    for (int i = 0; i < 150; i++) {
+        const uint8_t protocol = i % 4;
+        std::vector<uint8_t> address;
+        if (protocol == 0) {
+            address = {0x00, (uint8_t) (0x80 | i), 0x01};
+        } else {
+            address.resize(1 + (protocol == 3 ? ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN : 20));
+            address[0] = protocol;
+            for (size_t j = 1; j < address.size(); j++) {
+                address[j] = (uint8_t) rng();
+            }
+        }
+        char text[100] = {};
+        formatProtocol(address.data(), address.size(), (uint8_t *) text, sizeof(text));
+        std::string s(text);
+        // break some of them
+        if (i % 7 == 3) {
+            s[s.size() - 1] = s[s.size() - 1] == 'a' ? 'b' : 'a';
+        }
+        texts.push_back(s);
+    }
+
+    std::vector<address_batch_item_t> items(texts.size());
+    for (size_t i = 0; i < texts.size(); i++) {
+        items[i].text = texts[i].c_str();
+        items[i].textLen = texts[i].size();
+    }
+    address_parseBatch(items.data(), items.size());
+
+    for (size_t i = 0; i < texts.size(); i++) {
+        uint8_t parsed[64];
+        bool testnet = true;
+        const uint16_t len = address_parse(texts[i].c_str(), texts[i].size(), &testnet, parsed, sizeof(parsed));
+        ASSERT_EQ(items[i].addressLen, len) << texts[i];
+        if (len > 0) {
+            EXPECT_EQ(memcmp(items[i].address, parsed, len), 0);
+            EXPECT_EQ(items[i].testnet, testnet);
+        }
+    }
+}
+
+TEST(CRYPTO, formatProtocolBatch) {
+    std::mt19937 rng(81);
+    std::vector<std::vector<uint8_t>> addresses;
+    for (int i = 0; i < 150; i++) {
+        const uint8_t protocol = i % 5;
+        std::vector<uint8_t> address;
+        if (protocol == 0) {
+            address = {0x00, (uint8_t) (0x80 | i), 0x01};
+        } else {
+            address.resize(1 + (protocol == 3 ? ADDRESS_PROTOCOL_BLS_PAYLOAD_LEN : 20));
+            address[0] = protocol;
+            for (size_t j = 1; j < address.size(); j++) {
+                address[j] = (uint8_t) rng();
+            }
+        }
+        // and some invalid ones: wrong length, unknown protocol (4 above), truncated LEB128
+        if (i % 11 == 5) {
+            address.pop_back();
+        }
+        addresses.push_back(address);
+    }
+
+    std::vector<const uint8_t *> pointers;
+    std::vector<uint16_t> lens;
+    for (const auto &address : addresses) {
+        pointers.push_back(address.data());
+        lens.push_back(address.size());
+    }
+
+    const uint16_t formattedSize = 100;
+    std::vector<uint8_t> formatted(addresses.size() * formattedSize);
+    std::vector<uint16_t> formattedLens(addresses.size());
+    formatProtocolBatch(pointers.data(), lens.data(), addresses.size(),
+                        formatted.data(), formattedSize, formattedLens.data());
+
+    for (size_t i = 0; i < addresses.size(); i++) {
+        uint8_t expected[formattedSize] = {};
+        const uint16_t expectedLen = formatProtocol(addresses[i].data(), addresses[i].size(), expected, formattedSize);
+        ASSERT_EQ(formattedLens[i], expectedLen) << i;
+        EXPECT_EQ(std::string((const char *) &formatted[i * formattedSize], expectedLen),
+                  std::string((const char *) expected, expectedLen));
+    }
+}
+
+TEST(CRYPTO, addressFromPublicKeyBatch) {
+    uint8_t buffer[200];
+    crypto_testPubKey = nullptr;
+    uint16_t addrLen;
+    ASSERT_EQ(crypto_fillAddress(buffer, sizeof(buffer), &addrLen), zxerr_ok);
+    const uint8_t *expected = buffer + SECP256K1_PK_LEN + 1;
+
+    // the test key and variations of it, the first one must give crypto_fillAddress' address
+    std::vector<uint8_t> keys(11 * SECP256K1_PK_LEN);
+    for (size_t i = 0; i < 11; i++) {
+        memcpy(&keys[i * SECP256K1_PK_LEN], buffer, SECP256K1_PK_LEN);
+        keys[i * SECP256K1_PK_LEN + 1 + i] ^= (uint8_t) i;
+    }
+    std::vector<uint8_t> addresses(11 * 21);
+    addressFromPublicKeyBatch((const uint8_t (*)[SECP256K1_PK_LEN]) keys.data(), 11,
+                              (uint8_t (*)[21]) addresses.data());
+
+    EXPECT_EQ(memcmp(addresses.data(), expected, 21), 0);
+    for (size_t i = 1; i < 11; i++) {
+        const uint8_t *address = &addresses[i * 21];
+        EXPECT_EQ(address[0], ADDRESS_PROTOCOL_SECP256K1);
+        EXPECT_NE(memcmp(address, expected, 21), 0);
+
+        // formatting and parsing it back checks the payload against the checksum of the batch
+        char text[100] = {};
+        const uint16_t textLen = formatProtocol(address, 21, (uint8_t *) text, sizeof(text));
+        uint8_t parsed[64];
+        bool testnet;
+        ASSERT_EQ(address_parse(text, textLen, &testnet, parsed, sizeof(parsed)), 21);
+    }
+}
+
+TEST(CRYPTO, fillAddressBatch) {
+    uint8_t buffer[200];
+    crypto_testPubKey = nullptr;
+    uint16_t addrLen;
+    ASSERT_EQ(crypto_fillAddress(buffer, sizeof(buffer), &addrLen), zxerr_ok);
+    const uint8_t *expected = buffer + SECP256K1_PK_LEN + 1;
+
+    // the test key does not depend on the path: every entry, across key chunks, is the same address
+    const uint32_t path[HDPATH_LEN_DEFAULT] = {HDPATH_0_DEFAULT, HDPATH_1_DEFAULT, HDPATH_2_DEFAULT,
+                                               HDPATH_3_DEFAULT, HDPATH_4_DEFAULT};
+    std::vector<uint8_t> addresses(UINT8_MAX * ADDRESS_SECP256K1_BYTES_LEN);
+    ASSERT_EQ(crypto_fillAddressBatch(path, UINT8_MAX, addresses.data(), addresses.size()), zxerr_ok);
+    for (size_t i = 0; i < UINT8_MAX; i++) {
+        EXPECT_EQ(memcmp(&addresses[i * ADDRESS_SECP256K1_BYTES_LEN], expected, ADDRESS_SECP256K1_BYTES_LEN), 0) << i;
+    }
+
+    EXPECT_EQ(crypto_fillAddressBatch(path, UINT8_MAX, addresses.data(), addresses.size() - 1),
+              zxerr_buffer_too_small);
+}
+
+namespace {
+    // Reference: the byte per iteration decoder decompressLEB128 was written as
+    uint8_t decompressLEB128Bytewise(const uint8_t *input, uint16_t inputSize, uint64_t *v) {
+        *v = 0;
+        uint16_t shift = 0;
+        for (unsigned int i = 0; i < 10u && i < inputSize; i++, shift += 7) {
+            const uint64_t b = input[i] & 0x7fu;
+            if (shift >= 63 && b > 1) {
+                break;
+            }
+            *v |= b << shift;
+            if (!(input[i] & 0x80u)) {
+                return 1;
+            }
+        }
+        *v = 0;
+        return 0;
+    }
+}
+
+TEST(CRYPTO, decompressLEB128SameAsBytewise) {
+    std::mt19937 rng(81);
+    for (int i = 0; i < 200000; i++) {
+        uint8_t input[12];
+        const uint16_t inputSize = rng() % (sizeof(input) + 1);
+        // mostly continuation bits, so that every terminator position shows up
+        for (auto &b : input) {
+            b = (uint8_t) rng() | ((rng() % 4 != 0) ? 0x80 : 0x00);
+        }
+
+        uint64_t expected = 1;
+        uint64_t output = 1;
+        const uint8_t expectedRet = decompressLEB128Bytewise(input, inputSize, &expected);
+        ASSERT_EQ(decompressLEB128(input, inputSize, &output), expectedRet);
+        ASSERT_EQ(output, expected);
+    }
+}
+
+TEST(CRYPTO, compressLEB128RoundTrip) {
+    std::mt19937_64 rng(82);
+    for (int i = 0; i < 10000; i++) {
+        // values of every length
+        const uint64_t v = rng() >> (rng() % 64);
+        uint8_t encoded[10];
+        const uint8_t len = compressLEB128(v, encoded, sizeof(encoded));
+        ASSERT_GT(len, 0);
+        ASSERT_EQ(encoded[len - 1] & 0x80, 0);
+        // minimal: only zero ends with a zero byte
+        ASSERT_TRUE(len == 1 || encoded[len - 1] != 0);
+
+        uint64_t decoded = 0;
+        ASSERT_EQ(decompressLEB128(encoded, len, &decoded), 1);
+        ASSERT_EQ(decoded, v);
+        EXPECT_EQ(compressLEB128(v, encoded, len - 1), 0);
+    }
+
+    uint8_t encoded[10];
+    EXPECT_EQ(compressLEB128(0, encoded, sizeof(encoded)), 1);
+    EXPECT_EQ(encoded[0], 0);
+    EXPECT_EQ(compressLEB128(0x81, encoded, sizeof(encoded)), 2);
+    EXPECT_EQ(encoded[0], 0x81);
+    EXPECT_EQ(encoded[1], 0x01);
+    EXPECT_EQ(compressLEB128(UINT64_MAX, encoded, sizeof(encoded)), 10);
+    EXPECT_EQ(encoded[9], 0x01);
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <random>
+#include <string>
+#include <vector>
+#include <hexutils.h>
+#include <zxformat.h>
+#include "hex_codec.h"
+
+namespace {
+    const hex_backend_e BACKENDS[] = {
+            hex_backend_auto, hex_backend_scalar, hex_backend_ssse3, hex_backend_avx2,
+    };
+
+    TEST(HexCodec, EncodeSameAsZxlib) {
+        std::mt19937 rng(22);
+        for (uint32_t count = 0; count <= 255; count++) {
+            std::vector<uint8_t> data(count);
+            for (auto &b : data) {
+                b = (uint8_t) rng();
+            }
+
+            // exact fit, one byte short and plenty of room
+            for (uint32_t dstLen : {2 * count + 1, 2 * count, 2 * count + 9}) {
+                std::vector<char> expected(dstLen + 8, 'x');
+                const uint32_t expectedLen = array_to_hexstr(expected.data(), dstLen, data.data(), (uint8_t) count);
+
+                for (auto backend : BACKENDS) {
+                    std::vector<char> actual(dstLen + 8, 'x');
+                    ASSERT_EQ(hex_encode_backend(backend, actual.data(), dstLen, data.data(), count), expectedLen);
+                    ASSERT_EQ(actual, expected) << count << " backend " << backend;
+                }
+            }
+        }
+    }
+
+    TEST(HexCodec, EncodeRange) {
+        std::mt19937 rng(220);
+        std::vector<uint8_t> data(300);
+        for (auto &b : data) {
+            b = (uint8_t) rng();
+        }
+        std::vector<char> full(2 * data.size() + 1);
+        ASSERT_EQ(hex_encode(full.data(), full.size(), data.data(), data.size()), 2 * data.size());
+
+        for (int i = 0; i < 2000; i++) {
+            const uint32_t firstChar = rng() % (2 * data.size());
+            const uint32_t count = rng() % (2 * data.size() - firstChar + 1);
+            std::string out(count + 2, 'x');
+            hex_encode_range(data.data(), firstChar, &out[1], count);
+            EXPECT_EQ(out, "x" + std::string(&full[firstChar], count) + "x") << firstChar << " " << count;
+        }
+    }
+
+    // Compares the return value and every byte of out, which keeps the pairs before an invalid one
+    void expectDecodeSameAsZxlib(const std::string &input, uint16_t outLen) {
+        std::vector<uint8_t> expected(outLen + 8, 0xAA);
+        const size_t expectedLen = parseHexString(expected.data(), outLen, input.c_str());
+
+        for (auto backend : BACKENDS) {
+            std::vector<uint8_t> actual(outLen + 8, 0xAA);
+            ASSERT_EQ(hex_decode_backend(backend, actual.data(), outLen, input.c_str()), expectedLen)
+                                        << input << " backend " << backend;
+            ASSERT_EQ(actual, expected) << input << " backend " << backend;
+        }
+    }
+
+    TEST(HexCodec, DecodeSameAsZxlib) {
+        std::mt19937 rng(221);
+        const std::string digits = "0123456789abcdefABCDEF";
+        for (size_t len = 0; len <= 300; len++) {
+            std::string input(len, '0');
+            for (auto &c : input) {
+                c = digits[rng() % digits.size()];
+            }
+            expectDecodeSameAsZxlib(input, 160);
+            expectDecodeSameAsZxlib(input, (uint16_t) (len / 2));
+            expectDecodeSameAsZxlib(input, (uint16_t) (len / 2 > 0 ? len / 2 - 1 : 0));
+
+            // one invalid character, anywhere
+            if (len > 0) {
+                std::string invalid = input;
+                invalid[rng() % len] = "gG/:@`\x7f\x80\xff "[rng() % 10];
+                expectDecodeSameAsZxlib(invalid, 160);
+            }
+        }
+    }
+
+    TEST(HexCodec, DecodeEveryCharacter) {
+        // each character in every position of a SIMD block
+        for (int c = 1; c < 256; c++) {
+            for (size_t pos = 0; pos < 64; pos++) {
+                std::string input(64, 'a');
+                input[pos] = (char) c;
+                expectDecodeSameAsZxlib(input, 32);
+            }
+        }
+    }
+}
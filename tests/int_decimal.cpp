@@ -0,0 +1,118 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <zxformat.h>
+#include "int_decimal.h"
+
+namespace {
+    // Values around every change in the number of digits, and around powers of two
+    std::vector<uint64_t> boundaryValues() {
+        std::vector<uint64_t> values = {0, UINT64_MAX, UINT64_MAX - 1, INT64_MAX, (uint64_t) INT64_MAX + 1};
+        uint64_t power = 1;
+        for (int k = 0; k < 20; k++) {
+            values.push_back(power - 1);
+            values.push_back(power);
+            values.push_back(power + 1);
+            values.push_back(power * 9 + (power - 1));
+            if (k < 19) {
+                power *= 10;
+            }
+        }
+        for (int k = 0; k < 64; k++) {
+            values.push_back((1ULL << k) - 1);
+            values.push_back(1ULL << k);
+        }
+        std::mt19937_64 rng(21);
+        for (int i = 0; i < 2000; i++) {
+            values.push_back(rng() >> (rng() % 64));
+        }
+        return values;
+    }
+
+    const size_t BUFFER_SIZE = 32;
+
+    // Compares return value and the whole buffer, including what is written when the text does not fit
+    template<typename T, typename F, typename G>
+    void expectSameAsZxlib(T value, F expected, G actual) {
+        for (int dataLen = 0; dataLen <= 24; dataLen++) {
+            char expectedBuf[BUFFER_SIZE];
+            char actualBuf[BUFFER_SIZE];
+            memset(expectedBuf, 'x', sizeof(expectedBuf));
+            memset(actualBuf, 'x', sizeof(actualBuf));
+
+            const char *expectedErr = expected(expectedBuf, dataLen, value);
+            const char *actualErr = actual(actualBuf, dataLen, value);
+
+            ASSERT_EQ(expectedErr == nullptr, actualErr == nullptr) << value << " len " << dataLen;
+            if (expectedErr != nullptr) {
+                ASSERT_STREQ(expectedErr, actualErr);
+            }
+            ASSERT_EQ(std::string(expectedBuf, sizeof(expectedBuf)), std::string(actualBuf, sizeof(actualBuf)))
+                                        << value << " len " << dataLen;
+        }
+    }
+
+    TEST(IntDecimal, DigitCount) {
+        for (uint64_t v : boundaryValues()) {
+            EXPECT_EQ(decimal_digitCount(v), std::to_string(v).size()) << v;
+        }
+    }
+
+    TEST(IntDecimal, Uint64SameAsZxlib) {
+        for (uint64_t v : boundaryValues()) {
+            expectSameAsZxlib(v, uint64_to_str, uint64_to_decimal);
+        }
+    }
+
+    TEST(IntDecimal, Int64SameAsZxlib) {
+        std::vector<int64_t> values = {INT64_MIN, INT64_MIN + 1, INT64_MAX};
+        for (uint64_t v : boundaryValues()) {
+            values.push_back((int64_t) v);
+            values.push_back(-(int64_t) (v & INT64_MAX));
+        }
+        for (int64_t v : values) {
+            expectSameAsZxlib(v, int64_to_str, int64_to_decimal);
+        }
+    }
+
+    TEST(IntDecimal, FixedPointSameAsZxlib) {
+        for (uint64_t v : boundaryValues()) {
+            for (uint8_t decimals : {0, 1, 2, 18, 19, 20, 22}) {
+                for (uint16_t outLen = 0; outLen <= 26; outLen++) {
+                    char expected[BUFFER_SIZE];
+                    char actual[BUFFER_SIZE];
+                    memset(expected, 'x', sizeof(expected));
+                    memset(actual, 'x', sizeof(actual));
+                    // both measure the text with strlen, also when nothing was written (outLen 0)
+                    expected[BUFFER_SIZE - 1] = 0;
+                    actual[BUFFER_SIZE - 1] = 0;
+
+                    const uint16_t expectedLen = fpuint64_to_str(expected, outLen, v, decimals);
+                    const uint16_t actualLen = fpuint64_to_decimal(actual, outLen, v, decimals);
+                    ASSERT_EQ(expectedLen, actualLen) << v << " decimals " << (int) decimals << " len " << outLen;
+                    ASSERT_EQ(std::string(expected, sizeof(expected)), std::string(actual, sizeof(actual)))
+                                                << v << " decimals " << (int) decimals << " len " << outLen;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include "parser.h"
+#include "parser_batch.h"
+#include "common.h"
+
+namespace {
+    parser_error_t serialResult(const std::vector<uint8_t> &blob) {
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, blob.data(), blob.size());
+        if (err != parser_ok) {
+            return err;
+        }
+        return parser_validate(&ctx);
+    }
+
+    TEST(ParserBatch, MatchesSerialResults) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        const auto blobs = loadTestVectorBlobs();
+        ASSERT_FALSE(blobs.empty());
+
+        // Repeat the vectors so that every worker gets a share and has something to steal
+        std::vector<parser_batch_item_t> items;
+        std::vector<parser_error_t> expected;
+        for (int r = 0; r < 50; r++) {
+            for (const auto &blob : blobs) {
+                items.push_back({blob.data(), blob.size()});
+                expected.push_back(serialResult(blob));
+            }
+        }
+
+        for (uint32_t threads : {0u, 1u, 2u, 3u, 8u}) {
+            std::vector<parser_error_t> results(items.size(), parser_unexepected_error);
+            ASSERT_EQ(parser_batch_validate(items.data(), items.size(), results.data(), threads), parser_ok);
+            EXPECT_EQ(results, expected) << threads << " threads";
+        }
+    }
+
+    TEST(ParserBatch, Empty) {
+        EXPECT_EQ(parser_batch_validate(nullptr, 0, nullptr, 4), parser_ok);
+    }
+}
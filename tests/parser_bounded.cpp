@@ -0,0 +1,337 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#include "gmock/gmock.h"
+
+#include <hexutils.h>
+#include "parser.h"
+#include "parser_bounded.h"
+#include "crypto.h"
+#include "common.h"
+
+namespace {
+    using blob_t = std::vector<uint8_t>;
+
+    // Message up to and including method 0, see buildMessage
+    const char *TX_PREFIX = "8a005501fd1d0f4dfcd7e99afcb99a8326b7dc459d32c6285501b882619d46558f3d9e316d11b48dcf211327025a0144000186a01961a8420000430009c400";
+
+    void appendHeader(blob_t &blob, uint8_t majorType, uint64_t len) {
+        if (len < 24) {
+            blob.push_back((majorType << 5) | len);
+            return;
+        }
+        const uint8_t bytes = len <= 0xFF ? 1 : len <= 0xFFFF ? 2 : len <= 0xFFFFFFFF ? 4 : 8;
+        blob.push_back((majorType << 5) | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27));
+        for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8) {
+            blob.push_back((len >> shift) & 0xFF);
+        }
+    }
+
+    /// Message calling method with the given params
+    blob_t buildMessage(uint8_t method, const blob_t &params) {
+        const std::string prefix = TX_PREFIX;
+        blob_t blob(prefix.size() / 2);
+        blob.resize(parseHexString(blob.data(), blob.size(), prefix.c_str()));
+        // drop method 0, which is the last byte of the prefix
+        blob.pop_back();
+        blob.push_back(method);
+        appendHeader(blob, 2, params.size());
+        blob.insert(blob.end(), params.begin(), params.end());
+        return blob;
+    }
+
+    /// Params made of a single byte string of the given length
+    blob_t largeParams(size_t len) {
+        blob_t params;
+        appendHeader(params, 4, 1);
+        appendHeader(params, 2, len);
+        for (size_t i = 0; i < len; i++) {
+            params.push_back(i * 31 + 7);
+        }
+        return params;
+    }
+
+    struct bounded_reader_t {
+        uint8_t window[384];
+        parser_tx_t tx;
+        parser_bounded_t bounded;
+        parser_context_t ctx;
+
+        explicit bounded_reader_t(parser_size_t windowSize = sizeof(window), uint64_t bufferedMaxLen = 0) {
+            parser_bounded_init(&bounded, &tx, window, windowSize, bufferedMaxLen);
+        }
+
+        parser_error_t read(const blob_t &blob, size_t chunkSize) {
+            for (size_t start = 0; start < blob.size(); start += chunkSize) {
+                const size_t len = std::min(chunkSize, blob.size() - start);
+                // the chunk does not outlive the call
+                const blob_t chunk(blob.begin() + start, blob.begin() + start + len);
+                const auto err = parser_bounded_update(&bounded, chunk.data(), chunk.size());
+                if (err != parser_ok) {
+                    return err;
+                }
+            }
+            const auto err = parser_bounded_finish(&bounded, &ctx);
+            if (err != parser_ok) {
+                return err;
+            }
+            return parser_bounded_validate(&bounded, &ctx);
+        }
+
+        std::string item(uint8_t displayIdx, uint8_t pageIdx = 0) {
+            char key[40];
+            char value[40];
+            uint8_t pageCount = 0;
+            EXPECT_EQ(parser_bounded_getItem(&bounded, &ctx, displayIdx, key, sizeof(key),
+                                             value, sizeof(value), pageIdx, &pageCount), parser_ok);
+            return std::string(key) + value;
+        }
+    };
+
+    std::string regularItem(const parser_context_t *ctx, uint8_t displayIdx) {
+        char key[40];
+        char value[40];
+        uint8_t pageCount = 0;
+        EXPECT_EQ(parser_getItem_r(ctx, displayIdx, key, sizeof(key), value, sizeof(value), 0, &pageCount), parser_ok);
+        return std::string(key) + value;
+    }
+
+    std::string cidText(const blob_t &blob) {
+        uint8_t cid[MESSAGE_CID_LEN];
+        char text[MESSAGE_CID_TEXT_LEN + 1];
+        EXPECT_EQ(message_cid(blob.data(), blob.size(), cid, sizeof(cid), text, sizeof(text)), zxerr_ok);
+        return text;
+    }
+
+    /// Checks the bounded reader against the regular parser on a message the regular parser accepts
+    void checkMatchesRegular(const blob_t &blob, size_t chunkSize) {
+        parser_tx_t tx;
+        parser_context_t ctx;
+        ASSERT_EQ(parser_parse_r(&ctx, blob.data(), blob.size(), &tx), parser_ok);
+        ASSERT_EQ(parser_validate_r(&ctx), parser_ok);
+
+        bounded_reader_t reader;
+        ASSERT_EQ(reader.read(blob, chunkSize), parser_ok);
+
+        // the review starts with the warning
+        EXPECT_EQ(reader.item(0), "Warning Params not shown, check the CID");
+        for (uint8_t idx = 0; idx < PARSER_BOUNDED_FIELD_ITEMS; idx++) {
+            EXPECT_EQ(reader.item(PARSER_BOUNDED_FIRST_FIELD + idx), regularItem(&ctx, idx)) << "item " << (int) idx;
+        }
+
+        uint8_t numItems = 0;
+        ASSERT_EQ(parser_bounded_getNumItems(&reader.bounded, &numItems), parser_ok);
+        const size_t paramsLen = tx.params.len;
+        const uint8_t paramsIdx = PARSER_BOUNDED_FIRST_FIELD + PARSER_BOUNDED_FIELD_ITEMS;
+        if (paramsLen > 0) {
+            ASSERT_EQ(numItems, paramsIdx + 2);
+            EXPECT_EQ(reader.item(paramsIdx), "Params " + std::to_string(paramsLen) + " bytes");
+        } else {
+            ASSERT_EQ(numItems, paramsIdx + 1);
+        }
+
+        // the CID is paged like any other value
+        const auto cid = cidText(blob);
+        std::string shownCid;
+        for (uint8_t page = 0; shownCid.size() < cid.size(); page++) {
+            shownCid += reader.item(numItems - 1, page).substr(std::string("Message CID ").size());
+        }
+        EXPECT_EQ(shownCid, cid);
+
+        uint8_t expected[BLAKE2B_256_SIZE];
+        prepareDigestToSign(blob.data(), blob.size(), expected, sizeof(expected));
+        const uint8_t *digest = parser_bounded_digest(&reader.bounded);
+        ASSERT_NE(digest, nullptr);
+        EXPECT_EQ(blob_t(digest, digest + BLAKE2B_256_SIZE), blob_t(expected, expected + sizeof(expected)));
+    }
+
+    TEST(ParserBounded, MatchesRegularParser) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        size_t accepted = 0;
+        for (const auto &blob : loadTestVectorBlobs()) {
+            parser_tx_t tx;
+            parser_context_t ctx;
+            if (parser_parse_r(&ctx, blob.data(), blob.size(), &tx) != parser_ok || parser_validate_r(&ctx) != parser_ok) {
+                continue;
+            }
+            accepted++;
+
+            for (size_t chunkSize : {1, 7, 64, 250, 100000}) {
+                SCOPED_TRACE(testing::Message() << "chunk size " << chunkSize);
+                checkMatchesRegular(blob, chunkSize);
+            }
+        }
+        EXPECT_GT(accepted, 0u);
+    }
+
+    TEST(ParserBounded, LargerThanFlashBuffer) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        // Larger than FLASH_BUFFER_SIZE on every device, read with a window the size of the Nano S RAM buffer
+        const auto blob = buildMessage(4, largeParams(70000));
+        ASSERT_GT(blob.size(), 65536u);
+
+        bounded_reader_t reader;
+        ASSERT_EQ(reader.read(blob, 250), parser_ok);
+        EXPECT_EQ(reader.item(PARSER_BOUNDED_FIRST_FIELD + 7), "Method 4");
+        // array header, byte string header (5 bytes) and its payload
+        EXPECT_EQ(reader.item(PARSER_BOUNDED_FIRST_FIELD + PARSER_BOUNDED_FIELD_ITEMS), "Params 70006 bytes");
+
+        uint8_t expected[BLAKE2B_256_SIZE];
+        prepareDigestToSign(blob.data(), blob.size(), expected, sizeof(expected));
+        const uint8_t *digest = parser_bounded_digest(&reader.bounded);
+        ASSERT_NE(digest, nullptr);
+        EXPECT_EQ(memcmp(digest, expected, sizeof(expected)), 0);
+
+        // smaller messages with params are shown as the regular parser shows them
+        checkMatchesRegular(buildMessage(2, largeParams(20)), 3);
+    }
+
+    TEST(ParserBounded, Errors) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        const auto blob = buildMessage(4, largeParams(1000));
+
+        // message still incomplete
+        {
+            bounded_reader_t reader;
+            const blob_t truncated(blob.begin(), blob.end() - 1);
+            EXPECT_EQ(reader.read(truncated, 64), parser_cbor_unexpected_EOF);
+            EXPECT_EQ(parser_bounded_digest(&reader.bounded), nullptr);
+        }
+        {
+            bounded_reader_t reader;
+            EXPECT_EQ(reader.read(blob_t(blob.begin(), blob.begin() + 20), 64), parser_cbor_unexpected_EOF);
+        }
+
+        // bytes after the params
+        {
+            bounded_reader_t reader;
+            auto longer = blob;
+            longer.push_back(0x00);
+            EXPECT_EQ(reader.read(longer, 64), parser_unexpected_characters);
+        }
+
+        // fields that do not fit in the window
+        {
+            bounded_reader_t reader(40);
+            EXPECT_EQ(reader.read(blob, 64), parser_value_out_of_range);
+        }
+
+        // params must be an array or a map
+        {
+            bounded_reader_t reader;
+            EXPECT_EQ(reader.read(buildMessage(2, blob_t{0x01}), 1), parser_unexpected_type);
+        }
+
+        // method 0 has no params
+        {
+            bounded_reader_t reader;
+            EXPECT_EQ(reader.read(buildMessage(0, largeParams(4)), 64), parser_unexpected_number_items);
+        }
+
+        // errors in the fields are those of the regular parser, and stick
+        {
+            auto badVersion = blob;
+            badVersion[1] = 0x01;
+            bounded_reader_t reader;
+            EXPECT_EQ(parser_bounded_update(&reader.bounded, badVersion.data(), badVersion.size()),
+                      parser_unexpected_tx_version);
+            EXPECT_EQ(parser_bounded_update(&reader.bounded, badVersion.data(), 1), parser_unexpected_tx_version);
+            EXPECT_EQ(parser_bounded_finish(&reader.bounded, &reader.ctx), parser_unexpected_tx_version);
+        }
+    }
+
+    parser_error_t readParams(const blob_t &params, size_t chunkSize) {
+        bounded_reader_t reader;
+        return reader.read(buildMessage(2, params), chunkSize);
+    }
+
+    TEST(ParserBounded, ParamsStructure) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        // [{1: "abc", h'0102': [-5, 2.5, 42(h'0102'), true, simple(32)]}, [], "", 255]
+        const blob_t nested = {0x84,
+                               0xa2, 0x01, 0x63, 'a', 'b', 'c',
+                               0x42, 0x01, 0x02,
+                               0x85, 0x24, 0xf9, 0x41, 0x00, 0xd8, 0x2a, 0x42, 0x01, 0x02, 0xf5, 0xf8, 0x20,
+                               0x80, 0x60, 0x18, 0xff};
+        // heads and strings split at every point
+        for (size_t chunkSize = 1; chunkSize <= nested.size() + 200; chunkSize++) {
+            EXPECT_EQ(readParams(nested, chunkSize), parser_ok) << "chunk size " << chunkSize;
+        }
+
+        // containers as deep as allowed, and as many params as the regular parser takes
+        blob_t deep(PARSER_BOUNDED_PARAMS_MAX_DEPTH, 0x81);
+        deep.push_back(0x01);
+        EXPECT_EQ(readParams(deep, 1), parser_ok);
+        blob_t manyParams = {0x98, MAX_PARAMS_COUNT};
+        manyParams.insert(manyParams.end(), MAX_PARAMS_COUNT, 0x01);
+        EXPECT_EQ(readParams(manyParams, 7), parser_ok);
+
+        struct bad_params_t {
+            const char *name;
+            blob_t params;
+            parser_error_t expected;
+        } BAD_PARAMS[] = {
+                {"bytes after the container", {0x81, 0x01, 0x00}, parser_unexpected_characters},
+                {"container not complete", {0x82, 0x42, 0x01, 0x02}, parser_cbor_unexpected_EOF},
+                {"tag without its item", {0x81, 0xc1}, parser_cbor_unexpected_EOF},
+                {"more items than bytes", {0x83, 0x01, 0x01}, parser_unexpected_buffer_end},
+                {"string longer than the params", {0x81, 0x45, 0x01}, parser_unexpected_buffer_end},
+                {"indefinite length", {0x81, 0x9f, 0x01, 0xff}, parser_cbor_unexpected},
+                {"break outside a container", {0x82, 0x01, 0xff}, parser_cbor_unexpected},
+                {"reserved additional information", {0x81, 0x1c}, parser_cbor_unexpected},
+                {"one byte simple value below 32", {0x81, 0xf8, 0x10}, parser_cbor_unexpected},
+                {"tagged params", {0xc1, 0x80}, parser_unexpected_type},
+                {"too many params", {0x98, MAX_PARAMS_COUNT + 1}, parser_value_out_of_range},
+        };
+        for (const auto &bad : BAD_PARAMS) {
+            for (size_t chunkSize : {1, 2, 64}) {
+                EXPECT_EQ(readParams(bad.params, chunkSize), bad.expected) << bad.name << ", chunk size " << chunkSize;
+            }
+        }
+
+        blob_t tooDeep(PARSER_BOUNDED_PARAMS_MAX_DEPTH + 1, 0x81);
+        tooDeep.push_back(0x01);
+        EXPECT_EQ(readParams(tooDeep, 1), parser_value_out_of_range);
+
+        // a bad param is reported with the chunk that holds it, before the message is complete
+        const auto blob = buildMessage(2, {0x82, 0x9f, 0x01, 0xff, 0x01});
+        bounded_reader_t reader;
+        EXPECT_EQ(parser_bounded_update(&reader.bounded, blob.data(), blob.size() - 2), parser_cbor_unexpected);
+    }
+
+    TEST(ParserBounded, MessagesThatFitTheBuffer) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        const auto blob = buildMessage(4, largeParams(1000));
+        {
+            bounded_reader_t reader(384, blob.size());
+            EXPECT_EQ(reader.read(blob, 64), parser_stream_not_needed);
+            EXPECT_EQ(parser_bounded_digest(&reader.bounded), nullptr);
+        }
+        {
+            bounded_reader_t reader(384, blob.size() - 1);
+            EXPECT_EQ(reader.read(blob, 64), parser_ok);
+        }
+    }
+}
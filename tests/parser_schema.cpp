@@ -0,0 +1,132 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <cstring>
+#include <hexutils.h>
+#include "parser.h"
+#include "common.h"
+
+namespace {
+    const char *TX_SECP256K1 = "8a005501fd1d0f4dfcd7e99afcb99a8326b7dc459d32c6285501b882619d46558f3d9e316d11b48dcf211327025a0144000186a01961a8420000430009c40040";
+
+    std::vector<std::vector<uint8_t>> loadBlobs() {
+        auto answer = loadTestVectorBlobs();
+        const auto corpus = loadCorpusBlobs("parser_parse");
+        answer.insert(answer.end(), corpus.begin(), corpus.end());
+        return answer;
+    }
+
+    // tinycbor only
+    parser_error_t readGeneric(parser_context_t *ctx, const std::vector<uint8_t> &blob, parser_tx_t *tx) {
+        const auto err = parser_init(ctx, blob.data(), blob.size());
+        if (err != parser_ok) {
+            return err;
+        }
+        ctx->tx_obj = tx;
+        return _read(ctx, tx);
+    }
+
+    void expectSameTx(const parser_tx_t &a, const parser_tx_t &b) {
+        EXPECT_EQ(a.version, b.version);
+        EXPECT_EQ(a.to.offset, b.to.offset);
+        EXPECT_EQ(a.to.len, b.to.len);
+        EXPECT_EQ(a.from.offset, b.from.offset);
+        EXPECT_EQ(a.from.len, b.from.len);
+        EXPECT_EQ(a.nonce, b.nonce);
+        EXPECT_EQ(a.value.offset, b.value.offset);
+        EXPECT_EQ(a.value.len, b.value.len);
+        EXPECT_EQ(a.gaslimit, b.gaslimit);
+        EXPECT_EQ(a.gaspremium.offset, b.gaspremium.offset);
+        EXPECT_EQ(a.gaspremium.len, b.gaspremium.len);
+        EXPECT_EQ(a.gasfeecap.offset, b.gasfeecap.offset);
+        EXPECT_EQ(a.gasfeecap.len, b.gasfeecap.len);
+        EXPECT_EQ(a.method, b.method);
+        EXPECT_EQ(a.numparams, b.numparams);
+        EXPECT_EQ(a.params.offset, b.params.offset);
+        EXPECT_EQ(a.params.len, b.params.len);
+        EXPECT_EQ(std::memcmp(a.paramsIndex, b.paramsIndex, sizeof(a.paramsIndex)), 0);
+    }
+
+    void expectSameAsGeneric(const std::vector<uint8_t> &blob) {
+        parser_tx_t txGeneric;
+        parser_context_t ctxGeneric;
+        const auto errGeneric = readGeneric(&ctxGeneric, blob, &txGeneric);
+
+        parser_context_t ctx;
+        parser_tx_t txSchema;
+        ctx.buffer = blob.data();
+        ctx.bufferLen = blob.size();
+        ctx.offset = 0;
+        if (!blob.empty() && _readSchema(&ctx, &txSchema)) {
+            EXPECT_EQ(errGeneric, parser_ok);
+            expectSameTx(txSchema, txGeneric);
+        }
+
+        parser_tx_t tx;
+        EXPECT_EQ(parser_parse_r(&ctx, blob.data(), blob.size(), &tx), errGeneric);
+        if (errGeneric == parser_ok) {
+            expectSameTx(tx, txGeneric);
+        }
+    }
+
+    TEST(ParserSchema, SameAsTinycbor) {
+        const auto blobs = loadBlobs();
+        ASSERT_GT(blobs.size(), 1000u);
+
+        size_t accepted = 0;
+        size_t decoded = 0;
+        for (const auto &blob : blobs) {
+            expectSameAsGeneric(blob);
+
+            parser_context_t ctx;
+            parser_tx_t tx;
+            accepted += readGeneric(&ctx, blob, &tx) == parser_ok;
+            decoded += !blob.empty() && _readSchema(&ctx, &tx);
+        }
+
+        // None of the accepted messages use indefinite lengths, so all of them take the fast path
+        EXPECT_GT(accepted, 0u);
+        EXPECT_EQ(decoded, accepted);
+    }
+
+    TEST(ParserSchema, NonMinimalHeaders) {
+        const std::string tx = TX_SECP256K1;
+        const std::string messages[] = {
+                // array length, nonce and value lengths with wider headers than needed
+                "980a" + tx.substr(2),
+                tx.substr(0, 92) + "1802" + tx.substr(94),
+                tx.substr(0, 94) + "580400" + tx.substr(96),
+                tx.substr(0, 92) + "1b0000000000000002" + tx.substr(94),
+                // gas limit -1, then -2^63 and -2^63 - 1
+                tx.substr(0, 104) + "20" + tx.substr(110),
+                tx.substr(0, 104) + "3b7fffffffffffffff" + tx.substr(110),
+                tx.substr(0, 104) + "3b8000000000000000" + tx.substr(110),
+                // nine items, trailing data, indefinite length value
+                "89" + tx.substr(2, tx.size() - 4),
+                tx + "00",
+                tx.substr(0, 94) + "5f44000186a0ff" + tx.substr(104),
+        };
+
+        for (const auto &hex : messages) {
+            std::vector<uint8_t> blob(hex.size() / 2);
+            blob.resize(parseHexString(blob.data(), blob.size(), hex.c_str()));
+            SCOPED_TRACE(hex);
+            expectSameAsGeneric(blob);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <hexutils.h>
+#include "parser.h"
+#include "parser_stream.h"
+#include "common.h"
+
+namespace {
+    struct expected_t {
+        parser_error_t err;
+        std::vector<std::string> ui;
+    };
+
+    expected_t parseAtOnce(const std::vector<uint8_t> &blob) {
+        parser_tx_t tx;
+        parser_context_t ctx;
+        expected_t answer{parser_parse_r(&ctx, blob.data(), blob.size(), &tx), {}};
+        if (answer.err == parser_ok && parser_validate_r(&ctx) == parser_ok) {
+            answer.ui = dumpUI(&ctx, 40, 37);
+        }
+        return answer;
+    }
+
+    void checkFinish(parser_stream_t *stream, const std::vector<uint8_t> &blob, const expected_t &expected) {
+        // the buffer may have moved since the last update
+        const std::vector<uint8_t> received(blob);
+
+        parser_context_t ctx;
+        ASSERT_EQ(parser_stream_finish(stream, &ctx, received.data(), received.size()), expected.err);
+        if (expected.err == parser_ok) {
+            ASSERT_EQ(parser_validate_r(&ctx), parser_ok);
+            EXPECT_EQ(dumpUI(&ctx, 40, 37), expected.ui);
+        }
+    }
+
+    TEST(ParserStream, EverySplitPoint) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        const auto blobs = loadTestVectorBlobs();
+        ASSERT_FALSE(blobs.empty());
+
+        for (size_t b = 0; b < blobs.size(); b++) {
+            const auto &blob = blobs[b];
+            const auto expected = parseAtOnce(blob);
+
+            for (size_t split = 0; split <= blob.size(); split++) {
+                SCOPED_TRACE(testing::Message() << "vector " << b << " split " << split);
+                const std::vector<uint8_t> firstChunk(blob.begin(), blob.begin() + split);
+
+                parser_tx_t tx;
+                parser_stream_t stream;
+                parser_stream_init(&stream, &tx);
+
+                // An early error must be the one the full message would report
+                const auto err = parser_stream_update(&stream, firstChunk.data(), firstChunk.size());
+                if (err != parser_ok) {
+                    EXPECT_EQ(err, expected.err);
+                }
+
+                checkFinish(&stream, blob, expected);
+            }
+        }
+    }
+
+    TEST(ParserStream, ByteByByte) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        for (const auto &blob : loadTestVectorBlobs()) {
+            const auto expected = parseAtOnce(blob);
+
+            parser_tx_t tx;
+            parser_stream_t stream;
+            parser_stream_init(&stream, &tx);
+
+            for (size_t received = 1; received <= blob.size(); received++) {
+                const std::vector<uint8_t> chunk(blob.begin(), blob.begin() + received);
+                const auto err = parser_stream_update(&stream, chunk.data(), chunk.size());
+                if (err != parser_ok) {
+                    EXPECT_EQ(err, expected.err);
+                    break;
+                }
+            }
+
+            checkFinish(&stream, blob, expected);
+        }
+    }
+
+    TEST(ParserStream, RejectsBeforeMessageEnds) {
+        // "to" is an empty address: the error is known long before the last byte
+        uint8_t buffer[100];
+        const auto bufferLen = parseHexString(buffer, sizeof(buffer), "8a00404000420000004200004200000040");
+
+        parser_tx_t tx;
+        parser_stream_t stream;
+        parser_stream_init(&stream, &tx);
+        EXPECT_EQ(parser_stream_update(&stream, buffer, 4), parser_invalid_address);
+        EXPECT_LT(4, bufferLen);
+
+        parser_context_t ctx;
+        EXPECT_EQ(parser_stream_finish(&stream, &ctx, buffer, bufferLen), parser_invalid_address);
+    }
+}
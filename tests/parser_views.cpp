@@ -0,0 +1,259 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <cstring>
+#include <fmt/core.h>
+#include <hexutils.h>
+#include "parser.h"
+#include "parser_stream.h"
+#include "common.h"
+
+namespace {
+    const char *TX_SECP256K1 = "8a005501fd1d0f4dfcd7e99afcb99a8326b7dc459d32c6285501b882619d46558f3d9e316d11b48dcf211327025a0144000186a01961a8420000430009c40040";
+
+    parser_error_t parseHex(const std::string &hex, uint8_t *buffer, size_t bufferSize, parser_tx_t *tx, parser_context_t *ctx) {
+        auto bufferLen = parseHexString(buffer, bufferSize, hex.c_str());
+        auto err = parser_parse_r(ctx, buffer, bufferLen, tx);
+        if (err != parser_ok) {
+            return err;
+        }
+        return parser_validate_r(ctx);
+    }
+
+    // CBOR header of the given major type and length, as hex
+    std::string cborHeader(uint8_t majorType, size_t len) {
+        if (len < 24) {
+            return fmt::format("{:02x}", (majorType << 5) | len);
+        }
+        if (len <= 0xFF) {
+            return fmt::format("{:02x}{:02x}", (majorType << 5) | 24, len);
+        }
+        if (len <= 0xFFFF) {
+            return fmt::format("{:02x}{:04x}", (majorType << 5) | 25, len);
+        }
+        return fmt::format("{:02x}{:08x}", (majorType << 5) | 26, len);
+    }
+
+    // TX_SECP256K1 calling method 2 with the given CBOR encoded params
+    std::string withParams(const std::string &params) {
+        const std::string tx = TX_SECP256K1;
+        return tx.substr(0, tx.size() - 4) + "02" + cborHeader(2, params.size() / 2) + params;
+    }
+
+    // All the pages of a display item, joined
+    std::string renderItem(const parser_context_t *ctx, uint8_t displayIdx, uint16_t outValLen) {
+        std::string answer;
+        uint8_t pageCount = 1;
+        for (uint8_t page = 0; page < pageCount; page++) {
+            char key[40];
+            std::vector<char> val(outValLen);
+            EXPECT_EQ(parser_getItem_r(ctx, displayIdx, key, sizeof(key), val.data(), outValLen, page, &pageCount), parser_ok);
+            answer += val.data();
+        }
+        return answer;
+    }
+
+    TEST(ParserViews, FieldsReferenceInput) {
+        uint8_t buffer[200];
+        parser_tx_t tx;
+        parser_context_t ctx;
+        ASSERT_EQ(parseHex(TX_SECP256K1, buffer, sizeof(buffer), &tx, &ctx), parser_ok);
+
+        const uint8_t to[] = {0x01, 0xfd, 0x1d, 0x0f, 0x4d};
+        EXPECT_EQ(tx.to.len, 21);
+        EXPECT_EQ(std::memcmp(buffer + tx.to.offset, to, sizeof(to)), 0);
+
+        const uint8_t value[] = {0x00, 0x01, 0x86, 0xa0};
+        EXPECT_EQ(tx.value.len, sizeof(value));
+        EXPECT_EQ(std::memcmp(buffer + tx.value.offset, value, sizeof(value)), 0);
+
+        EXPECT_EQ(tx.params.len, 0);
+        // Nothing is copied, the tx only holds integers, views and the params index
+        EXPECT_LE(sizeof(parser_tx_t), 6 * sizeof(uint64_t) + 6 * sizeof(buffer_view_t) + sizeof(tx.paramsIndex));
+    }
+
+    TEST(ParserViews, TruncatedParamsRejected) {
+        uint8_t buffer[200];
+        parser_tx_t tx;
+        parser_context_t ctx;
+
+        // method 2, params announce [1, 2, 3] but only carry two items
+        std::string hex = TX_SECP256K1;
+        hex = hex.substr(0, hex.size() - 4) + "0243830102";
+        EXPECT_EQ(parseHex(hex, buffer, sizeof(buffer), &tx, &ctx), parser_cbor_unexpected_EOF);
+
+        hex = hex.substr(0, hex.size() - 10) + "024483010203";
+        EXPECT_EQ(parseHex(hex, buffer, sizeof(buffer), &tx, &ctx), parser_ok);
+    }
+
+    TEST(ParserViews, ChunkedStrings) {
+        uint8_t buffer[200];
+        parser_tx_t tx;
+        parser_context_t ctx;
+        const std::string tail = std::string(TX_SECP256K1).substr(48);
+
+        // "to" sent as a single chunk can still be referenced in place
+        EXPECT_EQ(parseHex("8a005f5501fd1d0f4dfcd7e99afcb99a8326b7dc459d32c628ff" + tail,
+                           buffer, sizeof(buffer), &tx, &ctx), parser_ok);
+        EXPECT_EQ(buffer[tx.to.offset], 0x01);
+
+        // protocol and payload in separate chunks are not contiguous
+        EXPECT_EQ(parseHex("8a005f410154fd1d0f4dfcd7e99afcb99a8326b7dc459d32c628ff" + tail,
+                           buffer, sizeof(buffer), &tx, &ctx), parser_cbor_unexpected);
+    }
+
+    TEST(ParserViews, IndexedParams) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        uint8_t buffer[300];
+        parser_tx_t tx;
+        parser_context_t ctx;
+
+        // More params than index entries, so some of them are reached by skipping
+        for (uint8_t numParams : {3, MAX_PARAMS_INDEX, MAX_PARAMS_INDEX + 1, 150}) {
+            std::string params = numParams < 24 ? fmt::format("{:02x}", 0x80 + numParams) : fmt::format("98{:02x}", numParams);
+            for (uint8_t i = 0; i < numParams; i++) {
+                params += fmt::format("{:02x}", i % 24);
+            }
+            std::string hex = TX_SECP256K1;
+            hex = hex.substr(0, hex.size() - 4) + fmt::format("0258{:02x}", params.size() / 2) + params;
+            ASSERT_EQ(parseHex(hex, buffer, sizeof(buffer), &tx, &ctx), parser_ok) << (int) numParams;
+
+            uint8_t numItems = 0;
+            ASSERT_EQ(parser_getNumItems_r(&ctx, &numItems), parser_ok);
+            ASSERT_EQ(numItems, 8 + numParams);
+
+            for (uint8_t i = numParams; i > 0; i--) {
+                char key[40];
+                char val[40];
+                uint8_t pageCount = 0;
+                ASSERT_EQ(parser_getItem_r(&ctx, 8 + i - 1, key, sizeof(key), val, sizeof(val), 0, &pageCount), parser_ok);
+                EXPECT_EQ(std::string(val), std::to_string((i - 1) % 24)) << "param " << (int) i;
+            }
+        }
+    }
+
+    TEST(ParserViews, LargeParams) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        std::string bytesHex;
+        for (size_t i = 0; i < 1500; i++) {
+            bytesHex += fmt::format("{:02x}", i % 251);
+        }
+        const std::string text(700, 'x');
+        std::string textHex;
+        for (char ch : text) {
+            textHex += fmt::format("{:02x}", ch);
+        }
+
+        // [h'...' (1500 bytes), "xx..." (700 chars), (_ h'0102', h'', h'03')], rendered in place page by page
+        const std::string params = cborHeader(4, 3) +
+                                   cborHeader(2, bytesHex.size() / 2) + bytesHex +
+                                   cborHeader(3, text.size()) + textHex +
+                                   "5f420102404103ff";
+        const std::string hex = withParams(params);
+
+        std::vector<uint8_t> buffer(hex.size() / 2);
+        parser_tx_t tx;
+        parser_context_t ctx;
+        ASSERT_EQ(parseHex(hex, buffer.data(), buffer.size(), &tx, &ctx), parser_ok);
+        ASSERT_EQ(parser_validate_structural(&ctx), parser_ok);
+        ASSERT_EQ(tx.numparams, 3);
+
+        for (uint16_t outValLen : {40, 35, 17}) {
+            EXPECT_EQ(renderItem(&ctx, 8, outValLen), bytesHex) << outValLen;
+            EXPECT_EQ(renderItem(&ctx, 9, outValLen), text) << outValLen;
+        }
+        EXPECT_EQ(renderItem(&ctx, 10, 40), "010203");
+    }
+
+    TEST(ParserViews, LargeParamsLimits) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        std::vector<uint8_t> buffer(20000);
+        parser_tx_t tx;
+        parser_context_t ctx;
+
+        // Byte strings are shown in hex, two characters per byte
+        for (size_t len : {MAX_PARAM_RENDERED_LEN / 2, MAX_PARAM_RENDERED_LEN / 2 + 1}) {
+            const std::string hex = withParams(cborHeader(4, 1) + cborHeader(2, len) + std::string(2 * len, 'a'));
+            const auto expected = len * 2 <= MAX_PARAM_RENDERED_LEN ? parser_ok : parser_value_out_of_range;
+            EXPECT_EQ(parseHex(hex, buffer.data(), buffer.size(), &tx, &ctx), expected) << len;
+            EXPECT_EQ(parser_validate_structural(&ctx), expected) << len;
+        }
+
+        // Display indexes must fit in uint8_t
+        for (size_t numParams : {MAX_PARAMS_COUNT, MAX_PARAMS_COUNT + 1}) {
+            std::string params = cborHeader(4, numParams);
+            for (size_t i = 0; i < numParams; i++) {
+                params += "01";
+            }
+            const auto expected = numParams <= MAX_PARAMS_COUNT ? parser_ok : parser_value_out_of_range;
+            EXPECT_EQ(parseHex(withParams(params), buffer.data(), buffer.size(), &tx, &ctx), expected) << numParams;
+        }
+
+        uint8_t numItems = 0;
+        ASSERT_EQ(parseHex(withParams(cborHeader(4, MAX_PARAMS_COUNT) + std::string(2 * MAX_PARAMS_COUNT, '1')),
+                           buffer.data(), buffer.size(), &tx, &ctx), parser_ok);
+        ASSERT_EQ(parser_getNumItems_r(&ctx, &numItems), parser_ok);
+        EXPECT_EQ(numItems, UINT8_MAX);
+    }
+
+    TEST(ParserViews, LargerThan64KiB) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        // 20 params of 4000 bytes each, the last ones start past 64KiB
+        const size_t numParams = 20;
+        const size_t paramLen = 4000;
+        std::string params = cborHeader(4, numParams);
+        for (size_t i = 0; i < numParams; i++) {
+            params += cborHeader(2, paramLen) + std::string(2 * paramLen, "0123456789abcdef"[i % 16]);
+        }
+        const std::string hex = withParams(params);
+        ASSERT_GT(hex.size() / 2, 0x10000u);
+
+        // parseHexString is limited to 64KiB too
+        std::vector<uint8_t> buffer(hex.size() / 2);
+        for (size_t i = 0; i < buffer.size(); i++) {
+            buffer[i] = (uint8_t) std::stoul(hex.substr(2 * i, 2), nullptr, 16);
+        }
+
+        parser_tx_t tx;
+        parser_context_t ctx;
+        ASSERT_EQ(parser_parse_r(&ctx, buffer.data(), buffer.size(), &tx), parser_ok);
+        ASSERT_EQ(parser_validate_r(&ctx), parser_ok);
+        EXPECT_EQ(ctx.bufferLen, buffer.size());
+        EXPECT_EQ(tx.params.len, params.size() / 2);
+        EXPECT_EQ(parser_validate_structural(&ctx), parser_ok);
+
+        EXPECT_EQ(renderItem(&ctx, 8 + numParams - 1, 40), std::string(2 * paramLen, '3'));
+
+        // The incremental reader takes the same sizes
+        parser_stream_t stream;
+        parser_tx_t streamTx;
+        parser_context_t streamCtx;
+        parser_stream_init(&stream, &streamTx);
+        EXPECT_EQ(parser_stream_update(&stream, buffer.data(), buffer.size() / 2), parser_ok);
+        EXPECT_EQ(parser_stream_finish(&stream, &streamCtx, buffer.data(), buffer.size()), parser_ok);
+        EXPECT_EQ(streamTx.params.offset, tx.params.offset);
+    }
+}
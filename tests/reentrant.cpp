@@ -0,0 +1,112 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <thread>
+#include <hexutils.h>
+#include "parser.h"
+#include "common.h"
+
+namespace {
+    // Protocol 1 addresses
+    const char *TX_SECP256K1 = "8a005501fd1d0f4dfcd7e99afcb99a8326b7dc459d32c6285501b882619d46558f3d9e316d11b48dcf211327025a0144000186a01961a8420000430009c40040";
+    // Protocol 3 addresses
+    const char *TX_BLS = "8a00583103ad58df696e2d4e91ea86c881e938ba4ea81b395e12797b84b9cf314b9546705e839c7a99d606b247ddb4f9ac7a3414dd583103b3294f0a2e29e0c66ebc235d2fedca5697bf784af605c75af608e6a63d5cd38ea85ca8989e0efde9188b382f9372460d0144000186a01961a8420000430009c40040";
+
+    std::vector<std::string> expectedUI(const uint8_t *buffer, size_t bufferLen) {
+        parser_context_t ctx;
+        EXPECT_EQ(parser_parse(&ctx, buffer, bufferLen), parser_ok);
+        EXPECT_EQ(parser_validate(&ctx), parser_ok);
+        return dumpUI(&ctx, 40, 37);
+    }
+
+    TEST(ReentrantParser, InterleavedContexts) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        uint8_t bufferA[200];
+        uint8_t bufferB[200];
+        auto bufferALen = parseHexString(bufferA, sizeof(bufferA), TX_SECP256K1);
+        auto bufferBLen = parseHexString(bufferB, sizeof(bufferB), TX_BLS);
+
+        const auto expectedA = expectedUI(bufferA, bufferALen);
+        const auto expectedB = expectedUI(bufferB, bufferBLen);
+        ASSERT_NE(expectedA, expectedB);
+
+        parser_tx_t txA;
+        parser_tx_t txB;
+        parser_context_t ctxA;
+        parser_context_t ctxB;
+
+        ASSERT_EQ(parser_parse_r(&ctxA, bufferA, bufferALen, &txA), parser_ok);
+        ASSERT_EQ(parser_parse_r(&ctxB, bufferB, bufferBLen, &txB), parser_ok);
+        ASSERT_EQ(parser_validate_r(&ctxA), parser_ok);
+        ASSERT_EQ(parser_validate_r(&ctxB), parser_ok);
+
+        // Parsing B must not have overwritten A
+        EXPECT_EQ(dumpUI(&ctxA, 40, 37), expectedA);
+        EXPECT_EQ(dumpUI(&ctxB, 40, 37), expectedB);
+    }
+
+    TEST(ReentrantParser, MissingTxObject) {
+        uint8_t buffer[200];
+        auto bufferLen = parseHexString(buffer, sizeof(buffer), TX_SECP256K1);
+
+        parser_context_t ctx;
+        EXPECT_EQ(parser_parse_r(&ctx, buffer, bufferLen, nullptr), parser_init_context_empty);
+    }
+
+    TEST(ReentrantParser, ConcurrentThreads) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        uint8_t bufferA[200];
+        uint8_t bufferB[200];
+        auto bufferALen = parseHexString(bufferA, sizeof(bufferA), TX_SECP256K1);
+        auto bufferBLen = parseHexString(bufferB, sizeof(bufferB), TX_BLS);
+
+        const auto expectedA = expectedUI(bufferA, bufferALen);
+        const auto expectedB = expectedUI(bufferB, bufferBLen);
+
+        const size_t numThreads = 8;
+        std::vector<int> results(numThreads, 0);
+        std::vector<std::thread> threads;
+
+        for (size_t t = 0; t < numThreads; t++) {
+            threads.emplace_back([&, t]() {
+                const bool useA = (t % 2) == 0;
+                bool ok = true;
+                for (int i = 0; i < 100 && ok; i++) {
+                    parser_tx_t tx;
+                    parser_context_t ctx;
+                    ok = parser_parse_r(&ctx, useA ? bufferA : bufferB, useA ? bufferALen : bufferBLen, &tx) == parser_ok;
+                    ok = ok && parser_validate_r(&ctx) == parser_ok;
+                    ok = ok && dumpUI(&ctx, 40, 37) == (useA ? expectedA : expectedB);
+                }
+                results[t] = ok;
+            });
+        }
+
+        for (auto &th : threads) {
+            th.join();
+        }
+
+        for (size_t t = 0; t < numThreads; t++) {
+            EXPECT_TRUE(results[t]) << "thread " << t;
+        }
+    }
+}
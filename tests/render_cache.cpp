@@ -0,0 +1,170 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <hexutils.h>
+#include "parser.h"
+#include "parser_cache.h"
+#include "crypto.h"
+#include "common.h"
+
+namespace {
+    // method 2 with params [h'aa..aa' (60 bytes), "abc", 5, [1, 2]]
+    const char *TX_PARAMS = "8a005501fd1d0f4dfcd7e99afcb99a8326b7dc459d32c6285501b882619d46558f3d9e316d11b48dcf211327025a0144000186a01961a8420000430009c402584784583caaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa6361626305820102";
+
+    std::vector<std::vector<uint8_t>> loadBlobs() {
+        auto answer = loadTestVectorBlobs();
+
+        std::vector<uint8_t> blob(strlen(TX_PARAMS) / 2);
+        blob.resize(parseHexString(blob.data(), blob.size(), TX_PARAMS));
+        answer.push_back(blob);
+        return answer;
+    }
+
+    TEST(RenderCache, SameOutputAsLiveRendering) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        const auto blobs = loadBlobs();
+        ASSERT_FALSE(blobs.empty());
+
+        size_t validBlobs = 0;
+        for (const auto &blob : blobs) {
+            parser_tx_t txLive;
+            parser_context_t ctxLive;
+            if (parser_parse_r(&ctxLive, blob.data(), blob.size(), &txLive) != parser_ok ||
+                parser_validate_r(&ctxLive) != parser_ok) {
+                continue;
+            }
+            validBlobs++;
+
+            // large enough for everything, only some items, nothing at all
+            for (uint16_t arenaSize : {4096, 100, 0}) {
+                std::vector<uint8_t> arena(arenaSize + 1);
+                parser_render_cache_t cache;
+                parser_tx_t tx;
+                parser_context_t ctx;
+                ASSERT_EQ(parser_parse_r(&ctx, blob.data(), blob.size(), &tx), parser_ok);
+                ASSERT_EQ(parser_cacheAttach(&ctx, &cache, arena.data(), arenaSize), parser_ok);
+                ASSERT_EQ(parser_validate_r(&ctx), parser_ok);
+                EXPECT_LE(cache.arenaUsed, arenaSize);
+
+                if (arenaSize == 4096) {
+                    // addresses and amounts are always kept
+                    for (uint8_t idx : {0, 1, 3, 5, 6}) {
+                        EXPECT_NE(cache.entries[idx], PARSER_CACHE_NO_ENTRY) << (int) idx;
+                    }
+                }
+
+                for (uint16_t keyLen : {40, 8}) {
+                    for (uint16_t valLen : {37, 20, 9, 2}) {
+                        EXPECT_EQ(dumpUI(&ctx, keyLen, valLen), dumpUI(&ctxLive, keyLen, valLen))
+                                            << "arena " << arenaSize << " key " << keyLen << " value " << valLen;
+                    }
+                }
+            }
+        }
+
+        EXPECT_GT(validBlobs, 1);
+    }
+
+    TEST(RenderCache, ResetByParsing) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        const auto blobs = loadBlobs();
+        uint8_t arena[1024];
+        parser_render_cache_t cache;
+        parser_tx_t tx;
+        parser_context_t ctx;
+
+        ASSERT_EQ(parser_parse_r(&ctx, blobs.back().data(), blobs.back().size(), &tx), parser_ok);
+        ASSERT_EQ(parser_cacheAttach(&ctx, &cache, arena, sizeof(arena)), parser_ok);
+        ASSERT_EQ(parser_validate_r(&ctx), parser_ok);
+
+        // A new parse must not be served from the cache filled for the previous one
+        ASSERT_EQ(parser_parse_r(&ctx, blobs.back().data(), blobs.back().size(), &tx), parser_ok);
+        EXPECT_EQ(ctx.cache, nullptr);
+    }
+
+    TEST(AddressMemo, SameOutputAndOneChecksumPerAddress) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        const auto blobs = loadBlobs();
+        parser_address_memo_entry_t entries[2];
+        parser_address_memo_t memo;
+        ASSERT_EQ(parser_addressMemoInit(&memo, entries, 2), parser_ok);
+
+        for (const auto &blob : blobs) {
+            parser_tx_t txLive;
+            parser_context_t ctxLive;
+            if (parser_parse_r(&ctxLive, blob.data(), blob.size(), &txLive) != parser_ok ||
+                parser_validate_r(&ctxLive) != parser_ok) {
+                continue;
+            }
+
+            parser_tx_t tx;
+            parser_context_t ctx;
+            ASSERT_EQ(parser_parse_r(&ctx, blob.data(), blob.size(), &tx), parser_ok);
+            ASSERT_EQ(parser_addressMemoAttach(&ctx, &memo), parser_ok);
+            ASSERT_EQ(parser_validate_r(&ctx), parser_ok);
+
+            // every page of both addresses, at most one checksum for each of them
+            const uint32_t missesBefore = memo.misses;
+            for (uint16_t valLen : {37, 9}) {
+                EXPECT_EQ(dumpUI(&ctx, 40, valLen), dumpUI(&ctxLive, 40, valLen));
+            }
+            EXPECT_EQ(memo.misses, missesBefore);
+        }
+        EXPECT_GT(memo.misses, 0u);
+    }
+
+    TEST(AddressMemo, LeastRecentlyUsedIsEvicted) {
+        parser_address_memo_entry_t entries[2];
+        parser_address_memo_t memo;
+        ASSERT_EQ(parser_addressMemoInit(&memo, entries, 2), parser_ok);
+
+        const auto blobs = loadBlobs();
+        parser_tx_t tx;
+        parser_context_t ctx;
+        ASSERT_EQ(parser_parse_r(&ctx, blobs.back().data(), blobs.back().size(), &tx), parser_ok);
+        uint8_t checksum[PARSER_ADDRESS_CHECKSUM_LEN];
+        EXPECT_EQ(parser_addressChecksum(&ctx, entries[0].address, 21, checksum), nullptr);
+        ASSERT_EQ(parser_addressMemoAttach(&ctx, &memo), parser_ok);
+
+        uint8_t a[21] = {1, 0xaa};
+        uint8_t b[21] = {1, 0xbb};
+        uint8_t c[21] = {1, 0xcc};
+        uint8_t expected[CHECKSUM_LENGTH];
+        addressChecksum(a, sizeof(a), expected);
+
+        ASSERT_NE(parser_addressChecksum(&ctx, a, sizeof(a), checksum), nullptr);
+        EXPECT_EQ(memcmp(checksum, expected, sizeof(expected)), 0);
+        parser_addressChecksum(&ctx, b, sizeof(b), checksum);
+        parser_addressChecksum(&ctx, a, sizeof(a), checksum);
+        EXPECT_EQ(memo.misses, 2u);
+
+        // b is the least recently used one
+        parser_addressChecksum(&ctx, c, sizeof(c), checksum);
+        parser_addressChecksum(&ctx, a, sizeof(a), checksum);
+        EXPECT_EQ(memo.misses, 3u);
+        EXPECT_EQ(memcmp(checksum, expected, sizeof(expected)), 0);
+        parser_addressChecksum(&ctx, b, sizeof(b), checksum);
+        EXPECT_EQ(memo.misses, 4u);
+    }
+}
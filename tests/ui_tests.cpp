@@ -22,6 +22,7 @@
 #include <hexutils.h>
 #include <app_mode.h>
 #include "parser.h"
+#include "hex_codec.h"
 #include "common.h"
 #include <memory>
 #include "testcases.h"
@@ -100,7 +101,7 @@ void check_testcase(const testcase_t &tc, bool) {
     parser_error_t err;
 
     uint8_t buffer[10000];
-    uint16_t bufferLen = parseHexString(buffer, sizeof(buffer), tc.blob.c_str());
+    uint16_t bufferLen = hex_decode(buffer, sizeof(buffer), tc.blob.c_str());
 
     hdPath[0] = HDPATH_0_DEFAULT;
     hdPath[1] = HDPATH_1_DEFAULT;
@@ -0,0 +1,106 @@
+/*******************************************************************************
+*   (c) 2021 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <hexutils.h>
+#include "parser.h"
+#include "common.h"
+
+namespace {
+    const char *TX_SECP256K1 = "8a005501fd1d0f4dfcd7e99afcb99a8326b7dc459d32c6285501b882619d46558f3d9e316d11b48dcf211327025a0144000186a01961a8420000430009c40040";
+
+    // TX_SECP256K1 calling method 2 with the given params byte string
+    std::string withParams(const std::string &params) {
+        const std::string tx = TX_SECP256K1;
+        return tx.substr(0, tx.size() - 4) + "02" + params;
+    }
+
+    // Messages that parse but are rejected once their items are rendered
+    const struct {
+        std::string description;
+        std::string hex;
+        parser_error_t expected;
+    } RENDER_FAILURES[] = {
+            {"ID address with unterminated LEB128",
+             std::string("8a0043008080") + std::string(TX_SECP256K1).substr(48),
+             parser_invalid_address},
+            {"value with more than 64 bytes",
+             std::string(TX_SECP256K1).substr(0, 94) + "584100" + std::string(128, 'f') + std::string(TX_SECP256K1).substr(104),
+             parser_value_out_of_range},
+            {"param above INT64_MAX",
+             withParams("4a811bffffffffffffffff"),
+             parser_cbor_unexpected},
+            {"param below INT64_MIN",
+             withParams("4a813bffffffffffffffff"),
+             parser_cbor_unexpected},
+            {"map key above INT64_MAX",
+             withParams("4ba11bffffffffffffffff01"),
+             parser_cbor_unexpected},
+    };
+
+    std::vector<std::vector<uint8_t>> loadBlobs() {
+        auto answer = loadTestVectorBlobs();
+
+        for (const auto &failure : RENDER_FAILURES) {
+            std::vector<uint8_t> blob(failure.hex.size() / 2);
+            blob.resize(parseHexString(blob.data(), blob.size(), failure.hex.c_str()));
+            answer.push_back(blob);
+        }
+        return answer;
+    }
+
+    TEST(ValidateStructural, SameResultAsValidate) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        const auto blobs = loadBlobs();
+        ASSERT_FALSE(blobs.empty());
+
+        size_t checked = 0;
+        for (const auto &blob : blobs) {
+            parser_tx_t tx;
+            parser_context_t ctx;
+            if (parser_parse_r(&ctx, blob.data(), blob.size(), &tx) != parser_ok) {
+                continue;
+            }
+            checked++;
+            EXPECT_EQ(parser_validate_structural(&ctx), parser_validate_r(&ctx)) << checked;
+        }
+        EXPECT_GT(checked, sizeof(RENDER_FAILURES) / sizeof(RENDER_FAILURES[0]));
+    }
+
+    TEST(ValidateStructural, RenderFailures) {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+
+        for (const auto &failure : RENDER_FAILURES) {
+            uint8_t buffer[300];
+            parser_tx_t tx;
+            parser_context_t ctx;
+            const auto bufferLen = parseHexString(buffer, sizeof(buffer), failure.hex.c_str());
+            ASSERT_EQ(parser_parse_r(&ctx, buffer, bufferLen, &tx), parser_ok) << failure.description;
+            EXPECT_EQ(parser_validate_structural(&ctx), failure.expected) << failure.description;
+            EXPECT_EQ(parser_validate_r(&ctx), failure.expected) << failure.description;
+        }
+    }
+
+    TEST(ValidateStructural, EmptyContext) {
+        parser_context_t ctx;
+        ctx.tx_obj = nullptr;
+        EXPECT_EQ(parser_validate_structural(&ctx), parser_init_context_empty);
+    }
+}